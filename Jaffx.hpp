@@ -1,15 +1,49 @@
+#ifdef JAFFX_HOST
+#include "include/Host.hpp" // host stand-ins for libDaisy, see host/
+#else
 #include "libDaisy/src/daisy_seed.h"
-#include "include/SDRAM.hpp"
 #include "arm_math.h"
+#endif
+#include "include/SDRAM.hpp"
+#include "include/Arena.hpp"
+#include "include/Memory.hpp"
+#include "include/Pool.hpp"
+#include "include/Profiler.hpp"
+#include "include/Telemetry.hpp"
+#include "include/Scheduler.hpp"
 using namespace daisy;
 
 namespace giml {
 
 	// Overwrite stdlib memory syscalls in giml space
-	void* malloc(size_t size) { return Jaffx::mSDRAM.malloc(size); }
-	void* calloc(size_t nelemb, size_t size) { return Jaffx::mSDRAM.calloc(nelemb, size); }
-	void* realloc(void* ptr, size_t size) { return Jaffx::mSDRAM.realloc(ptr, size); }
-	void free(void* ptr) { Jaffx::mSDRAM.free(ptr); }
+	// Small (hot) allocations go to the fast heap, see `Jaffx::Memory`.
+	// The rest is routed to `Jaffx::mArena` while it is open, SDRAM otherwise
+	void* malloc(size_t size) {
+		if (Jaffx::mMemory.resolve(size) == Jaffx::Placement::Fast) {
+			if (void* ptr = Jaffx::mMemory.allocateFast(size)) { return ptr; }
+		}
+		if (Jaffx::mArena.isOpen()) {
+			void* ptr = Jaffx::mArena.allocate(size);
+			if (ptr) { Jaffx::mMemory.record(Jaffx::Memory::Region::External, size); }
+			return ptr;
+		}
+		return Jaffx::mMemory.allocateExternal(size);
+	}
+	void* calloc(size_t nelemb, size_t size) {
+		if (size && nelemb > size_t(-1) / size) { return nullptr; } // overflow
+		void* ptr = giml::malloc(nelemb * size);
+		if (ptr) { ::memset(ptr, 0, nelemb * size); }
+		return ptr;
+	}
+	void* realloc(void* ptr, size_t size) {
+		if (Jaffx::mArena.owns(ptr)) { return Jaffx::mArena.reallocate(ptr, size); }
+		if (!ptr) { return giml::malloc(size); }
+		return Jaffx::mMemory.reallocate(ptr, size);
+	}
+	void free(void* ptr) {
+		if (Jaffx::mArena.owns(ptr)) { return; } // reclaimed by `Arena::rollback()`
+		Jaffx::mMemory.free(ptr);
+	}
 
 	// Overwrite trig calls with optimized ARM versions
 	inline float sin(float x) { 
@@ -38,6 +72,25 @@ public:
 	CpuLoadMeter loadMeter;
 	bool debug = false;
 
+	// telemetry from the audio callback, printed to serial by `debugLoop()`
+	Telemetry telemetry;
+	size_t telemetryBatch = 8; // records printed per `debugLoop()`
+
+	// periodic and posted work for the main loop, sleeps between them
+	Scheduler<> scheduler;
+
+protected:
+	uint32_t lastLoadReport = 0; // ms
+
+	// printf-style line printer over the serial connection
+	struct SerialPrinter {
+		template <typename... Args>
+		void operator()(const char* format, Args... args) const { hardware.PrintLine(format, args...); }
+	};
+
+	// callback handed to the audio driver, swapped by variants like `StereoFirmware`
+	AudioHandle::AudioCallback audioCallback = AudioCallback;
+
 public:
 	// overridable init function
 	inline virtual void init() {}
@@ -48,11 +101,22 @@ public:
 			hardware.StartLog();
 			loadMeter.Init(hardware.AudioSampleRate(), hardware.AudioBlockSize());
 		}
+#ifdef JAFFX_PROFILE
+		Profiler::enableCounter();
+#endif
 	}
 
 	// overridable per-sample operation
 	inline virtual float processAudio(float in) { return in; }
 
+	// overridable per-block operation, calls `processAudio()` per sample by default.
+	// Override this instead to process whole blocks (one virtual call per callback)
+	inline virtual void processBlock(const float* in, float* out, size_t size) {
+		for (size_t i = 0; i < size; i++) {
+			out[i] = this->processAudio(in[i]);
+		}
+	}
+
 	// overridable audio block start/end operation
 	inline virtual void blockStart() {}
 	inline virtual void blockEnd() {}
@@ -60,31 +124,54 @@ public:
 	// overridable loop operation
 	inline virtual void loop() {}
 
-	// debug loop
+	// debug loop, never blocks
 	inline void debugLoop() {
-		if (debug) {
-			// as seen in https://electro-smith.github.io/libDaisy/md_doc_2md_2__a3___getting-_started-_audio.html
-			const float avgLoad = loadMeter.GetAvgCpuLoad();
-			const float maxLoad = loadMeter.GetMaxCpuLoad();
-			const float minLoad = loadMeter.GetMinCpuLoad();
-			// print it to the serial connection (as percentages)
-			hardware.PrintLine("Processing Load:");
-			hardware.PrintLine("Max: " FLT_FMT3 "%%", FLT_VAR3(maxLoad * 100.0f));
-			hardware.PrintLine("Avg: " FLT_FMT3 "%%", FLT_VAR3(avgLoad * 100.0f));
-			hardware.PrintLine("Min: " FLT_FMT3 "%%", FLT_VAR3(minLoad * 100.0f));
-			System::Delay(1000); // Don't spam the serial!
+		this->drainTelemetry(telemetryBatch);
+		if (debug && System::GetNow() - lastLoadReport >= 1000) { // Don't spam the serial!
+			lastLoadReport = System::GetNow();
+			this->printLoad();
 		}
 	}
 
+	// print up to `maxRecords` queued telemetry records to serial
+	inline void drainTelemetry(size_t maxRecords) {
+		telemetry.drain([](const TelemetryRecord& record) { printRecord(SerialPrinter(), record); }, maxRecords);
+	}
+
+	// print the load meter (and profiling) report to serial
+	inline void printLoad() {
+		// as seen in https://electro-smith.github.io/libDaisy/md_doc_2md_2__a3___getting-_started-_audio.html
+		const float avgLoad = loadMeter.GetAvgCpuLoad();
+		const float maxLoad = loadMeter.GetMaxCpuLoad();
+		const float minLoad = loadMeter.GetMinCpuLoad();
+		// print it to the serial connection (as percentages)
+		hardware.PrintLine("Processing Load:");
+		hardware.PrintLine("Max: " FLT_FMT3 "%%", FLT_VAR3(maxLoad * 100.0f));
+		hardware.PrintLine("Avg: " FLT_FMT3 "%%", FLT_VAR3(avgLoad * 100.0f));
+		hardware.PrintLine("Min: " FLT_FMT3 "%%", FLT_VAR3(minLoad * 100.0f));
+		const uint32_t dropped = telemetry.takeDropped();
+		if (dropped) { hardware.PrintLine("Telemetry dropped: %lu", (unsigned long)dropped); }
+		if (scheduler.size()) { scheduler.report(SerialPrinter()); }
+		const uint32_t droppedTasks = scheduler.takeDropped();
+		if (droppedTasks) { hardware.PrintLine("Posted tasks dropped: %lu", (unsigned long)droppedTasks); }
+#ifdef JAFFX_PROFILE
+		// per-stage breakdown of `Jaffx::EffectsLine` chains
+		Profiler::report(SerialPrinter(), buffersize, samplerate);
+#endif
+	}
+
 	// basic mono->dual-mono callback
 	static void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size) {
 		if (instance->debug) { instance->loadMeter.OnBlockStart(); }
 		instance->blockStart();
+		instance->processBlock(in[0], out[0], size); // format is in/out[channel][sample]
 		for (size_t i = 0; i < size; i++) {
-			out[0][i] = instance->processAudio(in[0][i]); // format is in/out[channel][sample]
 			out[1][i] = out[0][i];
 		}
 		instance->blockEnd();
+#ifdef JAFFX_PROFILE
+		Profiler::registry().endBlock();
+#endif
 		if (instance->debug) { instance->loadMeter.OnBlockEnd(); }
 	}
 
@@ -95,22 +182,76 @@ public:
 		hardware.SetAudioSampleRate(SaiHandle::Config::SampleRate::SAI_48KHZ); // sample rate
 
 		mSDRAM.init(); // Needs to be called AFTER hardware init, and not in the object's constructor
+		mMemory.init();
 
 		// init instance and start callback
 		instance = this;
 		this->init();
 		this->initDebug();
-		hardware.StartAudio(AudioCallback);
+		if (debug) { mMemory.report(SerialPrinter()); } // where `init()` placed its state
+		hardware.StartAudio(this->audioCallback);
+
+#ifdef JAFFX_HOST
+		// render offline, running the main loop between blocks
+		auto idle = [](void* self) {
+			static_cast<Firmware*>(self)->loop();
+			static_cast<Firmware*>(self)->debugLoop();
+			static_cast<Firmware*>(self)->scheduler.run();
+		};
+		const int status = Host::render(this->audioCallback, buffersize, samplerate, idle, this);
+		this->drainTelemetry(JAFFX_TELEMETRY_SIZE);
+		if (debug) { this->printLoad(); } // final load report
+		std::exit(status);
+#endif
 
 		// loop indefinitely
 		while (true) { 
 			this->loop(); 
 			this->debugLoop(); 
+			this->scheduler.run();
 		}
 	}
 	
 };
 
+/**
+ * @brief Firmware variant that processes both channels (true stereo)
+ * 
+ * Inherit from this instead of `Firmware` to select stereo at compile time.
+ * Override `processFrame()` for per-frame processing, or `processStereoBlock()`
+ * to process whole blocks. `processAudio()`/`processBlock()` are not called.
+ */
+class StereoFirmware : public Firmware {
+public:
+	StereoFirmware() { this->audioCallback = StereoAudioCallback; }
+
+	// overridable per-frame operation
+	inline virtual void processFrame(float inL, float inR, float& outL, float& outR) {
+		outL = inL;
+		outR = inR;
+	}
+
+	// overridable per-block operation, calls `processFrame()` per frame by default
+	inline virtual void processStereoBlock(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size) {
+		for (size_t i = 0; i < size; i++) {
+			this->processFrame(in[0][i], in[1][i], out[0][i], out[1][i]);
+		}
+	}
+
+	// stereo->stereo callback
+	static void StereoAudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size) {
+		StereoFirmware* stereo = static_cast<StereoFirmware*>(instance);
+		if (stereo->debug) { stereo->loadMeter.OnBlockStart(); }
+		stereo->blockStart();
+		stereo->processStereoBlock(in, out, size);
+		stereo->blockEnd();
+#ifdef JAFFX_PROFILE
+		Profiler::registry().endBlock();
+#endif
+		if (stereo->debug) { stereo->loadMeter.OnBlockEnd(); }
+	}
+};
+
 // Global instancing of static members
 DaisySeed Firmware::hardware; 
 Firmware* Firmware::instance = nullptr;
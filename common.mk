@@ -45,6 +45,22 @@ C_INCLUDES += -I$(GIMMEL_DIR)/include
 # RTNeural compiler flags
 CPPFLAGS += -DRTNEURAL_DEFAULT_ALIGNMENT=8 -DRTNEURAL_NO_DEBUG=1 -DRTNEURAL_USE_EIGEN=1
 
+# Fast internal memory (DTCM) heap for small, hot DSP state, see include/Memory.hpp
+# e.g. `make FAST_HEAP_SIZE=32768 FAST_ALLOC_THRESHOLD=256`, FAST_HEAP_SIZE=0 sends everything to SDRAM
+FAST_HEAP_SIZE ?= 65536
+FAST_ALLOC_THRESHOLD ?= 1024
+CPPFLAGS += -DJAFFX_FAST_HEAP_SIZE=$(FAST_HEAP_SIZE) -DJAFFX_FAST_THRESHOLD=$(FAST_ALLOC_THRESHOLD)
+
+# Block-wise NAM inference (include/Wavenet.hpp) instead of rt-nam in the AmpModeler (`make WAVENET=1`)
+ifeq ($(WAVENET),1)
+CPPFLAGS += -DJAFFX_WAVENET
+endif
+
+# Per-stage profiling of Jaffx::EffectsLine chains (`make PROFILE=1`)
+ifeq ($(PROFILE),1)
+CPPFLAGS += -DJAFFX_PROFILE
+endif
+
 # Debug information (can be disabled by setting VERBOSE=0)
 ifneq ($(VERBOSE),0)
 $(info CONFIG_DIR: $(CONFIG_DIR))
@@ -2,7 +2,7 @@
 
 // AdcReads allow us to sample continuous control values
 class AdcRead : public Jaffx::Firmware {
-  bool trigger = false;
+  int counter = 0;
 
   void init() override {
     AdcChannelConfig config; // if multiple, set up as an array: `config[numAdcs]`
@@ -13,28 +13,18 @@ class AdcRead : public Jaffx::Firmware {
   }
 
   float processAudio(float in) override {
-    static int counter;
     counter++;
-    if (counter >= this->samplerate && !trigger) {
+    if (counter >= this->samplerate) { // once per second
       counter = 0;
-      trigger = true;
+      // queue a reading, printed to serial by the main loop without blocking
+      this->telemetry.push("Knob", this->hardware.adc.GetFloat(0));
     }
     return 0.f;
   }
 
-  void loop() override {
-    if (trigger) {
-      hardware.PrintLine("Knob: %d", this->hardware.adc.Get(0));
-      trigger = false;
-    }
-    System::Delay(500); // Don't spam the serial!
-  }
-
 };
 
 int main(void) {
   AdcRead mAdcRead;
   mAdcRead.start();
 }
-
-
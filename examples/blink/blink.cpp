@@ -3,27 +3,19 @@
 // Simple blink program, the "Hello World!" of embedded systems
 class Blink : public Jaffx::Firmware {
   bool ledState = true;
-  bool trigger = false;
   unsigned int counter = 0;
 
   float processAudio(float in) override {
     counter++;
-    if (counter >= this->samplerate/2 && !trigger) { // every 0.5 seconds...
+    if (counter >= this->samplerate/2) { // every 0.5 seconds...
       counter = 0;
       ledState = !ledState; // flip LED state
-      trigger = true;
+      // set it from the main loop, which sleeps until then
+      this->scheduler.post([](void* self) { hardware.SetLed(static_cast<Blink*>(self)->ledState); }, this);
     }
     return 0.f;
   }
 
-  void loop() override {
-    if (trigger) {
-      this->hardware.SetLed(ledState);
-      trigger = false;
-    }
-    System::Delay(500); // Don't spam the LED!
-  }
-
 };
 
 int main(void) {
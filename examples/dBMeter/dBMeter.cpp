@@ -24,11 +24,12 @@ class DBMeter : public Jaffx::Firmware {
       RmsReport = sqrt(RMS); // update report
       counter = 0; // reset counter
       RMS = 0.f; // reset RMS
+      this->scheduler.post([](void* self) { static_cast<DBMeter*>(self)->updateLeds(); }, this); // once per report
     }
     return in; // output throughput 
   }
 
-  void loop() override {
+  void updateLeds() {
     // Convert RMS to dB                // Add small offset to avoid log(0)   
     float dB = 20.0f * log10f(RmsReport + 1e-12f); 
     
@@ -54,8 +55,6 @@ class DBMeter : public Jaffx::Firmware {
       mLeds[1].Write(false);
       mLeds[2].Write(false);
     }
-    
-    System::Delay(1);
   }
   
 };
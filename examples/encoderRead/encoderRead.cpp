@@ -1,24 +1,33 @@
 #include "../../Jaffx.hpp"
+#include "../../include/Controls.hpp"
 
 class EncoderRead : public Jaffx::Firmware {
   Encoder mEncoder;
+  Jaffx::Controls mControls; // scanned by a main loop task at 1kHz
   int encoderState = 0;
 
   void init() override {
     mEncoder.Init(seed::A2, seed::A3, seed::A4);
+    mControls.add(mEncoder);
     this->hardware.StartLog();
+    // scanned at a steady rate so it's debounced, printed less often so it doesn't spam the serial
+    this->scheduler.every(1, [](void* self) { static_cast<EncoderRead*>(self)->readEncoder(); }, this, "scan");
+    this->scheduler.every(500, [](void* self) {
+      hardware.PrintLine("Encoder State: %d", static_cast<EncoderRead*>(self)->encoderState);
+    }, this, "print");
   }
 
   float processAudio(float in) override {
-    mEncoder.Debounce(); // debounce encoder regularly
-    encoderState += mEncoder.Increment(); // increment/decrement on turn
-    if (mEncoder.RisingEdge()) {encoderState = 0;} // reset encoder state on press
     return 0.f;
   }
 
-  void loop() override {
-    hardware.PrintLine("Encoder State: %d", encoderState);
-    System::Delay(500); // Don't spam the serial!
+  void readEncoder() {
+    mControls.scan();
+    Jaffx::ControlEvent event;
+    while (mControls.pop(event)) {
+      if (event.type == Jaffx::ControlEvent::Type::Turned) {encoderState += event.increment;} // increment/decrement on turn
+      if (event.type == Jaffx::ControlEvent::Type::Pressed) {encoderState = 0;} // reset encoder state on press
+    }
   }
   
 };
@@ -1,5 +1,6 @@
 #include "../../Jaffx.hpp"
 #include "../../Gimmel/include/gimmel.hpp"
+#include "../../include/Controls.hpp"
 #include <memory>
 #include <cmath> // Required for isnan()
 
@@ -11,11 +12,15 @@ class GimmelTests : public Jaffx::Firmware {
 	// std::unique_ptr<giml::EffectYouAreTesting<float>> mEffect;
 	giml::EffectsLine<float> signalChain;
 	Switch mReboot, mToggle;
+	Jaffx::Controls mControls; // debounces the switches from a timer interrupt
 	
 	void init() override {
 		this->debug = true;
 		mReboot.Init(seed::D18, 0.f, Switch::Type::TYPE_MOMENTARY, Switch::Polarity::POLARITY_NORMAL);
 		mToggle.Init(seed::D16, 0.f, Switch::Type::TYPE_MOMENTARY, Switch::Polarity::POLARITY_NORMAL);
+		mControls.add(mReboot); // 0
+		mControls.add(mToggle); // 1
+		mControls.startTimer(1000.f);
 
 		// mEffect = std::make_unique<giml::EffectYouAreTesting<float>>(this->samplerate);
 		// mEffect->setParams();
@@ -32,14 +37,15 @@ class GimmelTests : public Jaffx::Firmware {
    */
   void blockStart() override {
     Firmware::blockStart(); // for debug mode
-		mReboot.Debounce();
-    if (mReboot.TimeHeldMs() > 100.f) {
+    if (mControls.getTimeHeldMs(0) > 100.f) {
 			this->hardware.system.ResetToBootloader(daisy::System::BootloaderMode::DAISY_INFINITE_TIMEOUT);
 		};
 
-		mToggle.Debounce();
-		if (mToggle.FallingEdge()) {
-			signalChain[0]->toggle();
+		Jaffx::ControlEvent event;
+		while (mControls.pop(event)) {
+			if (event.index == 1 && event.type == Jaffx::ControlEvent::Type::Released) {
+				signalChain[0]->toggle();
+			}
 		}
   }
 
@@ -12,6 +12,7 @@ class LedCtrl : public Jaffx::Firmware {
 
   void init() override {
     mLed.Init(seed::D15, false);
+    this->scheduler.every(1, [](void* self) { static_cast<LedCtrl*>(self)->mLed.Update(); }, this, "led"); // PWM
   }
 
   float processAudio(float in) override {
@@ -21,11 +22,6 @@ class LedCtrl : public Jaffx::Firmware {
     return in;
   }
 
-  void loop() override {
-    mLed.Update();
-    System::Delay(1);
-  }
-
 };
 
 int main() {
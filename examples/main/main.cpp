@@ -1,57 +1,34 @@
 #include "../../Jaffx.hpp"
 #include "../../Gimmel/include/gimmel.hpp"
+#include "../../include/PresetBank.hpp"
+#include "../../include/Params.hpp"
+#include "../../include/Controls.hpp"
+#include "../../include/EffectsLine.hpp"
 #include <memory> // for unique_ptr && make_unique
 
-#include "../namTest/DumbleModel.h"
-#include "../namTest/MarshallModel.h"
-
-// Add NAM compatibility to giml
-namespace giml {
-  template <typename T, typename Layer1, typename Layer2>
-  class AmpModeler : public Effect<T> {
-  private:
-    wavenet::RTWavenet<1, 1, Layer1, Layer2> clean, dirty;
-    DumbleModelWeights cleanWeights;
-    MarshallModelWeights dirtyWeights;
-
-  public:
-    void loadModels() {
-      this->clean.loadModel(this->cleanWeights.weights);
-      this->dirty.loadModel(this->dirtyWeights.weights);
-    }
-    
-    T processSample(const T& input) override {
-      if (!this->enabled) { return this->clean.model.forward(input); }
-      return this->dirty.model.forward(input);
-    }
-  };
-}
+#include "../namTest/AmpModeler.hpp"
 
 /**
  * @brief Settings struct for writing and recalling settings
- * with persistent memory
+ * with persistent memory, one per preset (see `Jaffx::PresetBank`)
  * 
- * @todo implement "version" member to call defaults when 
- * struct has changed
+ * Bump `VERSION` when the struct changes, so saved presets are
+ * migrated or reset to these defaults
  */
 struct Settings {
+  static const uint16_t VERSION = 1;
   bool toggles[5] = { false, false, false, false, false }; // switches
-  float params[5][3]; // params
-
-  // Overloading the != operator
-  // This is necessary as this operator is used in the PersistentStorage source code
-  bool operator!=(const Settings& a) const {
-    for (int i = 0; i < 5; i++) {
-      if (toggles[i] != a.toggles[i]) { return true; } // check toggles
-      for (int j = 0; j < 3; j++) { // check params
-        if (params[i][j] != a.params[i][j]) { return true; } 
-      }
-    }
-    return false; // No mismatches found
-  }
-
+  float params[5][3] = { // params, normalized (ranges in `Main::init()`)
+    { 0.01f, 0.75f, 0.f }, // phaser: rate, feedback
+    { 0.f, 0.f, 0.f }, // amp
+    { 0.3f, 0.5f, 0.f }, // chorus: rate, depth
+    { 0.8f, 0.3f, 0.24f }, // delay: time, feedback, mix
+    { 2.f / 3.f, 1.f / 3.f, 0.5f } // compressor: threshold, ratio, knee
+  };
 };
 
+using Presets = Jaffx::PresetBank<Settings, 5, Jaffx::QspiFlash>; // one per switch
+
 /**
  * @brief struct for managing the UI
  * @todo convert from struct to class
@@ -64,16 +41,18 @@ struct InterfaceManager {
   GPIO leds[numEffects];
   Switch switches[numEffects];
   Encoder encoders[numParams + 1];
+  Jaffx::Controls controls; // debounces `switches` and `encoders`
   Settings* localSettings = nullptr;
-  PersistentStorage<Settings>* savedSettings = nullptr;
+  Presets* presets = nullptr;
+  Jaffx::Param<float>* knobs[numEffects][numParams] = {}; // params per effect, `nullptr` if none
 
   /**
    * @brief init function based on specific hardware setup
    */
-  void init(Settings& local, PersistentStorage<Settings>& saved) {
+  void init(Settings& local, Presets& saved) {
     // init settings
     localSettings = &local;
-    savedSettings = &saved;
+    presets = &saved;
     loadSettings();
 
     // init ctrls
@@ -91,39 +70,43 @@ struct InterfaceManager {
     encoders[1].Init(seed::D23, seed::D24, seed::D22);
     encoders[2].Init(seed::D25, seed::D26, seed::D22);
     encoders[3].Init(seed::D27, seed::D28, seed::D22);
+
+    // scanned from a timer interrupt, off the audio callback
+    for (auto& s : switches) { controls.add(s); }
+    for (auto& e : encoders) { controls.add(e); }
+    controls.startTimer(1000.f);
   }
 
+  // handles the events published by `controls`, never touches GPIO
   void processInput() {
-    // debounce encoders and switches
-    for (auto& e : encoders) { e.Debounce(); }
-    for (auto& s : switches) { s.Debounce(); }
+    using Event = Jaffx::ControlEvent;
 
     // hold leftmost switch to enter bootloader
-    if (switches[0].TimeHeldMs() > 500.f) { 
+    if (controls.getTimeHeldMs(0) > 500.f) { 
       System::ResetToBootloader(System::BootloaderMode::DAISY_INFINITE_TIMEOUT);
     }
-    
-    // check encoder[0] for edit mode. 
-    // `RisingEdge()` triggers at boot, `FallingEdge()` preferred
-    if (encoders[0].FallingEdge()) {
-      editMode = !editMode; // flip state
-      if (!editMode) { saveSettings(); } // if exiting edit mode, save settings
-    } 
 
-    // if editmode, process selector and param knobs
-    if (editMode) { 
-      select = (select + numEffects + encoders[0].Increment()) % numEffects;
-      auto& selection = localSettings->params[select];
-      for (int i = 0; i < numParams; i++) {
-        selection[i] += encoders[i + 1].Increment() * 0.05f;
-        selection[i] = giml::clip<float>(selection[i], 0.f, 1.f); 
-        // TODO: encapsulate clamping in a param class^
-      }
-    } else { // if !editMode
-      for (int i = 0; i < numEffects; i++) {
-        if (switches[i].FallingEdge()) { // Toggle switches
-          localSettings->toggles[i] = !localSettings->toggles[i];
+    Event event;
+    while (controls.pop(event)) {
+      if (event.source == Event::Source::Encoder) {
+        // check encoder[0] for edit mode. 
+        // `RisingEdge()` triggers at boot, `FallingEdge()` preferred
+        if (event.index == 0 && event.type == Event::Type::Released) {
+          editMode = !editMode; // flip state
+          if (!editMode) { saveSettings(); } // if exiting edit mode, save settings
         }
+        // if editmode, process selector and param knobs
+        if (!editMode || event.type != Event::Type::Turned) { continue; }
+        if (event.index == 0) { select = (select + numEffects + event.increment) % numEffects; }
+        else if (knobs[select][event.index - 1]) { // clamped to the param's range
+          knobs[select][event.index - 1]->nudge(event.increment);
+        }
+      }
+      else if (event.type != Event::Type::Released) { continue; }
+      else if (editMode) { // recall presets from RAM, unsaved edits are dropped
+        *localSettings = presets->recall(event.index);
+      } else { // Toggle switches
+        localSettings->toggles[event.index] = !localSettings->toggles[event.index];
       }
     }
   }
@@ -137,73 +120,130 @@ struct InterfaceManager {
     } 
   }
 
-  // Get stored settings and write to local
-	void loadSettings() { *localSettings = savedSettings->GetSettings(); }
-
-  // Save local settings to persistent memory
-  void saveSettings() {
-    savedSettings->GetSettings() = *localSettings; 
-    savedSettings->Save(); // save to persistent memory
+  // Get the stored presets and write the current one to local, keeps the defaults if none
+  void loadSettings() {
+    presets->mount();
+    *localSettings = presets->recall(presets->getCurrent());
   }
+
+  // Store local settings in the current preset, saved to persistent memory by a main loop task,
+  // this never touches flash so it's safe from the audio callback
+  void saveSettings() { presets->store(presets->getCurrent(), *localSettings); }
 };
 
 /**
  * @brief firmware for the Jaffx pedal
- * @todo implement param callbacks
  */
 class Main : public Jaffx::Firmware {
-  PersistentStorage<Settings> mPersistentStorage{hardware.qspi}; // PersistentStorage for settings
+  Jaffx::QspiFlash mFlash{hardware.qspi}; // last 64KB of QSPI
+  Presets mPresets{mFlash}; // saved settings, cached in RAM
 	Settings mSettings; // local settings 
   InterfaceManager mInterfaceManager; 
+  Jaffx::ParamRegistry<float> mParams{samplerate, buffersize}; // `mSettings.params`, smoothed
 
   // effects 
   std::unique_ptr<giml::Phaser<float>> mPhaser;
-  giml::AmpModeler<float, Layer1, Layer2> mAmpModeler{};
+  Jaffx::PlacedPtr<giml::AmpModeler<float>> mAmpModeler;
   std::unique_ptr<giml::Expander<float>> mExpander;
   std::unique_ptr<giml::Chorus<float>> mChorus;
   std::unique_ptr<giml::Delay<float>> mDelay;
   std::unique_ptr<giml::Compressor<float>> mCompressor;
-  giml::EffectsLine<float> mFxChain{6};
+  Jaffx::EffectsLine<float> mAmpChain{2}; // phaser and amp, processed a block at a time
+  Jaffx::EffectsLine<float> mFxChain{4}; // `make PROFILE=1` for per-effect load
+  static const size_t arenaSize = 8 * 1024 * 1024; // for effect buffers
 
   void init() override {
     hardware.StartLog();
     // this->debug = true;
-    mPersistentStorage.Init(mSettings);
-    mInterfaceManager.init(mSettings, mPersistentStorage);
+    mInterfaceManager.init(mSettings, mPresets);
+
+    // effects are built once, so their buffers come from a bump arena
+    Jaffx::mArena.init(Jaffx::mSDRAM.malloc(arenaSize), arenaSize);
+    Jaffx::mArena.open();
 
     // ~15% CPU load
+    Jaffx::mMemory.setTag("phaser"); // for the placement report (`this->debug = true`)
     mPhaser = std::make_unique<giml::Phaser<float>>(this->samplerate);
     mPhaser->setParams();
     mPhaser->enable();
-    mFxChain.pushBack(mPhaser.get());
-
-    // ~71% CPU load`
-    mAmpModeler.loadModels();
-    mFxChain.pushBack(&mAmpModeler);
+    mAmpChain.pushBack(mPhaser.get(), "phaser");
+
+    // ~71% CPU load with rt-nam (the default, one `forward()` per sample)
+    Jaffx::mMemory.setTag("amp");
+    mAmpModeler = Jaffx::makePlaced<giml::AmpModeler<float>>(Jaffx::Placement::Fast); // the bank and its crossfade buffer
+    // Networks go to fast memory if they fit, but a float one (~80KB) is larger than the
+    // default FAST_HEAP_SIZE (64KB) and a crossfade holds two, so they fall back to SDRAM
+    mAmpModeler->setPlacement(Jaffx::Placement::Fast);
+    mAmpModeler->loadModels();
+    if (mAmpModeler->getRegion() != Jaffx::Memory::Region::Fast) {
+      hardware.PrintLine("amp: model in SDRAM, the fast heap is too small for it (FAST_HEAP_SIZE)");
+    }
+    mAmpChain.pushBack(mAmpModeler.get(), "amp");
 
+    Jaffx::mMemory.setTag("expander");
     mExpander = std::make_unique<giml::Expander<float>>(this->samplerate);
     mExpander->setParams(-50.f, 4.f, 5.f);
     mExpander->enable();
     mExpander->toggleSideChain(true);
-    mFxChain.pushBack(mExpander.get());
+    mFxChain.pushBack(mExpander.get(), "expander");
 
     // ~3% CPU load
+    Jaffx::mMemory.setTag("chorus");
     mChorus = std::make_unique<giml::Chorus<float>>(this->samplerate);
     mChorus->setParams(0.2, 10.f);
     mChorus->enable();
-    mFxChain.pushBack(mChorus.get());
+    mFxChain.pushBack(mChorus.get(), "chorus");
 
     // ~2% CPU load  
+    Jaffx::mMemory.setTag("delay");
     mDelay = std::make_unique<giml::Delay<float>>(this->samplerate);
     mDelay->setParams(398.f, 0.3f, 0.7f, 0.24f);
     mDelay->enable();
-    mFxChain.pushBack(mDelay.get());
+    mFxChain.pushBack(mDelay.get(), "delay");
 
     // ~3% CPU load
+    Jaffx::mMemory.setTag("compressor");
     mCompressor = std::make_unique<giml::Compressor<float>>(this->samplerate);
     mCompressor->setParams(-20.f, 4.f, 10.f, 5.f, 3.5f, 100.f);
     mCompressor->enable();
-    mFxChain.pushBack(mCompressor.get());
+    mFxChain.pushBack(mCompressor.get(), "compressor");
+    Jaffx::mArena.close();
+    Jaffx::mMemory.setTag(nullptr);
+
+    // params, applied to an effect only when one of them changes
+    auto& params = mSettings.params;
+    auto& knobs = mInterfaceManager.knobs;
+    mParams.addGroup([](void* self, const Jaffx::Param<float>* p) {
+      // clipped too, as presets write the normalized values directly
+      static_cast<Main*>(self)->mPhaser->setParams(giml::clip<float>(p[0].getValue(), 0.f, 20.f),
+                                                   giml::clip<float>(p[1].getValue(), -1.f, 1.f));
+    }, this);
+    knobs[0][0] = mParams.add("phaser rate", &params[0][0], 0.f, 20.f); // Hz
+    knobs[0][1] = mParams.add("phaser feedback", &params[0][1], -1.f, 1.f);
+    mParams.addGroup([](void* self, const Jaffx::Param<float>* p) {
+      static_cast<Main*>(self)->mChorus->setParams(p[0].getValue(), p[1].getValue());
+    }, this);
+    knobs[2][0] = mParams.add("chorus rate", &params[2][0], 0.05f, 5.f, Jaffx::Taper::Exponential); // Hz
+    knobs[2][1] = mParams.add("chorus depth", &params[2][1], 0.f, 20.f); // ms
+    mParams.addGroup([](void* self, const Jaffx::Param<float>* p) {
+      static_cast<Main*>(self)->mDelay->setParams(p[0].getValue(), p[1].getValue(), 0.7f, p[2].getValue());
+    }, this);
+    knobs[3][0] = mParams.add("delay time", &params[3][0], 10.f, 1000.f, Jaffx::Taper::Exponential); // ms
+    knobs[3][1] = mParams.add("delay feedback", &params[3][1], 0.f, 1.f);
+    knobs[3][2] = mParams.add("delay mix", &params[3][2], 0.f, 1.f);
+    mParams.addGroup([](void* self, const Jaffx::Param<float>* p) {
+      // TODO: defaults in giml
+      static_cast<Main*>(self)->mCompressor->setParams(p[0].getValue(), p[1].getValue(), p[2].getValue(), 5.f, 3.5f, 100.f);
+    }, this);
+    knobs[4][0] = mParams.add("threshold", &params[4][0], -60.f, 0.f); // dB
+    knobs[4][1] = mParams.add("ratio", &params[4][1], 1.f, 10.f);
+    knobs[4][2] = mParams.add("knee", &params[4][2], 0.f, 20.f); // dB
+    mParams.reset(); // from the recalled preset
+
+    // main loop work, each at its own rate (the core sleeps in between)
+    this->scheduler.every(20, [](void* self) { static_cast<Main*>(self)->mInterfaceManager.processOutput(); }, this, "leds");
+    this->scheduler.every(10, [](void* self) { static_cast<Main*>(self)->mPresets.service(); }, this, "presets"); // one flash operation at a time
+    this->scheduler.every(20, [](void* self) { static_cast<Main*>(self)->mAmpModeler->update(); }, this, "amp"); // loads the other amp model when toggled
 
     // Crashes the system
     // mReverb = std::make_unique<giml::Reverb<float>>(this->samplerate);
@@ -212,9 +252,6 @@ class Main : public Jaffx::Firmware {
     // mFxChain.pushBack(mReverb.get());
   }
 
-  /**
-   * @todo callbacks for params/setters
-   */
   void blockStart() override {
     Firmware::blockStart(); // for debug mode
     mInterfaceManager.processInput();
@@ -224,40 +261,31 @@ class Main : public Jaffx::Firmware {
     // for (unsigned int i = 0; i < numToggles; i++) {
     //   mFxChain[i]->toggle(mSettings.toggles[i]);
     // }
-    mFxChain[0]->toggle(mSettings.toggles[0]);
-    mFxChain[1]->toggle(mSettings.toggles[1]);
-    // skip expander
-    mFxChain[3]->toggle(mSettings.toggles[2]);
-    mFxChain[4]->toggle(mSettings.toggles[3]);
-    // skip compressor
+    // through the chains, which skip disabled effects and crossfade toggles
+    mAmpChain.toggle(0, mSettings.toggles[0]); // phaser
+    mAmpChain.toggle(1, mSettings.toggles[1]); // amp (clean model when disabled)
+    mFxChain.toggle(1, mSettings.toggles[2]); // chorus
+    mFxChain.toggle(2, mSettings.toggles[3]); // delay
 
     if (mSettings.toggles[1]) { // if amp modeler is enabled
-      mCompressor->disable(); // disable compressor
-      mExpander->toggle(mSettings.toggles[4]);
+      mFxChain.disable(3); // disable compressor
+      mFxChain.toggle(0, mSettings.toggles[4]); // expander
     } else {
-      mExpander->disable();
-      mCompressor->toggle(mSettings.toggles[4]);
+      mFxChain.disable(0);
+      mFxChain.toggle(3, mSettings.toggles[4]);
     }
 
-    // prototyping setters. TODO: Interrupt Callbacks (for efficiency)
-    // auto& s = mSettings;
-    if (mInterfaceManager.editMode) {
-      // mDetune->setParams(s.params[0][0] * 0.1 + 0.9, giml::clip<float>(10.f + s.params[0][1] * 40.f, 10.f, 50.f), s.params[0][2]);
-      // mPhaser->setParams(giml::clip<float>(s.params[1][0] * 20.f, 0.f, 20.f), giml::clip<float>(s.params[1][1] * 2 - 1, -1, 1));
-      // mDelay->setParams(1000.0 * s.params[2][0], s.params[2][1], 0.7f, s.params[2][3]);
-      // mCompressor->setParams(-s.params[3][0] * 60, s.params[3][1] * 10.f, s.params[3][2] * 20, 5.f, 3.5f, 100.f); // TODO: defaults in giml
-      // mReverb->setParams(s.params[4][0] * 0.1, s.params[4][1] * 0.3, 0.5f, s.params[4][2], 50.f, 0.9f);
-    }
+    // only effects whose params changed (edits, or a recalled preset) are set, while they ramp
+    mParams.dispatch();
   }
 
-  float processAudio(float in) override {
-    mExpander->feedSideChain(in);
-    return mFxChain.processSample(in);
-  }
-  
-  void loop() override {
-    mInterfaceManager.processOutput();
-    System::Delay(50); // what's a good value?
+  void processBlock(const float* in, float* out, size_t size) override {
+    mAmpChain.processBlock(in, out, size);
+    mFxChain.update();
+    for (size_t i = 0; i < size; i++) {
+      mExpander->feedSideChain(in[i]);
+      out[i] = mFxChain.processSample(out[i]);
+    }
   }
 
 };
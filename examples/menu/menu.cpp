@@ -1,4 +1,6 @@
 #include "../../Jaffx.hpp"
+#include "../../include/Params.hpp"
+#include "../../include/Controls.hpp"
 
 // Hardware config:
 // led1 on pin D14
@@ -15,42 +17,38 @@ struct MenuManager {
   bool editMode = false; // encoder press
   int select = 0; // selector
   bool toggles[3]; // led on/off when !editMode
-  float params[3]; // params (will only modify params[0] in this app)
+  Jaffx::Param<float> params[3]; // params, 0 to 1 (will only modify params[0] in this app)
   GPIO leds[3]; 
   Encoder encoders[2]; 
+  Jaffx::Controls controls; // debounces `encoders` from a timer interrupt
 
   void init() {
     for (auto &t : toggles) {t = true;} // init all toggles true for now
-    for (auto & p: params) {p = 0.f;} // init all params 0.f for now
+    for (auto & p: params) {p.setStep(0.01f);} // params start at 0.f
     leds[0].Init(seed::D14, GPIO::Mode::OUTPUT); // init led1
     leds[1].Init(seed::D13, GPIO::Mode::OUTPUT); // init led2
     leds[2].Init(seed::D12, GPIO::Mode::OUTPUT); // init led3
     encoders[0].Init(seed::A0, seed::A1, seed::A2); // init encoder1
     encoders[1].Init(seed::A3, seed::A4, seed::A5); // init encoder2
+    for (auto& e : encoders) { controls.add(e); }
+    controls.startTimer(1000.f);
   }
 
   void processInput() {
-    // debounce encoders
-    for (int i = 0; i < 2; i++) {
-      encoders[i].Debounce();
+    // events from `controls`, debounced outside the audio callback
+    Jaffx::ControlEvent event;
+    while (controls.pop(event)) {
+      if (event.type == Jaffx::ControlEvent::Type::Pressed) {
+        // check encoder1 for edit mode, encoder2 for toggle[0] state
+        if (event.index == 0) {editMode = !editMode;} // flip state
+        else {toggles[0] = !toggles[0];}
+      } else if (event.type == Jaffx::ControlEvent::Type::Turned && editMode) {
+        // if editmode, process selector and param knob
+        if (event.index == 0) {select = (select + 3 + event.increment) % 3;} // process selector with modulus logic
+        else {params[select].nudge(event.increment);} // modify the selected param, clamped to 0 to 1
+      }
     }
 
-    // check encoder1 for edit mode, encoder2 for toggle[0] state
-    if (encoders[0].RisingEdge()) {editMode = !editMode;} // flip state
-    if (encoders[1].RisingEdge()) {toggles[0] = !toggles[0];}
-
-    // if editmode, process selector and param knob
-    if (editMode) { // if edit mode
-      select = (select + 3 + encoders[0].Increment()) % 3; // process selector with modulus logic
-      for (int i = 0; i < 3; i++) {
-        if (select == i) { // modify params based on which is selected
-          params[i] += encoders[1].Increment() * 0.01f;
-          params[i] = (params[i] < 0.f) ? 0.f : (params[i] > 1.f ? 1.f : params[i]); 
-          // ^TODO: handle clamping in a param class 
-        }
-      } 
-    } 
-
   }
 
   void processOutput() {
@@ -74,37 +72,28 @@ class Menu : public Jaffx::Firmware {
   void init() override {
     mMenuManager.init();
     hardware.StartLog();
+    this->scheduler.every(20, [](void* self) { static_cast<Menu*>(self)->mMenuManager.processOutput(); }, this, "display");
   }
 
   void blockStart() override {
     mMenuManager.processInput();
   }
 
-  bool trigger = false;
   int counter = 0;
   float processAudio(float in) override {
     counter++;
-    if (counter >= samplerate && !trigger) {
-      trigger = true;
+    if (counter >= samplerate) { // print param vals once per second, from the main loop
       counter = 0;
+      this->scheduler.post([](void* self) { static_cast<Menu*>(self)->printParams(); }, this);
     }
     return 0.f;
   }
 
-  // should this loop have a `System::Delay()` in it to reduce CPU?
-  void loop() override {
-
-    mMenuManager.processOutput();
-
-    // print param vals once per second
-    if (trigger) {
-      hardware.PrintLine("Params:");
-      hardware.PrintLine("params[0]: " FLT_FMT3, FLT_VAR3(mMenuManager.params[0]));
-      hardware.PrintLine("params[1]: " FLT_FMT3, FLT_VAR3(mMenuManager.params[1]));
-      hardware.PrintLine("params[2]: " FLT_FMT3, FLT_VAR3(mMenuManager.params[2]));
-      trigger = false;
-    }
-
+  void printParams() {
+    hardware.PrintLine("Params:");
+    hardware.PrintLine("params[0]: " FLT_FMT3, FLT_VAR3(mMenuManager.params[0].get()));
+    hardware.PrintLine("params[1]: " FLT_FMT3, FLT_VAR3(mMenuManager.params[1].get()));
+    hardware.PrintLine("params[2]: " FLT_FMT3, FLT_VAR3(mMenuManager.params[2].get()));
   }
   
 };
@@ -1,31 +1,11 @@
 #include "../../Jaffx.hpp"
 #include "../../Gimmel/include/gimmel.hpp"
+#include "../../include/PresetJournal.hpp"
+#include "../../include/Params.hpp"
+#include "../../include/Controls.hpp"
 #include <memory> // for unique_ptr && make_unique
 
-#include "../namTest/DumbleModel.h"
-#include "../namTest/MarshallModel.h"
-
-// Add NAM compatibility to giml
-namespace giml {
-  template <typename T, typename Layer1, typename Layer2>
-  class AmpModeler : public Effect<T> {
-  private:
-    wavenet::RTWavenet<1, 1, Layer1, Layer2> clean, dirty;
-    DumbleModelWeights cleanWeights;
-    MarshallModelWeights dirtyWeights;
-
-  public:
-    void loadModels() {
-      this->clean.loadModel(this->cleanWeights.weights);
-      this->dirty.loadModel(this->dirtyWeights.weights);
-    }
-    
-    T processSample(const T& input) override {
-      if (!this->enabled) { return this->clean.model.forward(input); }
-      return this->dirty.model.forward(input);
-    }
-  };
-}
+#include "../namTest/AmpModeler.hpp"
 
 //=====================================================================
 // ADD USER DEFINITIONS HERE
@@ -35,27 +15,14 @@ namespace giml {
 
 /**
  * @brief Settings struct for writing and recalling settings
- * with persistent memory
+ * with persistent memory (see `Jaffx::PresetJournal`)
  * 
  * @todo implement "version" member to call defaults when 
  * struct has changed
  */
 struct Settings {
   bool toggles[5] = { false, false, false, false, false }; // switches
-  float params[5][3]; // params
-
-  // Overloading the != operator
-  // This is necessary as this operator is used in the PersistentStorage source code
-  bool operator!=(const Settings& a) const {
-    for (int i = 0; i < 5; i++) {
-      if (toggles[i] != a.toggles[i]) { return true; } // check toggles
-      for (int j = 0; j < 3; j++) { // check params
-        if (params[i][j] != a.params[i][j]) { return true; } 
-      }
-    }
-    return false; // No mismatches found
-  }
-
+  float params[5][3] = {}; // params
 };
 
 /**
@@ -70,8 +37,10 @@ struct InterfaceManager {
   GPIO leds[numEffects];
   Switch switches[numEffects];
   Encoder encoders[numParams + 1];
+  Jaffx::Controls controls; // debounces `switches` and `encoders`
   Settings* localSettings = nullptr;
-  PersistentStorage<Settings>* savedSettings = nullptr;
+  Jaffx::PresetJournal<Settings, Jaffx::QspiFlash>* savedSettings = nullptr;
+  Jaffx::Param<float>* knobs[numEffects][numParams] = {}; // params per effect, `nullptr` if none
 
   /**
    * @brief init function based on specific hardware setup
@@ -86,7 +55,7 @@ struct InterfaceManager {
    * 
    * encoders 1-3 on pins D18-22, D19-23, D17
    */
-  void init(Settings& local, PersistentStorage<Settings>& saved) {
+  void init(Settings& local, Jaffx::PresetJournal<Settings, Jaffx::QspiFlash>& saved) {
     // init settings
     localSettings = &local;
     savedSettings = &saved;
@@ -107,40 +76,41 @@ struct InterfaceManager {
     encoders[1].Init(seed::D23, seed::D24, seed::D22);
     encoders[2].Init(seed::D25, seed::D26, seed::D22);
     encoders[3].Init(seed::D27, seed::D28, seed::D22);
+
+    // scanned from a timer interrupt, off the audio callback
+    for (auto& s : switches) { controls.add(s); }
+    for (auto& e : encoders) { controls.add(e); }
+    controls.startTimer(1000.f);
   }
 
+  // handles the events published by `controls`, never touches GPIO
   void processInput() {
-    // debounce encoders and switches
-    for (auto& e : encoders) { e.Debounce(); }
-    for (auto& s : switches) { s.Debounce(); }
+    using Event = Jaffx::ControlEvent;
 
     // hold leftmost switch to enter bootloader
-    if (switches[0].TimeHeldMs() > 500.f) { 
+    if (controls.getTimeHeldMs(0) > 500.f) { 
       System::ResetToBootloader(System::BootloaderMode::DAISY_INFINITE_TIMEOUT);
     }
-    
-    // check encoder[0] for edit mode. 
-    // `RisingEdge()` triggers at boot, `FallingEdge()` preferred
-    if (encoders[0].FallingEdge()) {
-      editMode = !editMode; // flip state
-      if (!editMode) { saveSettings(); } // if exiting edit mode, save settings
-    } 
 
-    // if editmode, process selector and param knobs
-    if (editMode) { 
-      select = (select + numEffects + encoders[0].Increment()) % numEffects;
-      auto& selection = localSettings->params[select];
-      for (int i = 0; i < numParams; i++) {
-        selection[i] += encoders[i + 1].Increment() * 0.05f;
-        selection[i] = giml::clip<float>(selection[i], 0.f, 1.f); 
-        // TODO: encapsulate clamping in a param class^
-      }
-    } else { // if !editMode
-      for (int i = 0; i < numEffects; i++) {
-        if (switches[i].RisingEdge()) { // Toggle switches... Pressed() or RisingEdge()?
-          localSettings->toggles[i] = !localSettings->toggles[i];
+    Event event;
+    while (controls.pop(event)) {
+      if (event.source == Event::Source::Encoder) {
+        // check encoder[0] for edit mode. 
+        // `RisingEdge()` triggers at boot, `FallingEdge()` preferred
+        if (event.index == 0 && event.type == Event::Type::Released) {
+          editMode = !editMode; // flip state
+          if (!editMode) { saveSettings(); } // if exiting edit mode, save settings
+        }
+        // if editmode, process selector and param knobs
+        if (!editMode || event.type != Event::Type::Turned) { continue; }
+        if (event.index == 0) { select = (select + numEffects + event.increment) % numEffects; }
+        else if (knobs[select][event.index - 1]) { // clamped to the param's range
+          knobs[select][event.index - 1]->nudge(event.increment);
         }
       }
+      else if (!editMode && event.type == Event::Type::Pressed) { // Toggle switches... Pressed or Released?
+        localSettings->toggles[event.index] = !localSettings->toggles[event.index];
+      }
     }
   }
 
@@ -153,24 +123,23 @@ struct InterfaceManager {
     } 
   }
 
-  // Get stored settings and write to local
-	void loadSettings() { *localSettings = savedSettings->GetSettings(); }
+  // Get stored settings and write to local, keeps the defaults if none
+  void loadSettings() { savedSettings->mount(*localSettings); }
 
-  // Save local settings to persistent memory
-  void saveSettings() {
-    savedSettings->GetSettings() = *localSettings; 
-    savedSettings->Save(); // save to persistent memory
-  }
+  // Queue local settings to be saved to persistent memory by a main loop task,
+  // this never touches flash so it's safe from the audio callback
+  void saveSettings() { savedSettings->save(*localSettings); }
 };
 
 /**
  * @brief firmware for the Jaffx pedal
- * @todo implement param callbacks
  */
 class MultiFxTemplate : public Jaffx::Firmware {
-  PersistentStorage<Settings> mPersistentStorage{hardware.qspi}; // PersistentStorage for settings
+  Jaffx::QspiFlash mFlash{hardware.qspi}; // last 64KB of QSPI
+  Jaffx::PresetJournal<Settings, Jaffx::QspiFlash> mJournal{mFlash}; // saved settings
 	Settings mSettings; // local settings 
   InterfaceManager mInterfaceManager; 
+  Jaffx::ParamRegistry<float> mParams{samplerate, buffersize}; // `mSettings.params`, smoothed
 
   //=====================================================================
   // ADD GIMMEL EFFECTS HERE
@@ -181,8 +150,7 @@ class MultiFxTemplate : public Jaffx::Firmware {
 
 
   void init() override {
-    mPersistentStorage.Init(mSettings);
-    mInterfaceManager.init(mSettings, mPersistentStorage);
+    mInterfaceManager.init(mSettings, mJournal);
 
     //=====================================================================
     // CONSTRUCT EFFECTS HERE
@@ -191,11 +159,23 @@ class MultiFxTemplate : public Jaffx::Firmware {
     // mFxChain.pushBack(mEffect.get());
     // ...
     //====================================================================
+
+    //=====================================================================
+    // ADD PARAMS HERE, applied only when they change
+    // mParams.addGroup([](void* self, const Jaffx::Param<float>* p) {
+    //   static_cast<MultiFxTemplate*>(self)->mEffect->setParams(p[0].getValue(), p[1].getValue());
+    // }, this);
+    // mInterfaceManager.knobs[0][0] = mParams.add("rate", &mSettings.params[0][0], 0.05f, 5.f, Jaffx::Taper::Exponential);
+    // mInterfaceManager.knobs[0][1] = mParams.add("depth", &mSettings.params[0][1], 0.f, 1.f);
+    // ...
+    //=====================================================================
+    mParams.reset(); // from the saved settings
+
+    // main loop work, each at its own rate (the core sleeps in between)
+    this->scheduler.every(25, [](void* self) { static_cast<MultiFxTemplate*>(self)->mInterfaceManager.processOutput(); }, this, "leds");
+    this->scheduler.every(10, [](void* self) { static_cast<MultiFxTemplate*>(self)->mJournal.service(); }, this, "journal"); // one flash operation at a time
   }
 
-  /**
-   * @todo callbacks for params/setters
-   */
   void blockStart() override {
     Firmware::blockStart(); // for debug mode
     mInterfaceManager.processInput();
@@ -204,25 +184,12 @@ class MultiFxTemplate : public Jaffx::Firmware {
       mFxChain[i]->toggle(mSettings.toggles[i]);
     }
 
-    // prototyping setters. TODO: Callbacks (for efficiency)
-    auto& s = mSettings;
-    if (mInterfaceManager.editMode) {
-      //========================================================================
-      // Set params here
-      // mFxChain[0]->setParams(s.params[0][0], s.params[0][1], s.params[0][2]);
-      // ... 
-      //========================================================================
-    }
+    mParams.dispatch(); // runs the callbacks of changed params
   }
 
   float processAudio(float in) override {
     return mFxChain.processSample(in);
   }
-  
-  void loop() override {
-    mInterfaceManager.processOutput();
-    System::Delay(25); // what's a good value?
-  }
 
 };
 
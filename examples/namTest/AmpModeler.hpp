@@ -0,0 +1,134 @@
+#pragma once
+#include "../../include/EffectsLine.hpp"
+#include "../../include/Wavenet.hpp"
+#include "../../include/QuantizedWavenet.hpp"
+#include "../../include/ModelBank.hpp"
+
+#include "DumbleModel.h"
+#include "MarshallModel.h"
+
+// Activations of the models: NeuralAmpModelerCore's fast tanh, or
+// `Jaffx::wavenet::FastMathsProvider<Jaffx::Accuracy::...>` (see host/bench/activations.cpp)
+using AmpMaths = Jaffx::wavenet::NAMMathsProvider;
+
+// Architecture of DumbleModel.nam and MarshallModel.nam (the standard NAM WaveNet),
+// their weights are generated with `python namToArray.py --calibrate <model>.nam`
+using AmpLayerArray1 = 
+Jaffx::wavenet::LayerArray<float, 
+                           1, // input_size
+                           1, // condition_size
+                           2, // head_size
+                           2, // channels
+                           3, // kernel_size
+                           Jaffx::wavenet::Dilations<1, 2, 4, 8, 16, 32, 64>, // dilations
+                           false, // head_bias
+                           AmpMaths>;
+
+using AmpLayerArray2 = 
+Jaffx::wavenet::LayerArray<float, 
+                           2, // input_size
+                           1, // condition_size
+                           1, // head_size
+                           2, // channels
+                           3, // kernel_size
+                           Jaffx::wavenet::Dilations<128, 256, 512, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512>, // dilations
+                           true, // head_bias
+                           AmpMaths>;
+
+// Block-wise inference (include/Wavenet.hpp), opt-in with `make WAVENET=1` until
+// `make bench RTNEURAL=1` (host/bench/wavenet.cpp) shows it's sample-identical to rt-nam
+using BlockAmpModel = Jaffx::wavenet::Wavenet<AmpLayerArray1, AmpLayerArray2>;
+
+#if !defined(JAFFX_WAVENET) || defined(JAFFX_BENCH_RTNEURAL)
+#include <vector>
+#include "rt-nam.hpp"
+
+/**
+ * @brief The same architecture run by RTNeural's rt-nam, the reference inference
+ *
+ * Has the interface `Jaffx::ModelBank` expects. rt-nam only runs a sample at
+ * a time, so `process()` loops over `forward()`.
+ */
+class RTNamAmpModel {
+  using Layer1 = wavenet::Layer_Array<float, 1, 1, 2, 2, 3, wavenet::Dilations<1, 2, 4, 8, 16, 32, 64>, false, wavenet::NAMMathsProvider>;
+  using Layer2 = wavenet::Layer_Array<float, 2, 1, 1, 2, 3, wavenet::Dilations<128, 256, 512, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512>, true, wavenet::NAMMathsProvider>;
+  wavenet::RTWavenet<1, 1, Layer1, Layer2> network;
+
+public:
+  typedef AmpLayerArray1 LayerArray1; // for `Jaffx::ModelFile::matches()`
+  typedef AmpLayerArray2 LayerArray2;
+
+  static constexpr int numWeights() { return BlockAmpModel::numWeights(); }
+  static constexpr int maxBlock() { return BlockAmpModel::maxBlock(); }
+
+  // Loads weights in `.nam` order (rt-nam prewarms), false if `count` doesn't match the architecture
+  bool loadModel(const float* weights, size_t count, const int8_t* /*residualBits*/ = nullptr) {
+    if (count != size_t(numWeights())) { return false; }
+    std::vector<float> copy(weights, weights + count); // rt-nam reads from a vector
+    this->network.loadModel(copy);
+    return true;
+  }
+
+  float forward(float input) { return this->network.model.forward(input); }
+
+  void process(const float* in, float* out, size_t size) {
+    for (size_t i = 0; i < size; i++) { out[i] = this->network.model.forward(in[i]); }
+  }
+};
+#endif
+
+#ifdef JAFFX_WAVENET
+using AmpModel = BlockAmpModel;
+#else
+using AmpModel = RTNamAmpModel;
+#endif
+
+// Fixed-point version, about half the memory and cheaper on the Cortex-M7
+using QuantizedAmpModel = Jaffx::wavenet::QuantizedWavenet<AmpLayerArray1, AmpLayerArray2>;
+
+// Add NAM compatibility to giml
+namespace giml {
+  /**
+   * @brief Clean (Dumble) model when disabled, dirty (Marshall) model when enabled
+   * 
+   * Only the active model's network is in memory, toggling crossfades to the
+   * other one once `update()` (called from the main loop) has loaded it.
+   * `processBlock()` runs the model a block at a time, with exactly the same
+   * output as calling `processSample()` per sample, which with `BlockAmpModel`
+   * is ~6x cheaper on host (`host/bench/wavenet.cpp`), with rt-nam the same.
+   * `Model` can be `QuantizedAmpModel` to run in fixed point.
+   */
+  template <typename T, typename Model = AmpModel>
+  class AmpModeler : public Jaffx::BlockEffect<T> {
+  private:
+    Jaffx::ModelBank<Model> bank;
+
+  public:
+    AmpModeler() {
+      this->bank.add("dumble", DumbleModel_weights, DumbleModel_weights_len, DumbleModel_residual_bits);
+      this->bank.add("marshall", MarshallModel_weights, MarshallModel_weights_len, MarshallModel_residual_bits);
+    }
+
+    // Where the networks are allocated, before `loadModels()`
+    void setPlacement(Jaffx::Placement where) { this->bank.setPlacement(where); }
+
+    // Where the active network ended up
+    Jaffx::Memory::Region getRegion() const { return this->bank.getRegion(); }
+
+    // Loads the model for the current state, call from `init()`
+    void loadModels() { this->bank.load(this->enabled ? 1 : 0); }
+
+    // Follows `enable()`/`disable()`, call from the main loop
+    void update() {
+      this->bank.select(this->enabled ? 1 : 0);
+      this->bank.update();
+    }
+    
+    T processSample(const T& input) override { return this->bank.forward(input); }
+
+    void processBlock(const T* in, T* out, size_t size) override { this->bank.process(in, out, size); }
+
+    // disabled selects the clean model, so `Jaffx::EffectsLine` must not skip it
+    bool bypassable() const override { return false; }
+  };
+}
@@ -1,53 +1,95 @@
-/*
+// Converted from DumbleModel.nam by namToArray.py
+// Architecture: WaveNet
+// Layer array 1: {"input_size": 1, "condition_size": 1, "head_size": 2, "channels": 2, "kernel_size": 3, "dilations": [1, 2, 4, 8, 16, 32, 64], "activation": "Tanh", "gated": false, "head_bias": false}
+// Layer array 2: {"input_size": 2, "condition_size": 1, "head_size": 1, "channels": 2, "kernel_size": 3, "dilations": [128, 256, 512, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512], "activation": "Tanh", "gated": false, "head_bias": true}
+// Head scale: 0.02
+// Sample rate: 48000 Hz
 
-Generated by RTNeural/modules/rt-nam/nam_to_header.py
+#ifndef DUMBLEMODEL_H
+#define DUMBLEMODEL_H
 
-Usage:
-
-#include "model.h"
-
-class MyAudioApp {
-  DumbleModelWeights weights;
-  unsigned int ioChannels = 1, samplesPerBuffer = 1;
-  wavenet::RTWavenet<ioChannels, 
-                     samplesPerBuffer, 
-                     Layer1, 
-                     Layer2> 
-    model;
-
-  float myAudioCallback(float inputSample) {
-    return model.forward(inputSample);
-  }
+const float DumbleModel_weights[] = {
+    -0.220577821f, 0.40208745f, -0.478968561f, -1.14535534f, 0.444149941f, 0.285035074f,
+    0.698295355f, -0.1650673f, -0.397882521f, -0.795970798f, 0.288315356f, 0.403159529f,
+    0.41591686f, -0.538956106f, -0.221147299f, -0.0211727507f, -0.0902722403f, 0.341295987f,
+    -0.780601025f, -0.295190811f, 0.303170592f, 0.403609276f, 0.0369745307f, 0.542894423f,
+    1.2139852f, 0.0776594505f, 0.489549696f, -0.826833129f, 0.0269177239f, 0.112584606f,
+    0.0467521399f, 0.482652873f, -0.504933059f, -0.157984361f, -0.38861382f, -0.210418433f,
+    -0.0114968354f, 0.354110807f, 0.709156156f, 0.607221544f, -0.575569272f, -0.0840029344f,
+    0.0647845268f, -0.888159513f, -0.336282223f, -0.340587795f, -0.106046952f, -0.603790879f,
+    0.666522801f, -0.100385845f, 0.734937191f, -0.457743078f, 0.844137311f, -0.36849153f,
+    -0.120231554f, -0.898348868f, -0.300506473f, 0.375134975f, -0.0403827801f, 0.19255887f,
+    0.450360209f, 0.340068221f, -0.795248866f, 1.16008508f, 0.432886511f, 0.352907747f,
+    0.14510271f, 0.172389895f, 1.09588897f, 0.254507065f, 0.288415968f, 0.331188411f,
+    -0.100250773f, -0.0386510603f, 0.0510295257f, 0.392302901f, -0.34771657f, -1.15396988f,
+    0.254962653f, 0.36062637f, -0.136888951f, 0.173724622f, 0.358896077f, -0.657791197f,
+    -0.392655939f, -0.426358849f, -0.282368183f, -1.11837494f, 0.29759863f, -0.430480212f,
+    -0.279717445f, 0.743440032f, -0.00467595691f, 0.562876761f, -0.234058142f, 0.119431973f,
+    -0.370116979f, -0.0830839351f, 0.137869075f, 0.221078292f, -0.23150526f, -0.0976912454f,
+    -0.100979991f, 0.0653501824f, -0.384098828f, 0.00700927293f, -0.582160771f, -0.878751874f,
+    -0.252253175f, 0.407634705f, -0.198089913f, 0.320935994f, 0.172993019f, 0.0646875799f,
+    -0.245446712f, -0.117911644f, 0.23021014f, 1.26403236f, 0.867196023f, -0.228683218f,
+    0.575865805f, -0.707569778f, 0.196997151f, 0.985177219f, -0.191737816f, -0.372365534f,
+    -1.30703592f, -0.624091685f, 0.171559587f, -0.912065446f, -0.078892678f, 0.622495413f,
+    -0.289651334f, -0.158875361f, -0.247271359f, -0.310882151f, -0.0691504106f, -0.0698748156f,
+    0.081335403f, 0.37749204f, 0.450496674f, 0.231007397f, 0.574584842f, 0.328155249f,
+    -0.138493136f, 0.255243689f, -0.0112145329f, 0.203238621f, -0.6832968f, -0.369488657f,
+    -1.1285007f, -0.165712565f, -0.0540644638f, 0.571207643f, 0.206599101f, -0.537126303f,
+    1.70460451f, -0.48746112f, 1.14243054f, -0.209023893f, -0.387314916f, 0.192156866f,
+    -0.535851777f, -0.607287467f, -0.0302905738f, -0.448238045f, -0.177740633f, 0.029912265f,
+    -0.442937195f, 0.119739264f, 0.332212985f, -0.00381266209f, 0.371528387f, -0.016400665f,
+    -0.353920132f, 0.397209704f, -0.0275584571f, -0.0663222298f, 0.935040474f, -0.210763186f,
+    0.327960372f, -0.298717916f, 0.84304601f, 0.148054197f, 0.441708684f, 0.145321026f,
+    -0.155286789f, -0.159036323f, -0.174205452f, -0.0542470925f, 0.00297630951f, 0.131671056f,
+    -0.108649671f, -0.192234918f, -0.357761383f, -0.0654729903f, 0.107924514f, 0.274867415f,
+    -0.250123799f, -0.0662346333f, -0.0700942278f, 0.827570856f, -0.534899831f, -0.285620779f,
+    -0.257288396f, 0.447711557f, -0.105517142f, 0.464827687f, -0.0388065055f, 0.121004701f,
+    0.164707795f, 0.0167023167f, 0.0338895544f, 0.0778262913f, -0.0345996991f, -0.0520853437f,
+    -0.329092294f, 0.0302480217f, -0.0928651243f, 0.0389670543f, -0.0703591853f, 0.463345855f,
+    0.243075192f, -0.542530954f, -0.40775907f, 0.349790573f, -0.325135261f, -0.0306885447f,
+    -0.0951783732f, -0.208033517f, -0.443693608f, -0.0849420652f, 0.0418455899f, 0.545424283f,
+    0.538824856f, -0.128853932f, -0.137562081f, -0.541117907f, 0.258754224f, 0.243926018f,
+    -0.154071078f, -0.0703565404f, -0.172003195f, -0.02678838f, 0.74362272f, -0.294177055f,
+    -0.192720503f, -0.789933443f, 0.282205045f, -0.335698575f, -0.163789332f, 0.031502001f,
+    0.548889995f, 0.00263164425f, -0.370983213f, -0.0914013013f, -0.303998113f, 0.160405278f,
+    0.87604773f, -0.21659106f, -0.435970128f, 0.197928861f, -0.100122839f, 0.166623726f,
+    0.142906919f, -0.21659857f, -0.304645747f, 0.900859475f, 0.585373521f, -0.110444516f,
+    -1.44944286f, -0.644900739f, -0.515813768f, 0.142285794f, -0.679468393f, -0.622053862f,
+    0.0742276534f, -0.293496221f, 0.279613405f, 0.292392254f, -1.19412172f, -0.485279679f,
+    -0.725345254f, -0.310112059f, 0.044987224f, 0.182650283f, -0.216848463f, -0.240714207f,
+    -0.505359709f, -0.0241949148f, -1.40850461f, -0.607329667f, 0.446214795f, -0.122760579f,
+    -0.0285152737f, -0.367257476f, 0.116800919f, 0.541291654f, -0.116035126f, 0.954184592f,
+    -0.542111337f, 0.0445172302f, 0.056349948f, 0.244405895f, 0.052973263f, 0.270341069f,
+    -0.418320835f, 0.228960633f, -0.0207664818f, 0.0428022444f, 0.0878669545f, 0.0396083966f,
+    0.561614513f, -1.13052487f, -0.00142226857f, 0.379067332f, -0.388667643f, 0.134438708f,
+    -0.0894100741f, -0.172841743f, -0.141524404f, 0.108349644f, 0.368180126f, -0.234711036f,
+    0.0713855326f, 0.335271806f, -0.139205679f, 0.321465075f, 0.821034729f, -0.443996876f,
+    -0.401372135f, -0.25689593f, 0.416681617f, -0.276451409f, -1.47036004f, -0.612889469f,
+    0.114388548f, 1.58625364f, 0.685114384f, 0.498430282f, -0.0532715246f, -0.28256771f,
+    0.0989067182f, -0.117319927f, -0.477201492f, 0.662156701f, 0.330338299f, -0.53749311f,
+    -0.69149065f, -0.00569867063f, -0.107418373f, 0.328597456f, -0.0886957049f, 0.0334878825f,
+    0.179562196f, -1.65647519f, 0.506613493f, 0.552044332f, -1.50610352f, -0.150729254f,
+    -0.466395795f, -0.723160386f, -0.336093366f, 0.374682039f, -0.0425585695f, -0.680657327f,
+    0.311721951f, 0.0127347866f, -0.263097793f, -0.111675195f, -0.0788539276f, -0.645974934f,
+    -0.426962048f, 0.372695625f, -0.0607016496f, -0.17925334f, 0.107884564f, 0.74889487f,
+    0.161851346f, 0.218101114f, 0.307147771f, -0.751819015f, 0.273369104f, 0.755034685f,
+    0.205312118f, -0.0320835412f, 0.20179975f, 0.517087519f, -0.623434365f, 0.261189938f,
+    0.0201344546f, 0.15216817f, -0.0475664996f, 0.275983602f, -0.415351868f, 0.193571076f,
+    0.175333604f, -0.163325965f, -0.573157847f, 0.507516742f, 0.132611617f, 0.186522514f,
+    -0.267622977f, 0.444293201f, 0.120523386f, -0.466970295f, 0.0347884446f, 0.106008843f,
+    -0.263101757f, -0.0157587547f, 0.16800037f, 0.343132108f, -0.0450559072f, 0.01910346f,
+    -0.694544852f, 0.00167643349f, 0.0577654019f, 1.13120008f, -0.0210492071f, 0.603599906f,
+    -0.299187511f, -0.347361594f, -0.0790804327f, 0.220313981f, 0.42915988f, -0.523365259f,
+    -0.168864414f, -0.413919002f, 0.0319665261f, 0.00211169082f, -0.533146799f, 0.126737863f,
+    0.0487299375f, 0.547576725f, -0.0604160056f, -0.0728260875f, -0.421836495f, -0.121513285f,
+    -0.163332433f, 0.422298074f, -0.325479269f, -0.305082679f, -0.480696529f, 0.515855432f,
+    -0.669261694f, 0.587738037f, -0.282858878f, 0.207100332f, 0.0322461314f, -0.637611687f,
+    2.20417762f, 1.82646823f, 0.60376817f, 0.0199999996f
 };
 
-*/
+const unsigned int DumbleModel_weights_len = 454;
 
-#pragma once
-#include <vector>
-#include "rt-nam.hpp"
+const signed char DumbleModel_residual_bits[] = { 15, 13, 13, 13, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 11, 11, 12, 12, 12, 12, 12 };
+const unsigned int DumbleModel_residual_bits_len = 22;
 
-using Layer1 = 
-wavenet::Layer_Array<float, 
-                     1, // input_size
-                     1, // condition_size
-                     2, // head_size
-                     2, // channels
-                     3, // kernel_size
-                     wavenet::Dilations<1, 2, 4, 8, 16, 32, 64>, // dilations
-                     false, // head_bias
-                     wavenet::NAMMathsProvider>; // maths provider
-
-using Layer2 = 
-wavenet::Layer_Array<float, 
-                     2, // input_size
-                     1, // condition_size
-                     1, // head_size
-                     2, // channels
-                     3, // kernel_size
-                     wavenet::Dilations<128, 256, 512, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512>, // dilations
-                     true, // head_bias
-                     wavenet::NAMMathsProvider>; // maths provider
-
-struct DumbleModelWeights {
-  std::vector<float> weights = { -0.22057782113552094, 0.4020874500274658, -0.4789685606956482, -1.1453553438186646, 0.4441499412059784, 0.28503507375717163, 0.6982953548431396, -0.16506730020046234, -0.39788252115249634, -0.7959707975387573, 0.2883153557777405, 0.4031595289707184, 0.4159168601036072, -0.5389561057090759, -0.2211472988128662, -0.021172750741243362, -0.09027224034070969, 0.34129598736763, -0.7806010246276855, -0.29519081115722656, 0.3031705915927887, 0.4036092758178711, 0.036974530667066574, 0.5428944230079651, 1.2139852046966553, 0.07765945047140121, 0.4895496964454651, -0.8268331289291382, 0.026917723938822746, 0.11258460581302643, 0.046752139925956726, 0.482652872800827, -0.5049330592155457, -0.15798436105251312, -0.38861382007598877, -0.2104184329509735, -0.011496835388243198, 0.35411080718040466, 0.7091561555862427, 0.6072215437889099, -0.5755692720413208, -0.08400293439626694, 0.06478452682495117, -0.8881595134735107, -0.33628222346305847, -0.3405877947807312, -0.10604695230722427, -0.6037908792495728, 0.6665228009223938, -0.10038584470748901, 0.7349371910095215, -0.4577430784702301, 0.8441373109817505, -0.368491530418396, -0.12023155391216278, -0.898348867893219, -0.30050647258758545, 0.37513497471809387, -0.04038278013467789, 0.1925588697195053, 0.4503602087497711, 0.3400682210922241, -0.7952488660812378, 1.1600850820541382, 0.4328865110874176, 0.3529077470302582, 0.14510270953178406, 0.1723898947238922, 1.0958889722824097, 0.25450706481933594, 0.28841596841812134, 0.3311884105205536, -0.10025077313184738, -0.038651060312986374, 0.05102952569723129, 0.39230290055274963, -0.3477165699005127, -1.1539698839187622, 0.25496265292167664, 0.36062636971473694, -0.13688895106315613, 0.17372462153434753, 0.35889607667922974, -0.6577911972999573, -0.3926559388637543, -0.4263588488101959, -0.28236818313598633, -1.1183749437332153, 0.29759863018989563, -0.4304802119731903, -0.27971744537353516, 0.7434400320053101, -0.004675956908613443, 0.5628767609596252, -0.23405814170837402, 0.11943197250366211, -0.3701169788837433, -0.08308393508195877, 0.13786907494068146, 0.2210782915353775, -0.23150525987148285, -0.09769124537706375, -0.1009799912571907, 0.06535018235445023, -0.3840988278388977, 0.007009272929280996, -0.5821607708930969, -0.8787518739700317, -0.2522531747817993, 0.4076347053050995, -0.19808991253376007, 0.320935994386673, 0.1729930192232132, 0.064687579870224, -0.24544671177864075, -0.11791164427995682, 0.23021014034748077, 1.2640323638916016, 0.8671960234642029, -0.2286832183599472, 0.5758658051490784, -0.7075697779655457, 0.19699715077877045, 0.985177218914032, -0.1917378157377243, -0.3723655343055725, -1.3070359230041504, -0.6240916848182678, 0.17155958712100983, -0.9120654463768005, -0.07889267802238464, 0.6224954128265381, -0.2896513342857361, -0.15887536108493805, -0.2472713589668274, -0.3108821511268616, -0.069150410592556, -0.06987481564283371, 0.0813354030251503, 0.3774920403957367, 0.4504966735839844, 0.2310073971748352, 0.5745848417282104, 0.3281552493572235, -0.1384931355714798, 0.2552436888217926, -0.011214532889425755, 0.2032386213541031, -0.683296799659729, -0.3694886565208435, -1.1285006999969482, -0.16571256518363953, -0.05406446382403374, 0.5712076425552368, 0.20659910142421722, -0.5371263027191162, 1.7046045064926147, -0.487461119890213, 1.1424305438995361, -0.20902389287948608, -0.38731491565704346, 0.1921568661928177, -0.535851776599884, -0.6072874665260315, -0.030290573835372925, -0.4482380449771881, -0.17774063348770142, 0.02991226501762867, -0.4429371953010559, 0.11973926424980164, 0.33221298456192017, -0.0038126620929688215, 0.37152838706970215, -0.016400665044784546, -0.3539201319217682, 0.39720970392227173, -0.027558457106351852, -0.06632222980260849, 0.9350404739379883, -0.21076318621635437, 0.32796037197113037, -0.2987179160118103, 0.8430460095405579, 0.14805419743061066, 0.44170868396759033, 0.14532102644443512, -0.1552867889404297, -0.159036323428154, -0.1742054522037506, -0.054247092455625534, 0.002976309508085251, 0.13167105615139008, -0.10864967107772827, -0.19223491847515106, -0.3577613830566406, -0.06547299027442932, 0.10792451351881027, 0.2748674154281616, -0.2501237988471985, -0.06623463332653046, -0.07009422779083252, 0.8275708556175232, -0.5348998308181763, -0.285620778799057, -0.25728839635849, 0.4477115571498871, -0.10551714152097702, 0.46482768654823303, -0.038806505501270294, 0.12100470066070557, 0.16470779478549957, 0.0167023167014122, 0.03388955444097519, 0.07782629132270813, -0.03459969907999039, -0.05208534374833107, -0.3290922939777374, 0.030248021706938744, -0.09286512434482574, 0.03896705433726311, -0.07035918533802032, 0.46334585547447205, 0.2430751919746399, -0.5425309538841248, -0.40775907039642334, 0.3497905731201172, -0.3251352608203888, -0.030688544735312462, -0.09517837315797806, -0.2080335170030594, -0.443693608045578, -0.08494206517934799, 0.04184558987617493, 0.5454242825508118, 0.5388248562812805, -0.1288539320230484, -0.1375620812177658, -0.5411179065704346, 0.2587542235851288, 0.2439260184764862, -0.15407107770442963, -0.07035654038190842, -0.17200319468975067, -0.026788379997015, 0.7436227202415466, -0.2941770553588867, -0.19272050261497498, -0.789933443069458, 0.2822050452232361, -0.33569857478141785, -0.16378933191299438, 0.031502000987529755, 0.5488899946212769, 0.0026316442526876926, -0.37098321318626404, -0.09140130132436752, -0.30399811267852783, 0.16040527820587158, 0.8760477304458618, -0.21659106016159058, -0.43597012758255005, 0.19792886078357697, -0.1001228392124176, 0.16662372648715973, 0.14290691912174225, -0.21659857034683228, -0.30464574694633484, 0.9008594751358032, 0.5853735208511353, -0.11044451594352722, -1.4494428634643555, -0.6449007391929626, -0.5158137679100037, 0.1422857940196991, -0.6794683933258057, -0.622053861618042, 0.07422765344381332, -0.2934962213039398, 0.2796134054660797, 0.2923922538757324, -1.1941217184066772, -0.4852796792984009, -0.725345253944397, -0.3101120591163635, 0.04498722404241562, 0.18265028297901154, -0.2168484628200531, -0.2407142072916031, -0.5053597092628479, -0.02419491484761238, -1.408504605293274, -0.6073296666145325, 0.44621479511260986, -0.1227605789899826, -0.028515273705124855, -0.3672574758529663, 0.11680091917514801, 0.5412916541099548, -0.11603512614965439, 0.9541845917701721, -0.542111337184906, 0.04451723024249077, 0.056349948048591614, 0.24440589547157288, 0.05297326296567917, 0.27034106850624084, -0.41832083463668823, 0.22896063327789307, -0.020766481757164, 0.042802244424819946, 0.08786695450544357, 0.03960839658975601, 0.5616145133972168, -1.1305248737335205, -0.001422268571332097, 0.3790673315525055, -0.38866764307022095, 0.13443870842456818, -0.08941007405519485, -0.17284174263477325, -0.14152440428733826, 0.10834964364767075, 0.36818012595176697, -0.23471103608608246, 0.07138553261756897, 0.33527180552482605, -0.1392056792974472, 0.32146507501602173, 0.8210347294807434, -0.4439968764781952, -0.40137213468551636, -0.25689592957496643, 0.4166816174983978, -0.2764514088630676, -1.4703600406646729, -0.6128894686698914, 0.11438854783773422, 1.5862536430358887, 0.6851143836975098, 0.4984302818775177, -0.05327152460813522, -0.28256770968437195, 0.09890671819448471, -0.11731992661952972, -0.4772014915943146, 0.6621567010879517, 0.3303382992744446, -0.537493109703064, -0.691490650177002, -0.005698670633137226, -0.10741837322711945, 0.32859745621681213, -0.0886957049369812, 0.03348788246512413, 0.17956219613552094, -1.6564751863479614, 0.5066134929656982, 0.5520443320274353, -1.506103515625, -0.1507292538881302, -0.4663957953453064, -0.7231603860855103, -0.33609336614608765, 0.3746820390224457, -0.042558569461107254, -0.6806573271751404, 0.31172195076942444, 0.012734786607325077, -0.2630977928638458, -0.1116751953959465, -0.07885392755270004, -0.6459749341011047, -0.4269620478153229, 0.3726956248283386, -0.0607016496360302, -0.17925333976745605, 0.10788456350564957, 0.7488948702812195, 0.16185134649276733, 0.2181011140346527, 0.3071477711200714, -0.7518190145492554, 0.27336910367012024, 0.7550346851348877, 0.205312117934227, -0.03208354115486145, 0.20179975032806396, 0.5170875191688538, -0.6234343647956848, 0.26118993759155273, 0.0201344545930624, 0.1521681696176529, -0.047566499561071396, 0.275983601808548, -0.41535186767578125, 0.193571075797081, 0.17533360421657562, -0.1633259654045105, -0.5731578469276428, 0.5075167417526245, 0.13261161744594574, 0.18652251362800598, -0.2676229774951935, 0.44429320096969604, 0.12052338570356369, -0.466970294713974, 0.03478844463825226, 0.10600884258747101, -0.2631017565727234, -0.015758754685521126, 0.16800037026405334, 0.3431321084499359, -0.04505590721964836, 0.019103460013866425, -0.6945448517799377, 0.0016764334868639708, 0.057765401899814606, 1.1312000751495361, -0.02104920707643032, 0.6035999059677124, -0.2991875112056732, -0.34736159443855286, -0.07908043265342712, 0.22031398117542267, 0.42915987968444824, -0.5233652591705322, -0.1688644140958786, -0.41391900181770325, 0.03196652606129646, 0.002111690817400813, -0.5331467986106873, 0.12673786282539368, 0.04872993752360344, 0.5475767254829407, -0.06041600555181503, -0.072826087474823, -0.4218364953994751, -0.12151328474283218, -0.16333243250846863, 0.4222980737686157, -0.32547926902770996, -0.30508267879486084, -0.48069652915000916, 0.5158554315567017, -0.6692616939544678, 0.587738037109375, -0.28285887837409973, 0.20710033178329468, 0.03224613144993782, -0.6376116871833801, 2.2041776180267334, 1.8264682292938232, 0.6037681698799133, 0.019999999552965164 };
-};
+#endif // DUMBLEMODEL_H
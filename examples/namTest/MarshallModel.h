@@ -1,53 +1,95 @@
-/*
+// Converted from MarshallModel.nam by namToArray.py
+// Architecture: WaveNet
+// Layer array 1: {"input_size": 1, "condition_size": 1, "head_size": 2, "channels": 2, "kernel_size": 3, "dilations": [1, 2, 4, 8, 16, 32, 64], "activation": "Tanh", "gated": false, "head_bias": false}
+// Layer array 2: {"input_size": 2, "condition_size": 1, "head_size": 1, "channels": 2, "kernel_size": 3, "dilations": [128, 256, 512, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512], "activation": "Tanh", "gated": false, "head_bias": true}
+// Head scale: 0.02
+// Sample rate: 48000 Hz
 
-Generated by RTNeural/modules/rt-nam/nam_to_header.py
+#ifndef MARSHALLMODEL_H
+#define MARSHALLMODEL_H
 
-Usage:
-
-#include "model.h"
-
-class MyAudioApp {
-  MarshallModelWeights weights;
-  unsigned int ioChannels = 1, samplesPerBuffer = 1;
-  wavenet::RTWavenet<ioChannels, 
-                     samplesPerBuffer, 
-                     Layer1, 
-                     Layer2> 
-    model;
-
-  float myAudioCallback(float inputSample) {
-    return model.forward(inputSample);
-  }
+const float MarshallModel_weights[] = {
+    -0.454089999f, 0.822635472f, -0.710729301f, -1.00375021f, 0.257542938f, 0.430869311f,
+    0.586037397f, -0.052646663f, -0.361833006f, -0.722235739f, -0.274021298f, 0.169152662f,
+    0.291885763f, -0.138794839f, -0.0256373547f, 0.0172321685f, 0.100623108f, 0.75528419f,
+    -0.898675144f, -0.683031023f, 0.616934299f, 1.08142149f, 0.124061421f, 0.508258343f,
+    0.259305894f, 1.31079829f, 1.73621178f, -0.194654256f, -0.680163503f, -0.356049746f,
+    -0.655586898f, 0.705810666f, -0.0686976835f, 0.314901531f, -0.524395525f, -0.406204283f,
+    0.141916096f, 0.36168772f, 0.264111727f, 1.13144493f, 0.164325327f, 1.1279428f,
+    0.209179416f, -0.211289197f, -0.335597008f, -0.340385437f, 0.403743476f, -0.310913831f,
+    -0.488291025f, -0.985796392f, 0.223222926f, 0.414649308f, 0.436633468f, 0.104884274f,
+    0.156201288f, -0.376618505f, 0.123746961f, 0.229862526f, 0.0776170492f, 0.137738794f,
+    -0.822992265f, 0.770239592f, -0.497729778f, 0.306523561f, -0.393290997f, -0.504177213f,
+    -0.0178420693f, 0.121635385f, 0.742917538f, 0.922438204f, -1.1246438f, -0.853840113f,
+    -0.209257081f, 1.14691091f, -0.101469316f, 0.732308209f, -0.361470759f, -0.212267548f,
+    -0.323724061f, 0.137383863f, 0.0686196014f, 0.188992038f, 0.407630831f, -0.919237792f,
+    -1.78007579f, -0.70878911f, 0.783298254f, 0.433515817f, 0.381956995f, -0.488756627f,
+    0.594578981f, 1.57611847f, 0.077963613f, 1.0210278f, -0.300626516f, 0.11417792f,
+    -0.278059006f, -0.426187694f, -2.16702294f, -1.2753638f, -0.315707088f, 0.451920956f,
+    -0.148682103f, 0.15725258f, 0.117279612f, -0.275093377f, -0.871893704f, -1.46935046f,
+    -1.32002413f, 1.39229989f, -0.100207247f, 0.375950307f, 0.0161564518f, 0.0885536969f,
+    -1.06316793f, -0.357041627f, -0.720720232f, 0.282472461f, 0.0771558657f, -0.264585435f,
+    -0.797680497f, 0.109756991f, -0.501787186f, 0.240550712f, 0.0418568105f, 0.206151158f,
+    1.09759951f, -0.0580301806f, -0.276918381f, -1.07208872f, -0.611788571f, -0.0669392049f,
+    -0.296380967f, 0.123356909f, 0.0399631411f, 0.378679842f, -0.0741653144f, 0.393612623f,
+    -0.0812106729f, -0.338912755f, 0.0122262286f, -0.0829336345f, -2.16987896f, 0.000534191844f,
+    -1.06461287f, -0.345998764f, 0.0902424678f, -0.234863833f, 0.0131699909f, 0.705983579f,
+    -0.416312784f, -2.32646847f, -0.381043494f, 0.304949343f, 0.478014767f, -0.499933541f,
+    0.272302449f, -0.102233499f, -0.325095415f, 0.204511315f, -0.085005559f, -0.0606411584f,
+    -0.105877846f, -0.28725493f, -0.259441674f, -0.0803853795f, -0.0695409775f, -0.25820455f,
+    0.303986698f, -0.147852615f, 0.665691376f, 0.131980196f, 0.0618441738f, 0.306448162f,
+    -0.41239816f, -0.0930990875f, -0.00653613079f, 0.00720879203f, 0.611991763f, -0.268804073f,
+    -0.155904129f, -0.182230771f, 0.485351801f, 0.185786903f, 0.324381918f, 0.113269635f,
+    0.0196811184f, -0.244343892f, -0.00589320809f, 0.0791653097f, 0.128866449f, 0.231782496f,
+    0.031565357f, -0.133165956f, 0.287207842f, -0.0313172378f, -0.236698061f, 0.0249022022f,
+    -0.125054553f, 0.0765761808f, 0.121157929f, 0.5835464f, -0.343954891f, -0.0483386293f,
+    -0.169978067f, -0.141777724f, -0.211113185f, 0.294782192f, -0.0302188527f, -0.0401513539f,
+    0.633449674f, 0.0313506424f, -0.0248826798f, -0.0945011973f, -0.08455275f, -0.0808579847f,
+    0.122944996f, 0.0342026539f, 0.00298620248f, -0.734874427f, -0.0607281402f, 0.348539382f,
+    -0.634429038f, -0.529144406f, -0.573973775f, 0.254875571f, -0.395333171f, 0.162947997f,
+    -0.170879811f, -0.369692743f, -0.0275663529f, 0.0952039808f, -0.361237049f, 0.0565842204f,
+    0.0445670485f, -0.826102853f, -2.70932126f, -1.56637633f, -1.49612415f, 0.192802876f,
+    0.166176125f, 0.178764001f, 0.0369805545f, -0.0891241506f, -0.254901171f, -0.545729995f,
+    0.543964565f, -0.146009713f, 0.725358725f, -0.361579478f, -0.191618666f, -0.0800270364f,
+    0.308425874f, 0.30814445f, -0.451400191f, 0.81628269f, 0.119996481f, 0.703722894f,
+    -0.705838859f, 0.28039518f, -0.195744202f, -0.64657402f, 0.537722528f, -0.160493582f,
+    0.0268902779f, -0.152648032f, -0.0945926905f, 0.407265276f, 0.906119287f, 0.531134248f,
+    -0.094293274f, 0.310917735f, -0.368359804f, 0.2137319f, -0.848932564f, -0.785585225f,
+    0.579274237f, -0.150544539f, -0.17168574f, -0.766439915f, 0.631038249f, -0.124915607f,
+    -0.555164456f, -0.0617215149f, 0.377164841f, 0.469554901f, -0.390425891f, -0.171012774f,
+    0.167106852f, -0.0571249239f, -0.30401063f, 1.37296975f, 0.871766329f, -0.424397677f,
+    0.0151907243f, -0.279695779f, 0.821259916f, -0.939830899f, 0.378354818f, -0.615128219f,
+    -0.600759685f, -0.377659649f, 0.401887655f, -0.146882728f, 0.00947221369f, 0.178933829f,
+    0.403686881f, -0.442873031f, 0.0306512266f, 0.132176876f, -0.191902727f, 0.0303348191f,
+    0.76981169f, -0.65945369f, 0.623690069f, 1.68866932f, -0.191593379f, -0.201991424f,
+    -0.083021611f, -0.0980930105f, 0.313821912f, 0.0875590816f, -0.0251228381f, -0.263622582f,
+    -0.0351297632f, -0.544412673f, 0.0579575524f, 0.0276133232f, 0.661655664f, 0.13654162f,
+    0.0363546275f, -0.115088761f, -0.104348041f, 0.189361066f, -1.72457075f, 0.556398153f,
+    0.405717671f, 1.88798726f, 0.658717632f, 0.452441156f, 0.112298675f, -0.304290056f,
+    0.44083342f, -0.0655910075f, 0.0319200195f, -0.165940076f, 0.24196431f, 0.0403374769f,
+    -0.0748477578f, -0.139860496f, -0.14861545f, 0.286350071f, 0.0284131058f, -0.0094386097f,
+    0.00621537538f, -0.0548637211f, -1.01776445f, 1.88868737f, 0.299821824f, 0.0208722036f,
+    -0.500130177f, -0.695518851f, -0.42575711f, 0.0847269893f, -0.0583531596f, 0.524756312f,
+    0.0115459803f, 0.332996666f, 0.0426967293f, 0.410916299f, -0.261998266f, 0.0427741259f,
+    -0.313292921f, -0.0387807563f, 0.244007662f, -0.0632956102f, 0.0958619416f, 0.110062934f,
+    -1.07931376f, 1.51835561f, -0.0782032534f, 0.140422001f, 0.303910673f, 0.453557551f,
+    0.519674182f, -0.72802794f, 0.425194979f, 0.484172046f, -0.301762462f, 1.11482954f,
+    0.363283426f, -0.803073525f, 0.106254518f, -0.15866442f, 0.205405757f, 0.166588292f,
+    0.210562453f, -0.0695441514f, -0.986336768f, -0.0408426113f, -0.163509578f, 1.66098142f,
+    -0.280503243f, 1.08527064f, 0.325584263f, -0.396409452f, -0.452324748f, 0.0871706307f,
+    -0.0580866076f, 0.243930131f, -0.254135698f, 0.681477427f, 0.151522309f, 0.936560988f,
+    0.191986561f, 0.0910574347f, -0.255402625f, 0.327266902f, 0.398570955f, 0.0256033577f,
+    0.3870655f, -0.323364824f, -0.392730415f, 0.0740598664f, -1.37374413f, -1.74285877f,
+    -0.343512505f, -1.1399045f, 0.12988168f, -0.213832602f, 0.210723385f, 0.0909565538f,
+    -0.167292371f, -0.090141125f, 0.276224136f, -0.350796431f, 0.239521608f, 0.0317633599f,
+    0.209166914f, -0.355867296f, -0.571451664f, -0.130753025f, 0.072542794f, -0.0304894913f,
+    -0.669261694f, 0.587738037f, -0.282858878f, 0.207100332f, 0.0322461314f, -0.637611687f,
+    2.25896454f, 2.68856168f, 0.761280537f, 0.0199999996f
 };
 
-*/
+const unsigned int MarshallModel_weights_len = 454;
 
-#pragma once
-#include <vector>
-#include "rt-nam.hpp"
+const signed char MarshallModel_residual_bits[] = { 14, 12, 12, 12, 11, 10, 10, 10, 13, 13, 13, 13, 14, 13, 13, 12, 13, 12, 12, 12, 11, 11 };
+const unsigned int MarshallModel_residual_bits_len = 22;
 
-using Layer1 = 
-wavenet::Layer_Array<float, 
-                     1, // input_size
-                     1, // condition_size
-                     2, // head_size
-                     2, // channels
-                     3, // kernel_size
-                     wavenet::Dilations<1, 2, 4, 8, 16, 32, 64>, // dilations
-                     false, // head_bias
-                     wavenet::NAMMathsProvider>; // maths provider
-
-using Layer2 = 
-wavenet::Layer_Array<float, 
-                     2, // input_size
-                     1, // condition_size
-                     1, // head_size
-                     2, // channels
-                     3, // kernel_size
-                     wavenet::Dilations<128, 256, 512, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512>, // dilations
-                     true, // head_bias
-                     wavenet::NAMMathsProvider>; // maths provider
-
-struct MarshallModelWeights {
-  std::vector<float> weights = { -0.4540899991989136, 0.8226354718208313, -0.7107293009757996, -1.003750205039978, 0.2575429379940033, 0.43086931109428406, 0.5860373973846436, -0.052646663039922714, -0.36183300614356995, -0.7222357392311096, -0.27402129769325256, 0.1691526621580124, 0.29188576340675354, -0.13879483938217163, -0.02563735470175743, 0.017232168465852737, 0.10062310844659805, 0.7552841901779175, -0.8986751437187195, -0.6830310225486755, 0.6169342994689941, 1.0814214944839478, 0.12406142055988312, 0.5082583427429199, 0.2593058943748474, 1.3107982873916626, 1.7362117767333984, -0.19465425610542297, -0.6801635026931763, -0.3560497462749481, -0.6555868983268738, 0.7058106660842896, -0.06869768351316452, 0.31490153074264526, -0.5243955254554749, -0.4062042832374573, 0.14191609621047974, 0.36168771982192993, 0.26411172747612, 1.1314449310302734, 0.16432532668113708, 1.1279428005218506, 0.20917941629886627, -0.2112891972064972, -0.3355970084667206, -0.34038543701171875, 0.4037434756755829, -0.3109138309955597, -0.48829102516174316, -0.9857963919639587, 0.22322292625904083, 0.4146493077278137, 0.43663346767425537, 0.10488427430391312, 0.1562012881040573, -0.37661850452423096, 0.12374696135520935, 0.2298625260591507, 0.07761704921722412, 0.13773879408836365, -0.8229922652244568, 0.7702395915985107, -0.4977297782897949, 0.30652356147766113, -0.39329099655151367, -0.5041772127151489, -0.017842069268226624, 0.12163538485765457, 0.742917537689209, 0.9224382042884827, -1.1246438026428223, -0.8538401126861572, -0.2092570811510086, 1.1469109058380127, -0.10146931558847427, 0.7323082089424133, -0.3614707589149475, -0.21226754784584045, -0.32372406125068665, 0.1373838633298874, 0.06861960142850876, 0.18899203836917877, 0.4076308310031891, -0.9192377924919128, -1.7800757884979248, -0.7087891101837158, 0.7832982540130615, 0.4335158169269562, 0.3819569945335388, -0.48875662684440613, 0.5945789813995361, 1.5761184692382812, 0.07796361297369003, 1.0210278034210205, -0.3006265163421631, 0.11417791992425919, -0.2780590057373047, -0.4261876940727234, -2.167022943496704, -1.275363802909851, -0.31570708751678467, 0.4519209563732147, -0.148682102560997, 0.15725257992744446, 0.11727961152791977, -0.2750933766365051, -0.8718937039375305, -1.4693504571914673, -1.3200241327285767, 1.3922998905181885, -0.10020724684000015, 0.37595030665397644, 0.016156451776623726, 0.08855369687080383, -1.063167929649353, -0.3570416271686554, -0.7207202315330505, 0.2824724614620209, 0.07715586572885513, -0.2645854353904724, -0.7976804971694946, 0.10975699126720428, -0.5017871856689453, 0.2405507117509842, 0.041856810450553894, 0.20615115761756897, 1.0975995063781738, -0.058030180633068085, -0.2769183814525604, -1.0720887184143066, -0.6117885708808899, -0.06693920493125916, -0.2963809669017792, 0.1233569085597992, 0.039963141083717346, 0.3786798417568207, -0.07416531443595886, 0.3936126232147217, -0.0812106728553772, -0.3389127552509308, 0.012226228602230549, -0.08293363451957703, -2.1698789596557617, 0.0005341918440535665, -1.064612865447998, -0.34599876403808594, 0.09024246782064438, -0.23486383259296417, 0.013169990852475166, 0.705983579158783, -0.4163127839565277, -2.3264684677124023, -0.3810434937477112, 0.3049493432044983, 0.4780147671699524, -0.49993354082107544, 0.27230244874954224, -0.10223349928855896, -0.32509541511535645, 0.20451131463050842, -0.08500555902719498, -0.06064115837216377, -0.1058778464794159, -0.2872549295425415, -0.25944167375564575, -0.08038537949323654, -0.06954097747802734, -0.25820454955101013, 0.30398669838905334, -0.14785261452198029, 0.6656913757324219, 0.13198019564151764, 0.061844173818826675, 0.30644816160202026, -0.41239815950393677, -0.09309908747673035, -0.006536130793392658, 0.0072087920270860195, 0.6119917631149292, -0.26880407333374023, -0.1559041291475296, -0.18223077058792114, 0.4853518009185791, 0.1857869029045105, 0.32438191771507263, 0.1132696345448494, 0.019681118428707123, -0.24434389173984528, -0.005893208086490631, 0.07916530966758728, 0.12886644899845123, 0.23178249597549438, 0.031565356999635696, -0.13316595554351807, 0.28720784187316895, -0.03131723776459694, -0.23669806122779846, 0.02490220218896866, -0.12505455315113068, 0.07657618075609207, 0.1211579293012619, 0.5835464000701904, -0.3439548909664154, -0.0483386293053627, -0.169978067278862, -0.14177772402763367, -0.21111318469047546, 0.29478219151496887, -0.030218852683901787, -0.04015135392546654, 0.6334496736526489, 0.03135064244270325, -0.02488267980515957, -0.09450119733810425, -0.08455274999141693, -0.08085798472166061, 0.12294499576091766, 0.03420265391469002, 0.0029862024821341038, -0.734874427318573, -0.06072814017534256, 0.3485393822193146, -0.6344290375709534, -0.5291444063186646, -0.5739737749099731, 0.2548755705356598, -0.3953331708908081, 0.16294799745082855, -0.1708798110485077, -0.36969274282455444, -0.027566352859139442, 0.09520398080348969, -0.3612370491027832, 0.05658422037959099, 0.0445670485496521, -0.8261028528213501, -2.7093212604522705, -1.5663763284683228, -1.4961241483688354, 0.19280287623405457, 0.16617612540721893, 0.1787640005350113, 0.03698055446147919, -0.0891241505742073, -0.2549011707305908, -0.5457299947738647, 0.5439645648002625, -0.14600971341133118, 0.7253587245941162, -0.3615794777870178, -0.1916186660528183, -0.0800270363688469, 0.3084258735179901, 0.3081444501876831, -0.45140019059181213, 0.8162826895713806, 0.11999648064374924, 0.7037228941917419, -0.7058388590812683, 0.28039517998695374, -0.19574420154094696, -0.6465740203857422, 0.5377225279808044, -0.16049358248710632, 0.026890277862548828, -0.15264803171157837, -0.09459269046783447, 0.4072652757167816, 0.9061192870140076, 0.5311342477798462, -0.0942932739853859, 0.3109177350997925, -0.3683598041534424, 0.21373189985752106, -0.8489325642585754, -0.7855852246284485, 0.5792742371559143, -0.15054453909397125, -0.17168574035167694, -0.7664399147033691, 0.631038248538971, -0.12491560727357864, -0.5551644563674927, -0.06172151491045952, 0.3771648406982422, 0.4695549011230469, -0.3904258906841278, -0.1710127741098404, 0.16710685193538666, -0.057124923914670944, -0.30401062965393066, 1.3729697465896606, 0.8717663288116455, -0.42439767718315125, 0.015190724283456802, -0.2796957790851593, 0.8212599158287048, -0.9398308992385864, 0.3783548176288605, -0.615128219127655, -0.6007596850395203, -0.3776596486568451, 0.4018876552581787, -0.14688272774219513, 0.009472213685512543, 0.17893382906913757, 0.40368688106536865, -0.4428730309009552, 0.03065122663974762, 0.13217687606811523, -0.19190272688865662, 0.030334819108247757, 0.7698116898536682, -0.6594536900520325, 0.6236900687217712, 1.6886693239212036, -0.19159337878227234, -0.20199142396450043, -0.0830216109752655, -0.09809301048517227, 0.3138219118118286, 0.08755908161401749, -0.025122838094830513, -0.26362258195877075, -0.035129763185977936, -0.5444126725196838, 0.05795755237340927, 0.0276133231818676, 0.6616556644439697, 0.13654161989688873, 0.03635462746024132, -0.11508876085281372, -0.10434804111719131, 0.1893610656261444, -1.7245707511901855, 0.5563981533050537, 0.405717670917511, 1.8879872560501099, 0.6587176322937012, 0.45244115591049194, 0.11229867488145828, -0.3042900562286377, 0.4408334195613861, -0.0655910074710846, 0.031920019537210464, -0.1659400761127472, 0.24196431040763855, 0.04033747687935829, -0.0748477578163147, -0.13986049592494965, -0.14861544966697693, 0.2863500714302063, 0.028413105756044388, -0.009438609704375267, 0.006215375382453203, -0.05486372113227844, -1.0177644491195679, 1.8886873722076416, 0.2998218238353729, 0.0208722036331892, -0.5001301765441895, -0.6955188512802124, -0.42575711011886597, 0.08472698926925659, -0.058353159576654434, 0.5247563123703003, 0.011545980349183083, 0.332996666431427, 0.04269672930240631, 0.4109162986278534, -0.2619982659816742, 0.042774125933647156, -0.313292920589447, -0.038780756294727325, 0.2440076619386673, -0.06329561024904251, 0.09586194157600403, 0.11006293445825577, -1.0793137550354004, 1.5183556079864502, -0.07820325344800949, 0.1404220014810562, 0.30391067266464233, 0.453557550907135, 0.5196741819381714, -0.7280279397964478, 0.42519497871398926, 0.4841720461845398, -0.3017624616622925, 1.1148295402526855, 0.3632834255695343, -0.803073525428772, 0.10625451803207397, -0.15866442024707794, 0.20540575683116913, 0.16658829152584076, 0.21056245267391205, -0.06954415142536163, -0.9863367676734924, -0.04084261134266853, -0.1635095775127411, 1.6609814167022705, -0.2805032432079315, 1.085270643234253, 0.3255842626094818, -0.39640945196151733, -0.4523247480392456, 0.08717063069343567, -0.05808660760521889, 0.2439301311969757, -0.25413569808006287, 0.681477427482605, 0.15152230858802795, 0.9365609884262085, 0.1919865608215332, 0.0910574346780777, -0.2554026246070862, 0.3272669017314911, 0.3985709547996521, 0.025603357702493668, 0.38706550002098083, -0.32336482405662537, -0.3927304148674011, 0.0740598663687706, -1.3737441301345825, -1.7428587675094604, -0.34351250529289246, -1.139904499053955, 0.12988168001174927, -0.21383260190486908, 0.2107233852148056, 0.09095655381679535, -0.16729237139225006, -0.09014112502336502, 0.27622413635253906, -0.3507964313030243, 0.23952160775661469, 0.031763359904289246, 0.20916691422462463, -0.35586729645729065, -0.5714516639709473, -0.1307530254125595, 0.07254279404878616, -0.030489491298794746, -0.6692616939544678, 0.587738037109375, -0.28285887837409973, 0.20710033178329468, 0.03224613144993782, -0.6376116871833801, 2.2589645385742188, 2.6885616779327393, 0.7612805366516113, 0.019999999552965164 };
-};
+#endif // MARSHALLMODEL_H
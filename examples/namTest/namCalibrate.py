@@ -0,0 +1,108 @@
+# Calibration of NAM WaveNet models for Jaffx::wavenet::QuantizedWavenet (include/QuantizedWavenet.hpp):
+# runs the float model over a calibration signal and picks the fixed-point format of every
+# layer's residual stream from the largest value it reaches.
+# Used by namToArray.py and namToBinary.py (--calibrate), pure Python so it's slow, keep signals short.
+import math
+import struct
+import wave
+
+HEADROOM_BITS = 1  # residuals use at most half of int16, so louder inputs than the calibration signal don't clip
+
+def nam_tanh(x):
+    # the rational approximation of Jaffx::wavenet::NAMMathsProvider
+    ax = abs(x)
+    x2 = x * x
+    return (x * (2.45550750702956 + 2.45550750702956 * ax + (0.893229853513558 + 0.821226666969744 * ax) * x2)) / \
+           (2.44506634652299 + (2.44506634652299 + x2) * abs(x + 0.814642734961073 * x * ax))
+
+def parse_weights(model):
+    # splits the flat .nam weights per layer array, in the order Jaffx::wavenet::LayerArrayProcessor loads them
+    weights = iter(model["weights"])
+    take = lambda n: [next(weights) for _ in range(n)]
+    arrays = []
+    for config in model["config"]["layers"]:
+        C, K, IN, H = config["channels"], config["kernel_size"], config["input_size"], config["head_size"]
+        array = {"C": C, "K": K, "rechannel": [take(IN) for _ in range(C)], "layers": []}
+        for dilation in config["dilations"]:
+            conv = [[take(K) for _ in range(C)] for _ in range(C)]  # [out][in][tap]
+            array["layers"].append({
+                "dilation": dilation, "conv": conv, "bias": take(C), "mixin": take(C),
+                "conv1x1": [take(C) for _ in range(C)], "bias1x1": take(C),
+            })
+        array["head"] = [take(C) for _ in range(H)]
+        array["head_bias"] = take(H) if config["head_bias"] else [0.0] * H
+        arrays.append(array)
+    return arrays
+
+def residual_maxima(model, signal):
+    # largest |value| of every layer's input and of each array's output, per array
+    arrays = parse_weights(model)
+    inputs = [[x] for x in signal]
+    head = None
+    maxima = []
+    for array in arrays:
+        C, K = array["C"], array["K"]
+        x = [[sum(w * v for w, v in zip(row, frame)) for row in array["rechannel"]] for frame in inputs]
+        head_acc = [h[:] for h in head] if head else [[0.0] * C for _ in signal]
+        peaks = []
+        for layer in array["layers"]:
+            peaks.append(max(abs(v) for frame in x for v in frame))
+            d, conv, bias, mixin = layer["dilation"], layer["conv"], layer["bias"], layer["mixin"]
+            w1, b1 = layer["conv1x1"], layer["bias1x1"]
+            taps = [(k, d * (K - 1 - k)) for k in range(K)]
+            nx = []
+            for t, frame in enumerate(x):
+                z = []
+                for c in range(C):
+                    acc = bias[c] + mixin[c] * signal[t]
+                    for k, back in taps:
+                        if t >= back:  # zero history
+                            past = x[t - back]
+                            acc += sum(conv[c][j][k] * past[j] for j in range(C))
+                    z.append(nam_tanh(acc))
+                for c in range(C):
+                    head_acc[t][c] += z[c]
+                nx.append([frame[c] + sum(w1[c][j] * z[j] for j in range(C)) + b1[c] for c in range(C)])
+            x = nx
+        peaks.append(max(abs(v) for frame in x for v in frame))
+        maxima.append(peaks)
+        head = [[sum(w * v for w, v in zip(row, acc)) + b for row, b in zip(array["head"], array["head_bias"])]
+                for acc in head_acc]
+        inputs = x
+    return maxima
+
+def fraction_bits(peak):
+    # fractional bits of an int16 format holding `peak` with HEADROOM_BITS to spare
+    if peak <= 0:
+        return 15
+    return max(0, min(15, 15 - HEADROOM_BITS - math.ceil(math.log2(peak))))
+
+def calibration_signal(sample_rate, wav_file=None, seconds=0.5):
+    # `seconds` of a wav file (16/24/32-bit PCM, first channel), or synthetic plucks and a sweep
+    length = int(seconds * sample_rate)
+    if wav_file:
+        with wave.open(wav_file, 'rb') as f:
+            width, channels = f.getsampwidth(), f.getnchannels()
+            frames = f.readframes(min(length, f.getnframes()))
+        scale = float(1 << (8 * width - 1))
+        signal = []
+        for i in range(0, len(frames), width * channels):
+            sample = frames[i:i + width]
+            value = int.from_bytes(sample, 'little', signed=True) if width > 1 else sample[0] - 128
+            signal.append(value / scale)
+        return signal
+    signal = []
+    for i in range(length):
+        t = i / sample_rate
+        pluck = t % 0.125
+        frequency = 82.41 * 2 ** ((i * 7 // length) * 5 / 12)  # low E, climbing in fourths
+        sweep = 0.9 * math.sin(2 * math.pi * (40 + 2000 * t / seconds) * t)
+        signal.append(math.exp(-12 * pluck) * math.sin(2 * math.pi * frequency * t) if t < seconds / 2 else sweep)
+    return signal
+
+def calibrate(model, wav_file=None, seconds=0.5):
+    # residual fractional bits, flattened: per array, every layer's input then the array's output
+    signal = calibration_signal(int(model.get("sample_rate", 48000) or 48000), wav_file, seconds)
+    signal = [struct.unpack('<f', struct.pack('<f', x))[0] for x in signal]
+    maxima = residual_maxima(model, signal)
+    return [fraction_bits(peak) for peaks in maxima for peak in peaks]
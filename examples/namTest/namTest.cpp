@@ -1,49 +1,26 @@
 #include "../../Jaffx.hpp"
 #include "../../Gimmel/include/gimmel.hpp"
+#include "../../include/Graph.hpp"
 #include <memory> // for unique_ptr && make_unique
 
-#include "DumbleModel.h"
-#include "MarshallModel.h"
+#include "AmpModeler.hpp"
 
-// Add NAM compatibility to giml
-namespace giml {
-  template <typename T, typename Layer1, typename Layer2>
-  class AmpModeler : public Effect<T> {
-  private:
-    wavenet::RTWavenet<1, 1, Layer1, Layer2> clean, dirty;
-    DumbleModelWeights cleanWeights;
-    MarshallModelWeights dirtyWeights;
-
-  public:
-    void loadModels() {
-      this->clean.loadModel(this->cleanWeights.weights);
-      this->dirty.loadModel(this->dirtyWeights.weights);
-    }
-    
-    T processSample(const T& input) override {
-      if (!this->enabled) { return this->clean.model.forward(input); }
-      return this->dirty.model.forward(input);
-    }
-  };
-}
 	
 class NamTest : public Jaffx::Firmware {
-  giml::AmpModeler<float, Layer1, Layer2> model;
+  giml::AmpModeler<float> model;
   std::unique_ptr<giml::Detune<float>> mDetune;
   std::unique_ptr<giml::Delay<float>> mDelay;
   std::unique_ptr<giml::Delay<float>> mDelay2;
-  giml::EffectsLine<float> mFxChain;
+  Jaffx::Graph<float> mGraph; // amp -> detune -> two delays in parallel -> mix
 
   void init() override {
     this->debug = true;
     model.loadModels();
     model.enable();
-    mFxChain.pushBack(&model);
 
     mDetune = std::make_unique<giml::Detune<float>>(this->samplerate);
     mDetune->setParams(0.995f);
     //mDetune->enable();
-    mFxChain.pushBack(mDetune.get());
 
     mDelay = std::make_unique<giml::Delay<float>>(this->samplerate);
     mDelay->setParams(398.f, 0.3f, 0.7f, 0.24f);
@@ -52,17 +29,27 @@ class NamTest : public Jaffx::Firmware {
     mDelay2 = std::make_unique<giml::Delay<float>>(this->samplerate);
     mDelay2->setParams(798.f, 0.2f, 0.7f, 0.24f);
     mDelay2->enable();
+
+    const int amp = mGraph.addEffect(&model);
+    const int detune = mGraph.addEffect(mDetune.get());
+    const int delay1 = mGraph.addEffect(mDelay.get());
+    const int delay2 = mGraph.addEffect(mDelay2.get());
+    const int mix = mGraph.addMix();
+    mGraph.connect(mGraph.input(), amp);
+    mGraph.connect(amp, detune);
+    mGraph.connect(detune, delay1);
+    mGraph.connect(detune, delay2);
+    mGraph.connect(delay1, mix, 0.5f);
+    mGraph.connect(delay2, mix, 0.5f);
+    mGraph.connect(mix, mGraph.output());
+    mGraph.compile();
   }
 
-  float processAudio(float in) override {
-    float dry = mFxChain.processSample(in);
-    float delay1 = mDelay->processSample(dry);
-    float delay2 = mDelay2->processSample(dry);
-    float output = giml::linMix(delay1, delay2, 0.5f);
-    return output;
+  void processBlock(const float* in, float* out, size_t size) override {
+    mGraph.processBlock(in, out, size);
   }
 
-  void loop() override {}
+  void loop() override { model.update(); }
   
 };
 
@@ -0,0 +1,79 @@
+import argparse
+import json
+import struct
+import sys
+import os
+from namCalibrate import calibrate
+
+def nam_to_c_array(input_file, calibration=False, wav_file=None):
+    try:
+        with open(input_file, 'r') as f:
+            model = json.load(f)
+
+        architecture = model.get("architecture", "unknown")
+        config = model.get("config", {})
+        # round to float32 first, so the printed values are exactly what the firmware loads
+        weights = [struct.unpack('<f', struct.pack('<f', w))[0] for w in model["weights"]]
+
+        print(f"Architecture: {architecture}")
+        print(f"Weights: {len(weights)}")
+
+        # Generate the output file name with .h extension
+        base_name = os.path.splitext(os.path.basename(input_file))[0]
+        # Replace special characters in filename for valid C identifier
+        safe_name = "".join(c if c.isalnum() else "_" for c in base_name)
+        output_file = os.path.join(os.path.dirname(input_file), f"{safe_name}.h")
+
+        # Write the C array to the output file
+        with open(output_file, 'w') as f:
+            f.write(f"// Converted from {os.path.basename(input_file)} by namToArray.py\n")
+            f.write(f"// Architecture: {architecture}\n")
+            for i, layer in enumerate(config.get("layers", [])):
+                f.write(f"// Layer array {i + 1}: {json.dumps(layer)}\n")
+            if "head_scale" in config:
+                f.write(f"// Head scale: {config['head_scale']}\n")
+            if "sample_rate" in model:
+                f.write(f"// Sample rate: {model['sample_rate']} Hz\n")
+            f.write("\n")
+            f.write(f"#ifndef {safe_name.upper()}_H\n")
+            f.write(f"#define {safe_name.upper()}_H\n\n")
+            f.write(f"const float {safe_name}_weights[] = {{\n")
+
+            # Write data in chunks for better readability
+            # (9 significant digits round-trip every float exactly)
+            chunk_size = 6
+            for i in range(0, len(weights), chunk_size):
+                chunk = weights[i:i+chunk_size]
+                f.write("    " + ", ".join(f"{x:.9g}f" for x in chunk))
+                if i + chunk_size < len(weights):
+                    f.write(",")
+                f.write("\n")
+
+            f.write("};\n\n")
+            f.write(f"const unsigned int {safe_name}_weights_len = {len(weights)};\n\n")
+
+            if calibration:
+                # residual formats for Jaffx::wavenet::QuantizedWavenet, see namCalibrate.py
+                residual_bits = calibrate(model, wav_file)
+                f.write(f"const signed char {safe_name}_residual_bits[] = {{ {', '.join(map(str, residual_bits))} }};\n")
+                f.write(f"const unsigned int {safe_name}_residual_bits_len = {len(residual_bits)};\n\n")
+            f.write(f"#endif // {safe_name.upper()}_H\n")
+
+        print(f"Conversion complete. Output saved to {output_file}")
+        print(f"Array name: {safe_name}_weights")
+        print(f"Array length: {safe_name}_weights_len")
+        if calibration:
+            print(f"Calibration: {safe_name}_residual_bits")
+
+    except Exception as e:
+        print(f"Error: {e}")
+        import traceback
+        traceback.print_exc()
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Converts a .nam file to a C header of its weights")
+    parser.add_argument("input_nam_file")
+    parser.add_argument("--calibrate", action="store_true", help="add calibration for QuantizedWavenet")
+    parser.add_argument("--wav", help="calibration signal (default: synthetic plucks and a sweep)")
+    args = parser.parse_args()
+    nam_to_c_array(args.input_nam_file, args.calibrate, args.wav)
@@ -0,0 +1,121 @@
+import argparse
+import json
+import struct
+import sys
+import os
+import zlib
+from namCalibrate import calibrate
+
+# Must match Jaffx::ModelFile (include/ModelFile.hpp)
+MAGIC = b"JNAM"
+VERSION = 2  # 1 has no calibration
+MAX_ARRAYS = 4
+MAX_DILATIONS = 32
+HEADER_FORMAT = "<4sHHIIII"  # magic, version, numArrays, numWeights, sampleRate, weightsOffset, weightsCrc
+ARRAY_FORMAT = f"<8H{MAX_DILATIONS}H"  # inputSize, conditionSize, headSize, channels, kernelSize, headBias, numDilations, reserved, dilations
+
+def read_nam(input_file):
+    with open(input_file, 'r') as f:
+        model = json.load(f)
+    if model.get("architecture") != "WaveNet":
+        raise ValueError(f"Only WaveNet models are supported, got {model.get('architecture')}")
+    layers = model["config"]["layers"]
+    if not 0 < len(layers) <= MAX_ARRAYS:
+        raise ValueError(f"Expected 1 to {MAX_ARRAYS} layer arrays, got {len(layers)}")
+    for layer in layers:
+        if layer.get("gated") or layer.get("activation", "Tanh") != "Tanh":
+            raise ValueError("Only non-gated Tanh layer arrays are supported")
+        if len(layer["dilations"]) > MAX_DILATIONS:
+            raise ValueError(f"At most {MAX_DILATIONS} dilations per layer array are supported")
+    return model
+
+def pack_model(model, residual_bits=None):
+    layers = model["config"]["layers"]
+    weights = struct.pack(f"<{len(model['weights'])}f", *model["weights"])
+    calibration = struct.pack(f"<{len(residual_bits)}b", *residual_bits) if residual_bits else b""
+    calibration += b"\0" * (-len(calibration) % 4)
+    offset = struct.calcsize(HEADER_FORMAT) + len(layers) * struct.calcsize(ARRAY_FORMAT) + len(calibration)
+    header = struct.pack(HEADER_FORMAT, MAGIC, VERSION if residual_bits else 1, len(layers), len(model["weights"]),
+                         int(model.get("sample_rate", 0) or 0), offset, zlib.crc32(weights))
+    arrays = b""
+    for layer in layers:
+        dilations = layer["dilations"] + [0] * (MAX_DILATIONS - len(layer["dilations"]))
+        arrays += struct.pack(ARRAY_FORMAT, layer["input_size"], layer["condition_size"], layer["head_size"],
+                              layer["channels"], layer["kernel_size"], int(layer["head_bias"]),
+                              len(layer["dilations"]), 0, *dilations)
+    return header + arrays + calibration + weights
+
+def unpack_model(data):
+    header_size = struct.calcsize(HEADER_FORMAT)
+    magic, version, num_arrays, num_weights, sample_rate, offset, crc = struct.unpack_from(HEADER_FORMAT, data)
+    if magic != MAGIC or not 1 <= version <= VERSION:
+        raise ValueError(f"Not a version 1 to {VERSION} .jnam file")
+    layers = []
+    for i in range(num_arrays):
+        fields = struct.unpack_from(ARRAY_FORMAT, data, header_size + i * struct.calcsize(ARRAY_FORMAT))
+        layers.append({
+            "input_size": fields[0], "condition_size": fields[1], "head_size": fields[2],
+            "channels": fields[3], "kernel_size": fields[4], "head_bias": bool(fields[5]),
+            "dilations": list(fields[8:8 + fields[6]]),
+        })
+    position = header_size + num_arrays * struct.calcsize(ARRAY_FORMAT)
+    count = sum(len(layer["dilations"]) + 1 for layer in layers) if version >= 2 else 0
+    residual_bits = list(struct.unpack_from(f"<{count}b", data, position))
+    weights_bytes = data[offset:offset + 4 * num_weights]
+    if len(weights_bytes) != 4 * num_weights:
+        raise ValueError("Truncated weights")
+    if zlib.crc32(weights_bytes) != crc:
+        raise ValueError("Weights checksum mismatch")
+    weights = list(struct.unpack(f"<{num_weights}f", weights_bytes))
+    return {"sample_rate": sample_rate, "layers": layers, "residual_bits": residual_bits, "weights": weights}
+
+def verify(model, output_file, residual_bits=None):
+    with open(output_file, 'rb') as f:
+        decoded = unpack_model(f.read())
+    # compare against the weights rounded to float32, which is what the firmware loads
+    expected = [struct.unpack('<f', struct.pack('<f', w))[0] for w in model["weights"]]
+    if decoded["weights"] != expected:
+        mismatches = sum(a != b for a, b in zip(decoded["weights"], expected))
+        raise ValueError(f"Round trip failed: {mismatches} weights differ")
+    for layer, original in zip(decoded["layers"], model["config"]["layers"]):
+        for key, value in layer.items():
+            if value != original[key]:
+                raise ValueError(f"Round trip failed: {key} is {value}, expected {original[key]}")
+    if decoded["sample_rate"] != int(model.get("sample_rate", 0) or 0):
+        raise ValueError("Round trip failed: sample rate differs")
+    if decoded["residual_bits"] != (residual_bits or []):
+        raise ValueError("Round trip failed: calibration differs")
+    print(f"Verified {len(expected)} weights and {len(decoded['layers'])} layer arrays")
+
+def nam_to_binary(input_file, check=False, calibration=False, wav_file=None):
+    try:
+        model = read_nam(input_file)
+        output_file = os.path.splitext(input_file)[0] + ".jnam"
+        residual_bits = None
+        if calibration:
+            residual_bits = calibrate(model, wav_file)
+            print(f"Residual bits: {residual_bits}")
+        data = pack_model(model, residual_bits)
+        with open(output_file, 'wb') as f:
+            f.write(data)
+
+        print(f"Weights: {len(model['weights'])}")
+        print(f"Conversion complete. Output saved to {output_file} ({len(data)} bytes)")
+        if check:
+            verify(model, output_file, residual_bits)
+        return True
+
+    except Exception as e:
+        print(f"Error: {e}")
+        import traceback
+        traceback.print_exc()
+        return False
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Converts a .nam file to a .jnam file for Jaffx::ModelFile")
+    parser.add_argument("input_nam_file")
+    parser.add_argument("--verify", action="store_true", help="read the output back and compare it with the input")
+    parser.add_argument("--calibrate", action="store_true", help="add calibration for QuantizedWavenet")
+    parser.add_argument("--wav", help="calibration signal (default: synthetic plucks and a sweep)")
+    args = parser.parse_args()
+    sys.exit(0 if nam_to_binary(args.input_nam_file, args.verify, args.calibrate, args.wav) else 1)
@@ -1,8 +1,15 @@
 #include "../../Jaffx.hpp"
 #include "../../Gimmel/include/gimmel.hpp"
+#include "../../include/Pipeline.hpp"
+#include <memory> // for unique_ptr && make_unique
 
 class NoiseTest : public Jaffx::Firmware {
   giml::Compressor<float> mCompressor{this->samplerate};
+  std::unique_ptr<giml::Delay<float>> mDelay; // wet only, one block late
+
+  // runs the delay (and any other heavy, latency-tolerant work) in `loop()`
+  Jaffx::Pipeline<float> mPipeline;
+  float mWet[128];
 
   // use this to balance CPU load between audio callback and loop()
   void burnCycles(unsigned howMany = 1000) {
@@ -19,16 +26,24 @@ class NoiseTest : public Jaffx::Firmware {
   void init() override {
     mCompressor.setParams(-20.f, 4.f, 10.f, 5.f, 3.5f, 100.f);
     mCompressor.enable();
+    mDelay = std::make_unique<giml::Delay<float>>(this->samplerate);
+    mDelay->setParams(398.f, 0.3f, 0.7f, 1.f);
+    mDelay->enable();
     this->debug = true;
   }
 
-  float processAudio(float in) override {
-    this->burnCycles(400);
-    return mCompressor.processSample(in);
+  void processBlock(const float* in, float* out, size_t size) override {
+    for (size_t i = 0; i < size; i++) { out[i] = mCompressor.processSample(in[i]); }
+    // delay output for the previous block
+    if (!mPipeline.exchange(out, mWet, size)) { this->telemetry.push("pipeline underrun"); }
+    for (size_t i = 0; i < size; i++) { out[i] += 0.24f * mWet[i]; }
   }
 
   void loop() override {
-    //this->burnCycles();
+    mPipeline.service([this](float* block, size_t size) {
+      this->burnCycles(400 * size); // load that would overrun the audio callback
+      for (size_t i = 0; i < size; i++) { block[i] = mDelay->processSample(block[i]); }
+    });
   }
   
 };
@@ -39,4 +54,3 @@ int main() {
   return 0;
 }
 
-
@@ -0,0 +1,42 @@
+#include "../../Jaffx.hpp"
+
+// Stereo ping-pong delay, demonstrates `Jaffx::StereoFirmware`
+// Each channel's delay feeds the opposite channel, so repeats bounce L/R
+class PingPong : public Jaffx::StereoFirmware {
+  static const int maxDelay = 48000; // 1 second @ 48kHz
+  float* bufferL = nullptr;
+  float* bufferR = nullptr;
+  int writeHead = 0;
+  int delaySamples = 18000; // 375ms
+  float feedback = 0.5f;
+  float mix = 0.4f;
+
+  void init() override {
+    // delay lines live in SDRAM
+    bufferL = (float*)Jaffx::mSDRAM.calloc(maxDelay, sizeof(float));
+    bufferR = (float*)Jaffx::mSDRAM.calloc(maxDelay, sizeof(float));
+  }
+
+  void processFrame(float inL, float inR, float& outL, float& outR) override {
+    int readHead = writeHead - delaySamples;
+    if (readHead < 0) { readHead += maxDelay; }
+    const float delayedL = bufferL[readHead];
+    const float delayedR = bufferR[readHead];
+
+    // cross-feedback: left repeats into right and vice versa
+    bufferL[writeHead] = inL + delayedR * feedback;
+    bufferR[writeHead] = inR + delayedL * feedback;
+    writeHead++;
+    if (writeHead >= maxDelay) { writeHead = 0; }
+
+    outL = inL + (delayedL - inL) * mix;
+    outR = inR + (delayedR - inR) * mix;
+  }
+
+};
+
+int main() {
+  PingPong mPingPong;
+  mPingPong.start();
+  return 0;
+}
@@ -5,7 +5,6 @@
 class Serial : public Jaffx::Firmware {
   const char message[7] = "Hello!"; // set a message
   unsigned int counter = 0;
-  bool trigger = false;
 
   void init() override {
     this->hardware.StartLog(true);
@@ -13,20 +12,14 @@ class Serial : public Jaffx::Firmware {
 
   float processAudio(float in) override {
     counter++;
-    if (counter >= this->samplerate && !trigger) { // once per second
+    if (counter >= this->samplerate) { // once per second
       counter = 0;
-      trigger = true; // trigger a print
+      // printing from the audio callback would block it, so queue
+      // the message as telemetry for the main loop to print
+      this->telemetry.push(message);
     }
     return 0.f;
   }
-
-  void loop() override {
-    if (trigger) { // print set by trigger
-      this->hardware.PrintLine(message);
-      trigger = false;
-    }
-    System::Delay(500); // Don't spam the serial!
-  }
 };
 
 int main() {
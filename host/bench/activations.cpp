@@ -0,0 +1,107 @@
+// Benchmarks the activation approximations (include/Activations.hpp) against std::tanh:
+// accuracy and speed of each tanh, then the NAM WaveNet engine run with each maths provider.
+// Usage: make bench && ./build/bench/activations [seconds]
+//        (add OPT="-O3 -fno-tree-vectorize" to compare the costs on a scalar FPU, like the Cortex-M7's)
+#include "../../Jaffx.hpp"
+#include "../../include/Wavenet.hpp"
+#include "../../examples/namTest/MarshallModel.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+static const int blockSize = 128;
+static const int sampleRate = 48000;
+volatile float sink; // keeps timed results alive
+
+using namespace Jaffx::wavenet;
+
+// The AmpModeler architecture with a choice of maths provider
+template <typename Maths>
+using Model = Wavenet<LayerArray<float, 1, 1, 2, 2, 3, Dilations<1, 2, 4, 8, 16, 32, 64>, false, Maths>,
+                      LayerArray<float, 2, 1, 1, 2, 3, Dilations<128, 256, 512, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512>, true, Maths>>;
+
+// guitar-ish test signal: decaying plucks over a little noise
+static std::vector<float> makeSignal(size_t length) {
+  std::vector<float> signal(length);
+  uint32_t seed = 1;
+  for (size_t i = 0; i < length; i++) {
+    const float t = float(i % sampleRate) / sampleRate;
+    seed = seed * 1664525u + 1013904223u;
+    const float noise = float(int32_t(seed)) / 2147483648.f;
+    signal[i] = 0.5f * std::exp(-4.f * t) * std::sin(2.f * float(M_PI) * 110.f * t) + 0.01f * noise;
+  }
+  return signal;
+}
+
+template <typename Process>
+static double nanoseconds(Process process) {
+  const auto start = std::chrono::steady_clock::now();
+  process();
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+// Max abs error against std::tanh over [-10, 10], and ns per call over a buffer
+template <typename Maths>
+static void tanhAccuracy(const char* name) {
+  double maxError = 0.0;
+  for (int i = -1000000; i <= 1000000; i++) {
+    const float x = float(i) * 1e-5f;
+    maxError = std::fmax(maxError, std::fabs(double(Maths::tanh(x)) - std::tanh(double(x))));
+  }
+
+  static float buffer[4096];
+  for (int i = 0; i < 4096; i++) { buffer[i] = float(i - 2048) / 256.f; }
+  const int passes = 2000;
+  const double ns = nanoseconds([&] {
+    for (int pass = 0; pass < passes; pass++) {
+      for (float& x : buffer) { x = Maths::tanh(x) * 4.f; } // stays in range, can't be hoisted
+      sink = buffer[pass & 4095];
+    }
+  });
+  std::printf("  %-26s max abs error %.3g, %6.2f ns/call\n", name, maxError, ns / (passes * 4096.0));
+}
+
+// WaveNet per block with `Maths`, error against the exact tanh model
+template <typename Maths>
+static void wavenet(const char* name, const std::vector<float>& input, const std::vector<float>& reference) {
+  const size_t length = input.size();
+  std::vector<float> output(length);
+  std::unique_ptr<Model<Maths>> model(new Model<Maths>);
+  model->loadModel(MarshallModel_weights, MarshallModel_weights_len);
+  const double ns = nanoseconds([&] {
+    for (size_t i = 0; i < length; i += blockSize) { model->process(&input[i], &output[i], blockSize); }
+  }) / double(length);
+  double maxError = 0.0;
+  for (size_t i = 0; i < length; i++) { maxError = std::fmax(maxError, std::fabs(double(output[i]) - reference[i])); }
+  std::printf("  %-26s %8.2f ns/sample (%5.2f%% of real time), max abs error %.3g\n", name, ns, 100.0 * ns * sampleRate / 1e9, maxError);
+}
+
+int main(int argc, char** argv) {
+  const double seconds = argc > 1 ? std::atof(argv[1]) : 10.0;
+  const size_t length = (size_t(seconds * sampleRate) / blockSize) * blockSize;
+
+  std::printf("tanh:\n");
+  tanhAccuracy<StdMathsProvider>("std::tanh");
+  tanhAccuracy<NAMMathsProvider>("NAMMathsProvider");
+  tanhAccuracy<FastMathsProvider<Jaffx::Accuracy::Low>>("FastMathsProvider<Low>");
+  tanhAccuracy<FastMathsProvider<Jaffx::Accuracy::Medium>>("FastMathsProvider<Medium>");
+  tanhAccuracy<FastMathsProvider<Jaffx::Accuracy::High>>("FastMathsProvider<High>");
+
+  const std::vector<float> input = makeSignal(length);
+  std::vector<float> reference(length);
+  std::unique_ptr<Model<StdMathsProvider>> exact(new Model<StdMathsProvider>);
+  exact->loadModel(MarshallModel_weights, MarshallModel_weights_len);
+  exact->process(input.data(), reference.data(), length);
+
+  std::printf("WaveNet, %zu samples, block size %d (error against std::tanh):\n", length, blockSize);
+  wavenet<StdMathsProvider>("std::tanh", input, reference);
+  wavenet<NAMMathsProvider>("NAMMathsProvider", input, reference);
+  wavenet<FastMathsProvider<Jaffx::Accuracy::Low>>("FastMathsProvider<Low>", input, reference);
+  wavenet<FastMathsProvider<Jaffx::Accuracy::Medium>>("FastMathsProvider<Medium>", input, reference);
+  wavenet<FastMathsProvider<Jaffx::Accuracy::High>>("FastMathsProvider<High>", input, reference);
+  return 0;
+}
@@ -0,0 +1,149 @@
+// Checks the allocator statistics (include/Tlsf.hpp, include/Memory.hpp) after a known
+// sequence of allocations and frees: usage, peak, fragmentation, the size histogram,
+// call counters, live-allocation tracking and per-tag placement counts.
+// Usage: make bench && ./build/bench/allocstats
+#define JAFFX_ALLOC_TRACKING
+#include "../../include/SDRAM.hpp"
+#include "../../include/Memory.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static int failures = 0;
+static void expect(bool condition, const char* what) {
+  if (!condition) {
+    failures++;
+    std::printf("FAIL: %s\n", what);
+  }
+}
+
+// Counts the lines a report prints, and those containing `needle`
+struct CountingPrinter {
+  int* lines;
+  int* matches;
+  const char* needle;
+  template <typename... Args>
+  void operator()(const char* format, Args... args) const {
+    char line[256];
+    std::snprintf(line, sizeof(line), format, args...);
+    (*this->lines)++;
+    if (this->needle && std::strstr(line, this->needle)) { (*this->matches)++; }
+  }
+};
+
+static void tlsfStats() {
+  std::vector<unsigned char> region(64 * 1024);
+  Jaffx::Tlsf tlsf;
+  tlsf.init(region.data(), region.size());
+  const Jaffx::Tlsf::Stats empty = tlsf.getStats();
+  expect(empty.bytesInUse == 0 && empty.freeBlocks == 1 && empty.largestFree == empty.freeBytes, "bad initial stats");
+  expect(empty.fragmentation() == 0.f, "empty heap fragmented");
+
+  void* a = tlsf.malloc(1000, "a");
+  void* b = tlsf.malloc(2000, "b");
+  void* c = tlsf.malloc(1000, "c");
+  void* d = tlsf.malloc(24, "d");
+  Jaffx::Tlsf::Stats stats = tlsf.getStats();
+  expect(stats.bytesInUse == 4024 && stats.usedBlocks == 4, "bytes in use after 4 allocations");
+  expect(stats.peakBytesInUse == 4024, "peak after 4 allocations");
+  expect(stats.allocations == 4 && stats.frees == 0 && stats.failures == 0, "call counters after 4 allocations");
+  expect(stats.freeBlocks == 1 && stats.fragmentation() == 0.f, "allocating from the end fragmented the heap");
+
+  // a hole of 2000 bytes before the tail
+  tlsf.free(b);
+  stats = tlsf.getStats();
+  expect(stats.bytesInUse == 2024 && stats.usedBlocks == 3, "bytes in use after a free");
+  expect(stats.peakBytesInUse == 4024, "peak dropped after a free");
+  expect(stats.freeBlocks == 2 && stats.freeBytes == stats.largestFree + 2000, "free blocks after punching a hole");
+  expect(std::fabs(stats.fragmentation() - 2000.f / float(stats.freeBytes)) < 1e-6f, "fragmentation of one hole");
+
+  // freeing the neighbour merges into one bigger hole
+  tlsf.free(a);
+  const Jaffx::Tlsf::Stats merged = tlsf.getStats();
+  expect(merged.freeBlocks == 2 && merged.freeBytes > stats.freeBytes + 1000, "hole not merged with its neighbour");
+  expect(merged.fragmentation() > stats.fragmentation(), "a bigger hole should fragment more");
+
+  // histogram bins: <= 32 bytes is bin 2, <= 1024 bin 7, <= 2048 bin 8
+  const uint32_t* histogram = tlsf.getHistogram();
+  expect(histogram[2] == 1 && histogram[7] == 2 && histogram[8] == 1, "size histogram");
+
+  // failures are counted, and don't move the peak
+  expect(tlsf.malloc(region.size()) == nullptr, "oversized malloc succeeded");
+  stats = tlsf.getStats();
+  expect(stats.failures == 1 && stats.peakBytesInUse == 4024, "failed malloc counted wrong");
+
+  // live allocations: c and d, with their sites
+  int lines = 0, matches = 0;
+  tlsf.reportLive(CountingPrinter{&lines, &matches, " from c"});
+  expect(lines == 2 && matches == 1, "live allocations");
+
+  // resetCounters() restarts the peak from current usage
+  tlsf.resetCounters();
+  stats = tlsf.getStats();
+  expect(stats.peakBytesInUse == stats.bytesInUse && stats.allocations == 0 && stats.failures == 0, "reset counters");
+  expect(tlsf.getHistogram()[7] == 0, "reset histogram");
+
+  tlsf.free(c);
+  tlsf.free(d);
+  stats = tlsf.getStats();
+  expect(stats.bytesInUse == 0 && stats.freeBlocks == 1 && stats.freeBytes == empty.freeBytes, "not empty after freeing everything");
+  expect(stats.fragmentation() == 0.f && stats.frees == 2, "stats after freeing everything");
+  lines = 0;
+  tlsf.reportLive(CountingPrinter{&lines, &matches, nullptr});
+  expect(lines == 0, "live allocations after freeing everything");
+}
+
+static void placementStats() {
+  Jaffx::mSDRAM.init();
+  Jaffx::mMemory.init(); // a JAFFX_FAST_HEAP_SIZE fast heap, 64KB by default
+
+  Jaffx::mMemory.setTag("small");
+  void* small = Jaffx::mMemory.allocate(100); // Auto, fast
+  void* large = Jaffx::mMemory.allocate(4096); // Auto, external
+  void* tooBig = Jaffx::mMemory.allocate(JAFFX_FAST_HEAP_SIZE + 8, Jaffx::Placement::Fast); // falls back
+  void* scoped = nullptr;
+  {
+    Jaffx::Memory::Scope scope(Jaffx::Placement::Fast, "scoped");
+    scoped = Jaffx::mMemory.allocate(5000); // fast, by the scope's placement
+    Jaffx::mMemory.record(Jaffx::Memory::Region::External, 64); // e.g. from `mArena`
+  }
+  Jaffx::mMemory.setTag(nullptr);
+
+  expect(Jaffx::mMemory.regionOf(small) == Jaffx::Memory::Region::Fast, "small allocation not fast");
+  expect(Jaffx::mMemory.regionOf(large) == Jaffx::Memory::Region::External, "large allocation not external");
+  expect(Jaffx::mMemory.regionOf(tooBig) == Jaffx::Memory::Region::External, "oversized fast allocation not external");
+  expect(Jaffx::mMemory.regionOf(scoped) == Jaffx::Memory::Region::Fast, "scope placement ignored");
+
+  expect(Jaffx::mMemory.getNumTags() == 2, "tag count");
+  const Jaffx::Memory::TagStats& s = Jaffx::mMemory.getTags()[0];
+  const Jaffx::Memory::TagStats& t = Jaffx::mMemory.getTags()[1];
+  expect(s.fastBytes == 100 && s.fastCount == 1, "fast bytes of the first tag");
+  expect(s.externalBytes == 4096 + JAFFX_FAST_HEAP_SIZE + 8 && s.externalCount == 2, "external bytes of the first tag");
+  expect(s.fallbackBytes == JAFFX_FAST_HEAP_SIZE + 8 && s.fallbackCount == 1, "fallbacks of the first tag");
+  expect(t.fastBytes == 5000 && t.fastCount == 1 && t.externalBytes == 64 && t.externalCount == 1, "counts of the scoped tag");
+  expect(Jaffx::mMemory.getFallbacks() == 1, "total fallbacks");
+
+  const Jaffx::Tlsf::Stats fast = Jaffx::mMemory.getFastHeap().getStats();
+  expect(fast.bytesInUse == Jaffx::Tlsf::usableSize(small) + Jaffx::Tlsf::usableSize(scoped), "fast heap usage");
+  expect(fast.failures == 1, "fast heap failure not counted");
+
+  int lines = 0, matches = 0;
+  Jaffx::mMemory.report(CountingPrinter{&lines, &matches, "went to SDRAM"});
+  expect(matches == 1, "fallback missing from the report");
+
+  Jaffx::mMemory.free(small);
+  Jaffx::mMemory.free(large);
+  Jaffx::mMemory.free(tooBig);
+  Jaffx::mMemory.free(scoped);
+  const Jaffx::Tlsf::Stats freed = Jaffx::mMemory.getFastHeap().getStats();
+  expect(freed.bytesInUse == 0 && freed.peakBytesInUse == fast.bytesInUse, "fast heap after freeing everything");
+  expect(Jaffx::mSDRAM.getStats().bytesInUse == 0, "SDRAM after freeing everything");
+}
+
+int main() {
+  tlsfStats();
+  placementStats();
+  std::printf("%s\n", failures ? "FAILED" : "all checks passed");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+// Exercises Jaffx::Arena (include/Arena.hpp): checkpoints, reallocation of older and
+// most recent allocations, and pointers released by a rollback, then times the bump
+// against the SDRAM allocator (include/Tlsf.hpp).
+// Usage: make bench && ./build/bench/arena
+#include "../../include/Arena.hpp"
+#include "../../include/Tlsf.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static int failures = 0;
+static void expect(bool condition, const char* what) {
+  if (!condition) {
+    failures++;
+    std::printf("FAIL: %s\n", what);
+  }
+}
+
+static void fill(void* ptr, size_t size, unsigned char value) { ::memset(ptr, value, size); }
+
+static bool holds(const void* ptr, size_t size, unsigned char value) {
+  for (size_t i = 0; i < size; i++) {
+    if (((const unsigned char*)ptr)[i] != value) { return false; }
+  }
+  return true;
+}
+
+int main() {
+  const size_t regionSize = 64 * 1024;
+  std::vector<unsigned char> region(regionSize + 3);
+  Jaffx::Arena arena;
+  expect(!arena.init(nullptr, regionSize), "init(nullptr) succeeded");
+  expect(arena.init(region.data() + 3, regionSize), "init failed"); // misaligned on purpose
+
+  // checkpoints: a rollback releases exactly what came after the mark
+  void* kept = arena.allocate(100);
+  fill(kept, 100, 0x11);
+  expect(arena.used() == 104, "allocations have a header"); // rounded up to 8 bytes, nothing more
+  const Jaffx::Arena::Checkpoint checkpoint = arena.mark();
+  const size_t usedAtMark = arena.used();
+  void* first = arena.allocate(1000);
+  void* second = arena.allocate(3);
+  expect(first && second && uintptr_t(first) % 8 == 0 && uintptr_t(second) % 8 == 0, "allocations misaligned");
+  const size_t peak = arena.peak();
+  arena.rollback(checkpoint);
+  expect(arena.used() == usedAtMark, "rollback didn't release to the mark");
+  expect(arena.peak() == peak, "rollback changed the peak");
+  expect(holds(kept, 100, 0x11), "rollback touched earlier allocations");
+  expect(arena.allocate(1000) == first, "memory after a rollback not reused");
+  arena.rollback(arena.used() + 8); // a checkpoint past the top is ignored
+  expect(arena.used() == usedAtMark + 1000, "rollback past the top changed the arena");
+
+  // a pointer released by the rollback can't be reallocated
+  arena.rollback(checkpoint);
+  expect(arena.reallocate(second, 64) == nullptr, "reallocated a pointer released by a rollback");
+
+  // the most recent allocation grows and shrinks in place
+  void* recent = arena.allocate(40);
+  expect(arena.reallocate(recent, 400) == recent, "most recent allocation not grown in place");
+  const size_t usedGrown = arena.used();
+  expect(arena.reallocate(recent, 16) == recent && arena.used() < usedGrown, "most recent allocation not shrunk in place");
+
+  // an older allocation moves, keeping what it held
+  void* older = arena.allocate(24);
+  fill(older, 24, 0x22);
+  void* newer = arena.allocate(256);
+  fill(newer, 256, 0x33);
+  void* moved = arena.reallocate(older, 200);
+  expect(moved && moved != older, "older allocation not moved");
+  expect(moved && holds(moved, 24, 0x22), "moved allocation lost its data");
+  expect(holds(newer, 256, 0x33), "moving an older allocation touched a newer one");
+  void* shrunk = arena.reallocate(newer, 8); // older than `moved` now
+  expect(shrunk && holds(shrunk, 8, 0x33), "shrinking an older allocation lost its data");
+  void* sized = arena.reallocate(older, 64, 24); // the caller knows the old size
+  expect(sized && holds(sized, 24, 0x22), "moving with a known size lost its data");
+
+  // full arena
+  arena.reset();
+  expect(arena.used() == 0, "reset didn't empty the arena");
+  void* whole = arena.allocate(arena.size());
+  expect(whole && arena.used() == arena.size(), "couldn't allocate the whole arena");
+  expect(arena.allocate(1) == nullptr && arena.reallocate(whole, arena.size() + 8) == nullptr, "allocated past the end");
+  arena.reset();
+  expect(arena.allocate(0) == nullptr, "allocate(0) returned memory");
+  expect(arena.allocateZeroed(size_t(-1) / 2, 4) == nullptr, "allocateZeroed overflow returned memory");
+  void* zeroed = arena.allocateZeroed(32, 4);
+  expect(zeroed && holds(zeroed, 128, 0), "allocateZeroed not zeroed");
+
+  // cost of building and tearing down an effect's worth of buffers
+  const int rounds = 100000, perRound = 16;
+  Jaffx::Tlsf tlsf;
+  std::vector<unsigned char> heap(regionSize);
+  tlsf.init(heap.data(), heap.size());
+  void* pointers[perRound];
+  arena.reset();
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    const Jaffx::Arena::Checkpoint mark = arena.mark();
+    for (int i = 0; i < perRound; i++) { pointers[i] = arena.allocate(64 + 32 * i); }
+    arena.rollback(mark);
+  }
+  const double arenaNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < perRound; i++) { pointers[i] = tlsf.malloc(64 + 32 * i); }
+    for (int i = 0; i < perRound; i++) { tlsf.free(pointers[i]); }
+  }
+  const double tlsfNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  std::printf("%d allocations and a release: arena %.1f ns, TLSF %.1f ns\n", perRound, arenaNs / rounds, tlsfNs / rounds);
+
+  std::printf("%s\n", failures ? "FAILED" : "all checks passed");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+// Benchmarks Jaffx::StaticChain (include/StaticChain.hpp) against the virtual
+// Jaffx::EffectsLine, for the effects of examples/main/main.cpp wired the same way.
+// Fails if their outputs differ by more than `tolerance`.
+// Usage: make bench && ./build/bench/chain [seconds]
+#include "../../Jaffx.hpp"
+#include "../../include/EffectsLine.hpp"
+#include "../../include/StaticChain.hpp"
+#include "../../examples/namTest/AmpModeler.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+static const int blockSize = 128;
+static const int sampleRate = 48000;
+// the chains run the same effects in the same order, only the dispatch differs, but
+// inlining lets the compiler contract multiply-adds (FMA) differently
+static const double tolerance = 1e-5;
+
+// The effects of main.cpp, set up the same way
+struct Effects {
+  giml::Phaser<float> phaser{sampleRate};
+  giml::AmpModeler<float> amp;
+  giml::Expander<float> expander{sampleRate};
+  giml::Chorus<float> chorus{sampleRate};
+  giml::Delay<float> delay{sampleRate};
+  giml::Compressor<float> compressor{sampleRate};
+
+  Effects() {
+    phaser.setParams();
+    phaser.enable();
+    amp.enable(); // dirty model
+    amp.loadModels();
+    expander.setParams(-50.f, 4.f, 5.f);
+    expander.enable();
+    expander.toggleSideChain(true);
+    chorus.setParams(0.2, 10.f);
+    chorus.enable();
+    delay.setParams(398.f, 0.3f, 0.7f, 0.24f);
+    delay.enable();
+    compressor.setParams(-20.f, 4.f, 10.f, 5.f, 3.5f, 100.f);
+    compressor.disable(); // off while the amp is on, as in main.cpp
+  }
+};
+
+// main.cpp's chains
+struct VirtualChain {
+  Effects& fx;
+  Jaffx::EffectsLine<float> ampChain{2}, fxChain{4};
+
+  explicit VirtualChain(Effects& fx) : fx(fx) {
+    ampChain.pushBack(&fx.phaser);
+    ampChain.pushBack(&fx.amp);
+    fxChain.pushBack(&fx.expander);
+    fxChain.pushBack(&fx.chorus);
+    fxChain.pushBack(&fx.delay);
+    fxChain.pushBack(&fx.compressor);
+  }
+
+  void processBlock(const float* in, float* out, size_t size) {
+    ampChain.processBlock(in, out, size);
+    fxChain.update();
+    for (size_t i = 0; i < size; i++) {
+      fx.expander.feedSideChain(in[i]);
+      out[i] = fxChain.processSample(out[i]);
+    }
+  }
+};
+
+// The same with `StaticChain`s
+struct FusedChain {
+  Effects& fx;
+  Jaffx::StaticChain<float, giml::Phaser<float>, giml::AmpModeler<float>> ampChain;
+  Jaffx::StaticChain<float, giml::Expander<float>, giml::Chorus<float>, giml::Delay<float>, giml::Compressor<float>> fxChain;
+
+  explicit FusedChain(Effects& fx)
+    : fx(fx), ampChain(fx.phaser, fx.amp), fxChain(fx.expander, fx.chorus, fx.delay, fx.compressor) {}
+
+  void processBlock(const float* in, float* out, size_t size) {
+    ampChain.processBlock(in, out, size);
+    for (size_t i = 0; i < size; i++) {
+      fx.expander.feedSideChain(in[i]);
+      out[i] = fxChain.processSample(out[i]);
+    }
+  }
+};
+
+// Processes `input` a block at a time, returns ns/sample
+template <typename Chain>
+static double run(Chain& chain, const std::vector<float>& input, std::vector<float>& output) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < input.size(); i += blockSize) { chain.processBlock(&input[i], &output[i], blockSize); }
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / double(input.size());
+}
+
+int main(int argc, char** argv) {
+  const double seconds = argc > 1 ? std::atof(argv[1]) : 10.0;
+  const size_t length = (size_t(seconds * sampleRate) / blockSize) * blockSize;
+  std::vector<float> input(length), expected(length), actual(length);
+  uint32_t seed = 1;
+  for (size_t i = 0; i < length; i++) {
+    const float t = float(i % sampleRate) / sampleRate;
+    seed = seed * 1664525u + 1013904223u;
+    input[i] = 0.5f * std::exp(-4.f * t) * std::sin(2.f * float(M_PI) * 110.f * t) + 0.01f * float(int32_t(seed)) / 2147483648.f;
+  }
+
+  // the effects allocate through giml::malloc, as in `Firmware::start()`
+  Jaffx::mSDRAM.init();
+  Jaffx::mMemory.init();
+
+  // separate effects for each, so both start from the same state
+  std::unique_ptr<Effects> virtualEffects(new Effects), fusedEffects(new Effects);
+  VirtualChain virtualChain(*virtualEffects);
+  FusedChain fusedChain(*fusedEffects);
+  const double virtualNs = run(virtualChain, input, expected);
+  const double fusedNs = run(fusedChain, input, actual);
+
+  double maxError = 0.0;
+  for (size_t i = 0; i < length; i++) { maxError = std::fmax(maxError, std::fabs(double(actual[i]) - expected[i])); }
+
+  // the per-sample fx chains alone, without the amp which dominates the cost
+  const auto fxOnly = [&](Effects& fx, auto& chain) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < length; i++) {
+      fx.expander.feedSideChain(input[i]);
+      actual[i] = chain.processSample(input[i]);
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / double(length);
+  };
+  const double virtualFxNs = fxOnly(*virtualEffects, virtualChain.fxChain);
+  const double fusedFxNs = fxOnly(*fusedEffects, fusedChain.fxChain);
+
+  const double budget = 1e9 / sampleRate;
+  std::printf("%zu samples, block size %d, main.cpp lineup\n", length, blockSize);
+  std::printf("  virtual EffectsLine: %8.2f ns/sample (%5.2f%% of real time)\n", virtualNs, 100.0 * virtualNs / budget);
+  std::printf("  StaticChain:         %8.2f ns/sample (%5.2f%% of real time)\n", fusedNs, 100.0 * fusedNs / budget);
+  std::printf("  max abs difference:  %g\n", maxError);
+  std::printf("expander, chorus, delay and compressor only:\n");
+  std::printf("  virtual EffectsLine: %8.2f ns/sample\n", virtualFxNs);
+  std::printf("  StaticChain:         %8.2f ns/sample\n", fusedFxNs);
+  const bool passed = maxError <= tolerance; // NaN fails too
+  std::printf("%s\n", passed ? "all checks passed" : "FAILED: StaticChain and EffectsLine outputs differ");
+  return passed ? 0 : 1;
+}
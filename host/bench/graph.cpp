@@ -0,0 +1,154 @@
+// Checks the schedules of Jaffx::Graph (include/Graph.hpp) against the same routing
+// written by hand: duplicate edges, fan-in, splits, feedback sends, aliased input and
+// output, and how many scratch buffers each graph needs.
+// Usage: make bench && ./build/bench/graph
+#include "../../Jaffx.hpp"
+#include "../../include/Graph.hpp"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static int failures = 0;
+static void expect(bool condition, const char* what) {
+  if (!condition) {
+    failures++;
+    std::printf("FAIL: %s\n", what);
+  }
+}
+
+struct Gain : giml::Effect<float> {
+  float gain;
+  explicit Gain(float gain) : gain(gain) { this->enable(); }
+  float processSample(const float& in) override { return in * this->gain; }
+};
+
+struct Delay : Jaffx::BlockEffect<float> {
+  std::vector<float> line;
+  size_t index = 0;
+  explicit Delay(size_t length) : line(length, 0.f) { this->enable(); }
+  float processSample(const float& in) override {
+    const float out = this->line[this->index];
+    this->line[this->index] = in;
+    this->index = (this->index + 1) % this->line.size();
+    return out;
+  }
+};
+
+static const size_t length = 1000, block = 100;
+
+static std::vector<float> makeInput() {
+  std::vector<float> input(length);
+  for (size_t i = 0; i < length; i++) { input[i] = std::sin(0.1f * float(i)) + 0.1f * float(i % 7); }
+  return input;
+}
+
+// Runs `graph` over `input` a block at a time, in place if `aliased`
+template <size_t MaxBlock>
+static std::vector<float> render(Jaffx::Graph<float, MaxBlock>& graph, const std::vector<float>& input, bool aliased) {
+  std::vector<float> out = input;
+  for (size_t i = 0; i < length; i += block) { graph.processBlock(aliased ? &out[i] : &input[i], &out[i], block); }
+  return out;
+}
+
+template <typename Expected>
+static void check(const std::vector<float>& out, Expected expected, const char* what) {
+  float maxError = 0.f;
+  for (size_t i = 0; i < length; i++) { maxError = std::fmax(maxError, std::fabs(out[i] - expected(i))); }
+  if (maxError > 1e-5f) { std::printf("%s: max error %g\n", what, maxError); }
+  expect(maxError <= 1e-5f, what);
+}
+
+int main() {
+  const std::vector<float> input = makeInput();
+
+  // two edges from one node into a mix add up: 0.5 + 0.25
+  {
+    Gain gain(2.f);
+    Jaffx::Graph<float, 64> graph;
+    const int node = graph.addEffect(&gain), mix = graph.addMix();
+    graph.connect(graph.input(), node);
+    graph.connect(node, mix, 0.5f);
+    graph.connect(node, mix, 0.25f);
+    graph.connect(mix, graph.output());
+    expect(graph.compile(), "duplicate edges didn't compile");
+    check(render(graph, input, false), [&](size_t i) { return 1.5f * input[i]; }, "duplicate edges");
+  }
+
+  // duplicate edges from the input, with the output overwriting it
+  {
+    Jaffx::Graph<float, 64> graph;
+    graph.connect(graph.input(), graph.output(), 0.5f);
+    graph.connect(graph.input(), graph.output(), 0.25f);
+    expect(graph.compile(), "duplicate input edges didn't compile");
+    check(render(graph, input, true), [&](size_t i) { return 0.75f * input[i]; }, "duplicate input edges, aliased");
+  }
+
+  // fan-in: a split into three delays, mixed back together with the dry signal,
+  // and one delay also feeding a later node (so its buffer isn't free at the mix)
+  for (int aliased = 0; aliased < 2; aliased++) {
+    Gain gain(2.f), post(-1.f);
+    Delay delay1(37), delay2(91), delay3(5), reference1(37), reference2(91), reference3(5);
+    Jaffx::Graph<float, 64> graph;
+    const int amp = graph.addEffect(&gain), post1 = graph.addEffect(&post);
+    const int d1 = graph.addEffect(&delay1), d2 = graph.addEffect(&delay2), d3 = graph.addEffect(&delay3);
+    const int mix = graph.addMix();
+    graph.connect(graph.input(), amp);
+    graph.connect(amp, d1);
+    graph.connect(amp, d2);
+    graph.connect(amp, d3);
+    graph.connect(d1, mix, 0.5f);
+    graph.connect(d2, mix, 0.25f);
+    graph.connect(d2, mix, 0.25f);
+    graph.connect(d3, mix, 0.125f);
+    graph.connect(mix, post1);
+    graph.connect(d1, post1, 0.5f);
+    graph.connect(post1, graph.output());
+    graph.connect(graph.input(), graph.output(), 0.25f);
+    expect(graph.compile(), "fan-in didn't compile");
+    const std::vector<float> out = render(graph, input, aliased != 0);
+    std::vector<float> expected(length);
+    for (size_t i = 0; i < length; i++) {
+      const float x = 2.f * input[i];
+      const float y1 = reference1.processSample(x), y2 = reference2.processSample(x), y3 = reference3.processSample(x);
+      expected[i] = -(0.5f * y1 + 0.5f * y2 + 0.125f * y3 + 0.5f * y1) + 0.25f * input[i];
+    }
+    check(out, [&](size_t i) { return expected[i]; }, aliased ? "fan-in, aliased" : "fan-in");
+  }
+
+  // a serial chain runs in one buffer
+  {
+    Gain gain1(1.f), gain2(2.f), gain3(3.f);
+    Jaffx::Graph<float> graph;
+    const int n1 = graph.addEffect(&gain1), n2 = graph.addEffect(&gain2), n3 = graph.addEffect(&gain3);
+    graph.connect(graph.input(), n1);
+    graph.connect(n1, n2);
+    graph.connect(n2, n3);
+    graph.connect(n3, graph.output());
+    expect(graph.compile() && graph.getNumBuffers() == 1, "serial chain needs more than one buffer");
+    check(render(graph, input, true), [&](size_t i) { return 6.f * input[i]; }, "serial chain");
+  }
+
+  // feedback arrives a block later, connect() loops are rejected
+  {
+    Jaffx::Graph<float, 16> graph;
+    const int mix = graph.addMix();
+    graph.connect(graph.input(), mix);
+    graph.connect(mix, graph.output());
+    expect(graph.connectFeedback(mix, mix, 0.5f), "feedback edge rejected");
+    expect(graph.compile(), "feedback loop didn't compile");
+    float impulse[64] = {1.f}, out[64];
+    for (int i = 0; i < 64; i += 16) { graph.processBlock(impulse + i, out + i, 16); }
+    expect(out[0] == 1.f && out[16] == 0.5f && out[32] == 0.25f && out[48] == 0.125f, "feedback");
+
+    Jaffx::Graph<float> loop;
+    const int p = loop.addMix(), q = loop.addMix();
+    loop.connect(loop.input(), p);
+    loop.connect(p, q);
+    loop.connect(q, p);
+    loop.connect(q, loop.output());
+    expect(!loop.compile(), "a connect() loop compiled");
+  }
+
+  std::printf("%s\n", failures ? "FAILED" : "all checks passed");
+  return failures ? 1 : 0;
+}
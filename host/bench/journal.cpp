@@ -0,0 +1,209 @@
+// Exercises Jaffx::PresetJournal (include/PresetJournal.hpp) on a simulated NOR flash:
+// flash wear against rewriting a sector per save, and recovery from power loss
+// injected at every step of saving and compaction, and the errors it reports.
+// Usage: make bench && ./build/bench/journal [saves]
+#include "../../Jaffx.hpp"
+#include "../../include/PresetJournal.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// main.cpp's settings
+struct Settings {
+  bool toggles[5] = { false, false, false, false, false };
+  float params[5][3] = {};
+};
+
+static bool operator==(const Settings& a, const Settings& b) { return ::memcmp(&a, &b, sizeof(Settings)) == 0; }
+
+static uint32_t seed = 1;
+static uint32_t nextRandom(uint32_t range) {
+  seed = seed * 1664525u + 1013904223u;
+  return (seed >> 8) % range;
+}
+
+/**
+ * @brief NOR flash in RAM, that can lose power in the middle of an operation
+ *
+ * Erasing sets bytes to 0xFF, programming can only clear bits. An interrupted
+ * operation only affects some of its bytes, every operation after it fails
+ * until `powerOn()`.
+ */
+class SimulatedFlash {
+public:
+  SimulatedFlash(size_t sectorSize, size_t numSectors)
+    : size(sectorSize), memory(sectorSize * numSectors, 0xFF), erases(numSectors, 0) {}
+
+  size_t sectorSize() const { return this->size; }
+  size_t numSectors() const { return this->erases.size(); }
+
+  void read(size_t address, void* data, size_t size) { ::memcpy(data, &this->memory[address], size); }
+
+  bool erase(size_t sector) {
+    const size_t length = this->interrupted() ? nextRandom(this->size) : this->size;
+    if (this->off && length == this->size) { return false; }
+    ::memset(&this->memory[sector * this->size], 0xFF, length);
+    this->erases[sector]++;
+    return length == this->size;
+  }
+
+  bool program(size_t address, const void* data, size_t size) {
+    const size_t length = this->interrupted() ? nextRandom(size) : size;
+    if (this->off && length == size) { return false; }
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) { this->memory[address + i] &= bytes[i]; }
+    this->programmed += length;
+    return length == size;
+  }
+
+  // loses power during the operation after the next `operations`
+  void failAfter(int operations) { this->countdown = operations; }
+
+  void powerOn() {
+    this->off = false;
+    this->countdown = -1;
+  }
+
+  bool isOff() const { return this->off; }
+
+  size_t size;
+  std::vector<uint8_t> memory;
+  std::vector<uint32_t> erases;
+  size_t programmed = 0;
+
+private:
+  int countdown = -1;
+  bool off = false;
+
+  bool interrupted() {
+    if (this->off || this->countdown < 0) { return false; }
+    if (this->countdown-- > 0) { return false; }
+    this->off = true;
+    return true;
+  }
+};
+
+using Journal = Jaffx::PresetJournal<Settings, SimulatedFlash>;
+
+// an edit from the UI: a toggle, or a parameter nudged by an encoder
+static void edit(Settings& settings) {
+  const uint32_t effect = nextRandom(5);
+  if (nextRandom(4) == 0) { settings.toggles[effect] = !settings.toggles[effect]; }
+  else { settings.params[effect][nextRandom(3)] = float(nextRandom(21)) * 0.05f; }
+}
+
+int main(int argc, char** argv) {
+  const int saves = argc > 1 ? std::atoi(argv[1]) : 10000;
+  const size_t sectorSize = 4096, numSectors = 16;
+  int failures = 0;
+
+  // wear, against rewriting a sector per save (like PersistentStorage)
+  {
+    SimulatedFlash flash(sectorSize, numSectors);
+    Journal journal(flash);
+    Settings settings;
+    journal.mount(settings);
+    for (int i = 0; i < saves; i++) {
+      edit(settings);
+      journal.save(settings);
+      while (journal.service()) {}
+    }
+    Journal reboot(flash);
+    Settings loaded;
+    if (!reboot.mount(loaded) || !(loaded == settings)) {
+      std::printf("wear: remounted state differs\n");
+      failures++;
+    }
+    uint32_t total = 0, least = flash.erases[0], most = 0;
+    for (uint32_t erases : flash.erases) {
+      total += erases;
+      least = erases < least ? erases : least;
+      most = erases > most ? erases : most;
+    }
+    std::printf("%d saves of a %zu byte struct, %zu sectors of %zu bytes:\n", saves, sizeof(Settings), numSectors, sectorSize);
+    std::printf("  journal: %u erases (%.2f per 1000 saves), %.1f bytes written per save\n", total,
+                1000.0 * total / saves, double(flash.programmed) / saves);
+    std::printf("  per sector: %u to %u erases\n", least, most);
+    std::printf("  sector per save: %d erases of the same sector\n", saves);
+  }
+
+  // power loss at every step
+  {
+    SimulatedFlash flash(sectorSize, 4);
+    Settings saved; // last state known to be saved
+    int trials = 0, newer = 0;
+    for (int i = 0; i < saves; i++) {
+      Journal journal(flash);
+      Settings settings;
+      journal.mount(settings);
+      if (!(settings == saved)) {
+        std::printf("power loss: trial %d mounted a state that was never saved\n", i);
+        failures++;
+        saved = settings;
+      }
+
+      Settings edited = saved;
+      edit(edited);
+      journal.save(edited);
+      flash.failAfter(int(nextRandom(4)));
+      while (journal.service() && !flash.isOff()) {}
+      flash.powerOn();
+
+      // either state is fine, check which one survived
+      Journal check(flash);
+      Settings loaded;
+      check.mount(loaded);
+      if (loaded == edited) {
+        newer++;
+        saved = edited;
+      }
+      else if (!(loaded == saved)) {
+        std::printf("power loss: trial %d lost both states\n", i);
+        failures++;
+        saved = loaded;
+      }
+      trials++;
+    }
+    std::printf("power loss during %d saves: %d kept the new state, %d the previous one, %d failures\n", trials, newer,
+                trials - newer, failures);
+  }
+
+  // a failed write is reported until a retry succeeds
+  {
+    SimulatedFlash flash(sectorSize, 4);
+    Journal journal(flash);
+    Settings settings;
+    journal.mount(settings);
+    edit(settings);
+    journal.save(settings);
+    flash.failAfter(0);
+    journal.service();
+    const bool reported = journal.getError() == Journal::Error::Write;
+    flash.powerOn();
+    while (journal.service()) {}
+    Journal reboot(flash);
+    Settings loaded;
+    if (!reported || journal.getError() != Journal::Error::None || !reboot.mount(loaded) || !(loaded == settings)) {
+      std::printf("errors: a retried write wasn't reported, cleared or saved\n");
+      failures++;
+    }
+  }
+
+  // a single sector is refused, compacting would erase the only copy
+  {
+    SimulatedFlash flash(sectorSize, 1);
+    Journal journal(flash);
+    Settings settings;
+    journal.mount(settings);
+    edit(settings);
+    journal.save(settings);
+    while (journal.service()) {}
+    if (journal.getError() != Journal::Error::TooFewSectors || flash.erases[0] != 0 || flash.programmed != 0) {
+      std::printf("errors: a single sector journal wrote to flash\n");
+      failures++;
+    }
+  }
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+// Round trip of the `.jnam` model format: converts AmpModeler's models with
+// `examples/namTest/namToBinary.py`, loads them with `Jaffx::ModelFile::parse()` and
+// `read()` (include/ModelFile.hpp), compares them with the compiled-in weights of
+// DumbleModel.h and MarshallModel.h, and checks that damaged files are rejected.
+// Usage: make bench && ./build/bench/modelfile [namTest directory]
+//        (run from host/, needs python3, writes the .jnam files next to the executable)
+#include "../../Jaffx.hpp"
+#include "../../examples/namTest/AmpModeler.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+static void expect(bool condition, const char* what) {
+  if (!condition) {
+    failures++;
+    std::printf("FAIL: %s\n", what);
+  }
+}
+
+// `ModelFile::read()` adapter for bytes in memory
+struct MemoryReader {
+  const unsigned char* data;
+  size_t size, position;
+  size_t read(void* dst, size_t bytes) {
+    if (bytes > this->size - this->position) { bytes = this->size - this->position; }
+    ::memcpy(dst, this->data + this->position, bytes);
+    this->position += bytes;
+    return bytes;
+  }
+};
+
+// Same layer arrays as the amp models, in the wrong order
+struct SwappedModel {
+  typedef AmpLayerArray2 LayerArray1;
+  typedef AmpLayerArray1 LayerArray2;
+  static constexpr int numWeights() { return BlockAmpModel::numWeights(); }
+};
+
+// Converts `<directory>/<name>.nam` to `<output>/<name>.jnam`, returns its bytes (4-byte aligned)
+static std::vector<uint32_t> convert(const std::string& directory, const std::string& output, const char* name,
+                                     bool calibrate, size_t& size) {
+  const std::string nam = output + "/" + name + ".nam", jnam = output + "/" + name + ".jnam";
+  const std::string command = "cp '" + directory + "/" + name + ".nam' '" + nam + "' && python3 '" + directory +
+                              "/namToBinary.py' --verify " + (calibrate ? "--calibrate '" : "'") + nam + "' > /dev/null";
+  size = 0;
+  if (std::system(command.c_str()) != 0) { return {}; }
+  FILE* file = std::fopen(jnam.c_str(), "rb");
+  if (!file) { return {}; }
+  std::fseek(file, 0, SEEK_END);
+  size = size_t(std::ftell(file));
+  std::fseek(file, 0, SEEK_SET);
+  std::vector<uint32_t> data((size + 3) / 4);
+  if (std::fread(data.data(), 1, size, file) != size) { size = 0; }
+  std::fclose(file);
+  return data;
+}
+
+static void check(const std::string& directory, const std::string& output, const char* name, const float* weights,
+                  size_t count, const signed char* residualBits, size_t numResidualBits) {
+  std::printf("%s:\n", name);
+  size_t size;
+  std::vector<uint32_t> data = convert(directory, output, name, residualBits != nullptr, size);
+  expect(size > 0, "namToBinary.py failed");
+  if (size == 0) { return; }
+  const unsigned char* bytes = (const unsigned char*)data.data();
+
+  // in place
+  Jaffx::ModelFile file;
+  expect(file.parse(bytes, size), "parse() rejected the model");
+  expect(file.numWeights() == count && ::memcmp(file.weights(), weights, count * sizeof(float)) == 0,
+         "parse() weights differ from the compiled-in ones");
+  expect(file.weights() == (const float*)(bytes + size - count * sizeof(float)), "parse() copied the weights");
+  expect(file.sampleRate() == 48000, "sample rate");
+  if (residualBits) {
+    expect(file.calibration() && ::memcmp(file.calibration(), residualBits, numResidualBits) == 0,
+           "calibration differs from the compiled-in one");
+  }
+  else { expect(file.calibration() == nullptr, "uncalibrated model has a calibration"); }
+  expect(file.matches<AmpModel>() && file.matches<BlockAmpModel>(), "architecture doesn't match AmpModel");
+  expect(!file.matches<SwappedModel>(), "matched the wrong architecture");
+
+  // streamed from the file
+  std::vector<float> buffer(count);
+  const std::string jnam = output + "/" + name + ".jnam";
+  FILE* stream = std::fopen(jnam.c_str(), "rb");
+  Jaffx::StdioReader reader{stream};
+  Jaffx::ModelFile streamed;
+  expect(stream && streamed.read(reader, buffer.data(), buffer.size()), "read() rejected the model");
+  if (stream) { std::fclose(stream); }
+  expect(streamed.weights() == buffer.data() && ::memcmp(buffer.data(), weights, count * sizeof(float)) == 0,
+         "read() weights differ from the compiled-in ones");
+  expect(streamed.matches<AmpModel>(), "streamed architecture doesn't match AmpModel");
+  MemoryReader small{bytes, size, 0};
+  expect(!streamed.read(small, buffer.data(), count - 1) && streamed.getError() == Jaffx::ModelFile::Error::TooLarge,
+         "read() overflowed the buffer");
+  expect(streamed.weights() == nullptr && !streamed.matches<AmpModel>(), "a failed read() left weights");
+
+  // truncated anywhere: in the header, the array infos, or the weights
+  const size_t cuts[] = {10, 30, size - count * sizeof(float) - 1, size - 1};
+  for (size_t cut : cuts) {
+    Jaffx::ModelFile truncated;
+    expect(!truncated.parse(bytes, cut) && truncated.getError() == Jaffx::ModelFile::Error::Truncated,
+           "parse() accepted a truncated model");
+    MemoryReader partial{bytes, cut, 0};
+    expect(!truncated.read(partial, buffer.data(), buffer.size()) &&
+               truncated.getError() == Jaffx::ModelFile::Error::Truncated,
+           "read() accepted a truncated model");
+  }
+
+  // a flipped bit in the weights
+  std::vector<uint32_t> corrupted = data;
+  ((unsigned char*)corrupted.data())[size - 7] ^= 0x10;
+  Jaffx::ModelFile damaged;
+  expect(!damaged.parse(corrupted.data(), size) && damaged.getError() == Jaffx::ModelFile::Error::BadChecksum,
+         "parse() accepted a corrupted model");
+  MemoryReader corruptedReader{(const unsigned char*)corrupted.data(), size, 0};
+  expect(!damaged.read(corruptedReader, buffer.data(), buffer.size()) &&
+             damaged.getError() == Jaffx::ModelFile::Error::BadChecksum,
+         "read() accepted a corrupted model");
+
+  // and in the magic
+  std::vector<uint32_t> foreign = data;
+  foreign[0] ^= 1;
+  expect(!damaged.parse(foreign.data(), size) && damaged.getError() == Jaffx::ModelFile::Error::BadMagic,
+         "parse() accepted a bad magic");
+
+  std::printf("  %zu bytes, %zu weights, %s\n", size, count, residualBits ? "calibrated" : "uncalibrated");
+}
+
+int main(int argc, char** argv) {
+  const std::string directory = argc > 1 ? argv[1] : "../examples/namTest";
+  std::string output = argv[0];
+  output = output.find('/') == std::string::npos ? "." : output.substr(0, output.rfind('/'));
+
+  // one model version 2 (with calibration), one version 1
+  check(directory, output, "DumbleModel", DumbleModel_weights, DumbleModel_weights_len, DumbleModel_residual_bits,
+        DumbleModel_residual_bits_len);
+  check(directory, output, "MarshallModel", MarshallModel_weights, MarshallModel_weights_len, nullptr, 0);
+
+  std::printf("%s\n", failures ? "FAILED" : "all checks passed");
+  return failures ? 1 : 0;
+}
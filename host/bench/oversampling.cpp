@@ -0,0 +1,107 @@
+// Benchmarks Jaffx::Oversampled (include/Oversampler.hpp) hosting a waveshaper at
+// 1x, 2x and 4x, and measures how much each factor suppresses aliasing.
+// Usage: make bench && ./build/bench/oversampling [seconds]
+#include "../../Jaffx.hpp"
+#include "../../include/Oversampler.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+static const int blockSize = 128;
+static const int sampleRate = 48000;
+
+// Hard-driven tanh saturation, rich in harmonics
+class Waveshaper : public giml::Effect<float> {
+public:
+  Waveshaper() { this->enable(); }
+  float processSample(const float& input) override {
+    if (!this->enabled) { return input; }
+    return std::tanh(8.f * input);
+  }
+};
+
+// Processes `input` a block at a time, returns ns/sample
+static double run(Jaffx::BlockEffect<float>& effect, const std::vector<float>& input, std::vector<float>& output) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < input.size(); i += blockSize) { effect.processBlock(&input[i], &output[i], blockSize); }
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / double(input.size());
+}
+
+// Power of `signal` at DFT bin `bin` (a sine's amplitude squared over 2), `cosine` is one period of `length`
+static double binPower(const float* signal, const std::vector<double>& cosine, size_t bin) {
+  const size_t length = cosine.size();
+  double re = 0.0, im = 0.0;
+  for (size_t i = 0, phase = 0; i < length; i++, phase = (phase + bin) % length) {
+    re += signal[i] * cosine[phase];
+    im -= signal[i] * cosine[(phase + 3 * length / 4) % length];
+  }
+  return 2.0 * (re * re + im * im) / (double(length) * double(length));
+}
+
+// Ratio in dB of the audible (below 20kHz) inharmonic power of `output` to the
+// power of its harmonics, for a sine exactly on DFT bin `bin` of `length`.
+// Aliases above 20kHz are left out, they fold from the filters' transition band.
+static double aliasing(const float* output, size_t length, size_t bin) {
+  std::vector<double> cosine(length);
+  for (size_t i = 0; i < length; i++) { cosine[i] = std::cos(2.0 * M_PI * double(i) / double(length)); }
+  double aliases = 0.0, harmonics = 0.0;
+  for (size_t k = 1; k < length * 20000 / sampleRate; k++) {
+    (k % bin ? aliases : harmonics) += binPower(output, cosine, k);
+  }
+  return 10.0 * std::log10(std::fmax(aliases, 1e-30) / harmonics);
+}
+
+// Runs a sine through `effect` until its filters settle, returns its aliasing in dB
+static double measure(Jaffx::BlockEffect<float>& effect, size_t bin) {
+  const size_t length = 8192, settle = 4 * blockSize;
+  std::vector<float> input(settle + length), output(settle + length);
+  for (size_t i = 0; i < input.size(); i++) {
+    input[i] = 0.5f * float(std::sin(2.0 * M_PI * double(bin) * double(i) / double(length)));
+  }
+  run(effect, input, output);
+  return aliasing(&output[settle], length, bin);
+}
+
+int main(int argc, char** argv) {
+  const double seconds = argc > 1 ? std::atof(argv[1]) : 10.0;
+  const size_t length = (size_t(seconds * sampleRate) / blockSize) * blockSize;
+  std::vector<float> input(length), output(length);
+  uint32_t seed = 1;
+  for (size_t i = 0; i < length; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    input[i] = 0.5f * float(int32_t(seed)) / 2147483648.f;
+  }
+
+  Waveshaper shaper1, shaper2, shaper4;
+  // 1x: the waveshaper alone
+  struct Direct : Jaffx::BlockEffect<float> {
+    giml::Effect<float>* effect;
+    float processSample(const float& input) override { return this->effect->processSample(input); }
+  } direct;
+  direct.effect = &shaper1;
+  Jaffx::Oversampled<float, 2> oversampled2{shaper2};
+  Jaffx::Oversampled<float, 4> oversampled4{shaper4};
+
+  const double budget = 1e9 / sampleRate;
+  std::printf("%zu samples, block size %d, tanh waveshaper\n", length, blockSize);
+  std::printf("factor  ns/sample  real time  latency  aliasing at 5kHz  at 11kHz (below 20kHz)\n");
+  const size_t bins[] = {853, 1877}; // 4998Hz and 10998Hz with 8192 points at 48kHz
+  double aliasing[3][2];
+  Jaffx::BlockEffect<float>* effects[] = {&direct, &oversampled2, &oversampled4};
+  const int factors[] = {1, 2, 4}, latencies[] = {0, oversampled2.latency(), oversampled4.latency()};
+  for (int f = 0; f < 3; f++) {
+    const double ns = run(*effects[f], input, output);
+    for (int b = 0; b < 2; b++) { aliasing[f][b] = measure(*effects[f], bins[b]); }
+    std::printf("%6d  %9.2f  %8.2f%%  %7d  %13.1f dB  %5.1f dB\n", factors[f], ns, 100.0 * ns / budget, latencies[f],
+                aliasing[f][0], aliasing[f][1]);
+  }
+
+  // each factor must suppress aliasing at both frequencies
+  bool ok = true;
+  for (int b = 0; b < 2; b++) { ok = ok && aliasing[1][b] < aliasing[0][b] - 10.0 && aliasing[2][b] < aliasing[1][b]; }
+  std::printf("alias suppression: %s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+// Exercises Jaffx::Pool (include/Pool.hpp): slot alignment and spacing, the intrusive
+// free list, exhaustion, and releases it must ignore, then times acquire/release pairs
+// in a small and a large pool against the SDRAM allocator (include/Tlsf.hpp).
+// Usage: make bench SANITIZE=1 && ./build/bench/pool
+//        (SANITIZE=1 builds the benchmarks with ASan and UBSan)
+#include "../../include/Pool.hpp"
+#include <chrono>
+#include <cstdio>
+
+static int failures = 0;
+static void expect(bool condition, const char* what) {
+  if (!condition) {
+    failures++;
+    std::printf("FAIL: %s\n", what);
+  }
+}
+
+// Counts constructions and destructions, and fills its slot so a stale free-list link shows
+struct Voice {
+  static int live;
+  float state[6];
+  explicit Voice(float value) {
+    for (float& s : this->state) { s = value; }
+    live++;
+  }
+  ~Voice() { live--; }
+};
+int Voice::live = 0;
+
+// Nanoseconds per acquire/release pair, cycling through every slot so a cost that grows with `N` shows
+template <size_t N>
+static double timePool(int rounds) {
+  Jaffx::Pool<Voice, N> pool;
+  pool.init();
+  Voice* voices[N];
+  double best = 1e30;
+  for (int run = 0; run < 5; run++) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+      for (size_t i = 0; i < N; i++) { voices[i] = pool.acquire(float(i)); }
+      for (size_t i = 0; i < N; i++) { pool.release(voices[i]); }
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (ns < best) { best = ns; }
+  }
+  return best / (double(rounds) * N);
+}
+
+int main() {
+  Jaffx::mSDRAM.init();
+
+  // slots: cache-line aligned and spaced, no per-object header
+  typedef Jaffx::Pool<Voice, 8, Jaffx::CACHE_LINE> Voices;
+  static_assert(Voices::SLOT_SIZE == Jaffx::CACHE_LINE, "a 24-byte object should fill one cache line");
+  static_assert(Jaffx::Pool<Voice, 8>::SLOT_SIZE == sizeof(Voice), "slots larger than the object");
+  Voices pool;
+  expect(pool.available() == 0 && pool.acquire(1.f) == nullptr, "acquired from a pool before init()");
+  expect(pool.init(), "init failed");
+  expect(pool.available() == 8 && pool.inUse() == 0, "not all slots free after init()");
+
+  // the free list hands out slots in address order, and back in LIFO order
+  Voice* voices[8];
+  for (int i = 0; i < 8; i++) {
+    voices[i] = pool.acquire(float(i));
+    expect(voices[i] && uintptr_t(voices[i]) % Jaffx::CACHE_LINE == 0, "slot not cache-line aligned");
+    expect(voices[i] && pool.owns(voices[i]), "pool doesn't own its slot");
+    expect(i == 0 || (unsigned char*)voices[i] - (unsigned char*)voices[i - 1] == Voices::SLOT_SIZE,
+           "slots not handed out in address order");
+  }
+  expect(Voice::live == 8 && voices[3]->state[5] == 3.f, "objects not constructed in place");
+
+  // exhaustion
+  expect(pool.acquire(9.f) == nullptr && pool.inUse() == 8 && pool.available() == 0, "acquired from a full pool");
+  expect(Voice::live == 8, "a failed acquire() constructed an object");
+
+  pool.release(voices[2]);
+  pool.release(voices[5]);
+  expect(Voice::live == 6 && pool.inUse() == 6, "release() didn't destroy the object");
+  Voice* reused = pool.acquire(10.f);
+  expect(reused == voices[5], "free list isn't LIFO");
+  expect(pool.acquire(11.f) == voices[2], "free list lost a released slot");
+  expect(voices[3]->state[0] == 3.f && voices[4]->state[5] == 4.f, "acquire/release touched a neighbour");
+
+  // releases the pool must ignore: twice, a pointer into the middle of a slot, another pool's object, nullptr
+  pool.release(voices[7]);
+  pool.release(voices[7]);
+  expect(Voice::live == 7 && pool.inUse() == 7, "double release counted twice");
+  Voice* again = pool.acquire(12.f);
+  expect(again == voices[7] && pool.acquire(13.f) == nullptr, "double release linked the slot twice");
+  pool.release((Voice*)((unsigned char*)voices[1] + 4));
+  Jaffx::Pool<Voice, 2> other;
+  other.init();
+  Voice* foreign = other.acquire(0.f);
+  pool.release(foreign);
+  pool.release(nullptr);
+  expect(pool.inUse() == 8 && Voice::live == 9, "released an object the pool doesn't own");
+  expect(!pool.owns(foreign) && other.owns(foreign), "owns() of another pool's object");
+  other.release(foreign);
+
+  // everything back, then deinit() returns the block
+  for (int i = 0; i < 8; i++) { pool.release(voices[i]); }
+  expect(pool.inUse() == 0 && pool.available() == 8 && Voice::live == 0, "not empty after releasing everything");
+  other.deinit();
+  pool.deinit();
+  expect(Jaffx::mSDRAM.getStats().bytesInUse == 0, "deinit() didn't return the block");
+  expect(pool.acquire(1.f) == nullptr && pool.available() == 0, "acquired after deinit()");
+
+  // O(1): the cost per pair doesn't grow with the pool
+  const double small = timePool<16>(20000), large = timePool<4096>(80);
+  void* pointers[16];
+  double tlsf = 1e30;
+  for (int run = 0; run < 5; run++) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < 20000; r++) {
+      for (int i = 0; i < 16; i++) { pointers[i] = Jaffx::mSDRAM.malloc(sizeof(Voice)); }
+      for (int i = 0; i < 16; i++) { Jaffx::mSDRAM.free(pointers[i]); }
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (ns < tlsf) { tlsf = ns; }
+  }
+  std::printf("acquire/release: %.1f ns with 16 slots, %.1f ns with 4096, TLSF malloc/free %.1f ns\n", small, large,
+              tlsf / (20000.0 * 16));
+  expect(large < 4 * small + 1, "acquire/release cost grows with the pool");
+
+  std::printf("%s\n", failures ? "FAILED" : "all checks passed");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,91 @@
+// Benchmarks the fixed-point NAM WaveNet (include/QuantizedWavenet.hpp) against the
+// float one (include/Wavenet.hpp), and reports its error for each AmpModeler model.
+// Usage: make bench && ./build/bench/quantized [seconds]
+#include "../../Jaffx.hpp"
+#include "../../examples/namTest/AmpModeler.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+static const int blockSize = 128;
+static const int sampleRate = 48000;
+
+// guitar-ish test signal: decaying plucks over a little noise
+static std::vector<float> makeSignal(size_t length) {
+  std::vector<float> signal(length);
+  uint32_t seed = 1;
+  for (size_t i = 0; i < length; i++) {
+    const float t = float(i % sampleRate) / sampleRate;
+    seed = seed * 1664525u + 1013904223u;
+    const float noise = float(int32_t(seed)) / 2147483648.f;
+    signal[i] = 0.5f * std::exp(-4.f * t) * std::sin(2.f * float(M_PI) * 110.f * t) + 0.01f * noise;
+  }
+  return signal;
+}
+
+// Processes `input` a block at a time, returns ns/sample
+template <typename Model>
+static double run(Model& model, const std::vector<float>& input, std::vector<float>& output) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < input.size(); i += blockSize) { model.process(&input[i], &output[i], blockSize); }
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / double(input.size());
+}
+
+// Returns the number of mismatches between per-sample and block processing of `model`
+static size_t compare(const char* name, const float* weights, size_t count, const signed char* calibration,
+                      const std::vector<float>& input) {
+  const size_t length = input.size();
+  std::vector<float> expected(length), actual(length), perSample(length);
+  std::unique_ptr<BlockAmpModel> model(new BlockAmpModel);
+  std::unique_ptr<QuantizedAmpModel> quantized(new QuantizedAmpModel);
+  model->loadModel(weights, count);
+  quantized->loadModel(weights, count, calibration);
+
+  const double floatNs = run(*model, input, expected);
+  const double fixedNs = run(*quantized, input, actual);
+
+  double signalPower = 0.0, errorPower = 0.0, maxError = 0.0;
+  for (size_t i = 0; i < length; i++) {
+    const double error = double(actual[i]) - double(expected[i]);
+    signalPower += double(expected[i]) * expected[i];
+    errorPower += error * error;
+    maxError = std::fmax(maxError, std::fabs(error));
+  }
+
+  quantized->loadModel(weights, count, calibration);
+  size_t mismatches = 0;
+  for (size_t i = 0; i < length; i++) { mismatches += (quantized->forward(input[i]) != actual[i]); }
+
+  // and without calibration, for comparison
+  quantized->loadModel(weights, count, nullptr);
+  run(*quantized, input, perSample);
+  double uncalibratedPower = 0.0;
+  for (size_t i = 0; i < length; i++) {
+    const double error = double(perSample[i]) - double(expected[i]);
+    uncalibratedPower += error * error;
+  }
+
+  const double budget = 1e9 / sampleRate;
+  std::printf("%s:\n", name);
+  std::printf("  float:     %8.2f ns/sample (%5.2f%% of real time), %zu bytes\n", floatNs, 100.0 * floatNs / budget, sizeof(BlockAmpModel));
+  std::printf("  quantized: %8.2f ns/sample (%5.2f%% of real time), %zu bytes\n", fixedNs, 100.0 * fixedNs / budget, sizeof(QuantizedAmpModel));
+  std::printf("  error vs float: SNR %.1f dB, max abs %g (uncalibrated: SNR %.1f dB)\n",
+              10.0 * std::log10(signalPower / errorPower), maxError, 10.0 * std::log10(signalPower / uncalibratedPower));
+  std::printf("  block vs sample: %zu mismatched samples\n", mismatches);
+  return mismatches;
+}
+
+int main(int argc, char** argv) {
+  const double seconds = argc > 1 ? std::atof(argv[1]) : 10.0;
+  const size_t length = (size_t(seconds * sampleRate) / blockSize) * blockSize;
+  const std::vector<float> input = makeSignal(length);
+
+  std::printf("%zu samples, block size %d\n", length, blockSize);
+  size_t mismatches = compare("dumble", DumbleModel_weights, DumbleModel_weights_len, DumbleModel_residual_bits, input);
+  mismatches += compare("marshall", MarshallModel_weights, MarshallModel_weights_len, MarshallModel_residual_bits, input);
+  return mismatches ? 1 : 0;
+}
@@ -0,0 +1,212 @@
+// Randomized stress test of the TLSF allocator (include/Tlsf.hpp): checks the block,
+// free-list and bitmap invariants and the contents of every live allocation while
+// mixing malloc, calloc, realloc and free, then times malloc/free pairs.
+// Usage: make bench SANITIZE=1 && ./build/bench/tlsf [operations] [seed]
+//        (SANITIZE=1 builds the benchmarks with ASan and UBSan)
+#include "../../include/Tlsf.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Exposes the allocator's internals to check them
+class CheckedTlsf : public Jaffx::Tlsf {
+public:
+  // Returns nullptr if every invariant holds, or what broke
+  const char* check() const {
+    if (!this->pMemory) { return "not initialized"; }
+    // physical walk: linked both ways, sizes aligned, free neighbours merged, counters right
+    size_t used = 0, usedBytes = 0, free = 0;
+    const Block* prev = nullptr;
+    Block* b = this->firstBlock();
+    for (; !isSentinel(b); b = nextPhys(b)) {
+      if ((unsigned char*)b < this->pMemory || (unsigned char*)b >= this->pMemory + this->memorySize) { return "block outside the region"; }
+      if (b->prevPhys != prev) { return "broken prevPhys link"; }
+      if (blockSize(b) % ALIGN || blockSize(b) < MIN_BLOCK_SIZE) { return "bad block size"; }
+      if (isFree(b)) {
+        if (prev && isFree(prev)) { return "adjacent free blocks not merged"; }
+        if (!this->listed(b)) { return "free block missing from its list"; }
+        free++;
+      } else {
+        used++;
+        usedBytes += blockSize(b);
+      }
+      prev = b;
+    }
+    if (b->prevPhys != prev) { return "broken sentinel link"; }
+    if ((unsigned char*)b + HEADER_SIZE != this->pMemory + this->memorySize) { return "sentinel not at the end"; }
+    if (used != this->usedBlocks || usedBytes != this->bytesInUse) { return "usage counters out of sync"; }
+    if (this->peakBytesInUse < this->bytesInUse) { return "peak below usage"; }
+
+    // lists: doubly linked, in the right class, bitmaps set exactly for non-empty lists
+    size_t listed = 0;
+    for (unsigned fl = 0; fl < FL_INDEX_COUNT; fl++) {
+      if (bool(this->flBitmap & (1u << fl)) != (this->slBitmap[fl] != 0)) { return "first-level bitmap out of sync"; }
+      for (unsigned sl = 0; sl < SL_INDEX_COUNT; sl++) {
+        const Block* head = this->freeLists[fl][sl];
+        if (bool(this->slBitmap[fl] & (1u << sl)) != (head != nullptr)) { return "second-level bitmap out of sync"; }
+        const Block* last = nullptr;
+        for (const Block* f = head; f; f = f->nextFree) {
+          unsigned i, j;
+          mappingInsert(blockSize(f), i, j);
+          if (!isFree(f)) { return "used block in a free list"; }
+          if (i != fl || j != sl) { return "free block in the wrong list"; }
+          if (f->prevFree != last) { return "broken prevFree link"; }
+          last = f;
+          listed++;
+        }
+      }
+    }
+    if (listed != free) { return "free lists and blocks disagree"; }
+    return nullptr;
+  }
+
+private:
+  bool listed(const Block* block) const {
+    unsigned fl, sl;
+    mappingInsert(blockSize(block), fl, sl);
+    for (const Block* f = this->freeLists[fl][sl]; f; f = f->nextFree) {
+      if (f == block) { return true; }
+    }
+    return false;
+  }
+};
+
+struct Allocation {
+  unsigned char* ptr;
+  size_t size;
+  unsigned char pattern;
+};
+
+static uint32_t state = 1;
+static uint32_t next() {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+// mostly small requests, sometimes large ones, like DSP state
+static size_t randomSize() {
+  const uint32_t r = next();
+  if (r % 16 == 0) { return 1 + next() % 65536; }
+  if (r % 4 == 0) { return 1 + next() % 2048; }
+  return 1 + next() % 96;
+}
+
+static void fill(Allocation& a) {
+  for (size_t i = 0; i < a.size; i++) { a.ptr[i] = (unsigned char)(a.pattern + i); }
+}
+
+static bool intact(const Allocation& a, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    if (a.ptr[i] != (unsigned char)(a.pattern + i)) { return false; }
+  }
+  return true;
+}
+
+static int failures = 0;
+static void expect(bool condition, const char* what, long op) {
+  if (!condition) {
+    if (failures++ < 10) { std::printf("FAIL (operation %ld): %s\n", op, what); }
+  }
+}
+
+int main(int argc, char** argv) {
+  const long operations = argc > 1 ? std::atol(argv[1]) : 200000;
+  state = argc > 2 ? uint32_t(std::atol(argv[2])) | 1u : 1u;
+
+  // a misaligned region, to check the start is aligned
+  const size_t regionSize = 4 << 20;
+  std::vector<unsigned char> region(regionSize + 3);
+  CheckedTlsf tlsf;
+  tlsf.init(region.data() + 3, regionSize);
+  expect(tlsf.check() == nullptr, "bad initial state", -1);
+  const Jaffx::Tlsf::Stats empty = tlsf.getStats();
+
+  // edge cases
+  expect(tlsf.malloc(0) == nullptr, "malloc(0) allocated", -1);
+  expect(tlsf.calloc(size_t(-1) / 2, 4) == nullptr, "calloc overflow allocated", -1);
+  expect(tlsf.malloc(regionSize) == nullptr, "oversized malloc succeeded", -1);
+  tlsf.free(nullptr);
+  tlsf.free(region.data()); // outside the region, ignored
+  void* once = tlsf.malloc(100);
+  expect(once && uintptr_t(once) % Jaffx::Tlsf::ALIGN == 0, "misaligned payload", -1);
+  tlsf.free(once);
+  tlsf.free(once); // double free, ignored
+  expect(tlsf.realloc(tlsf.malloc(10), 0) == nullptr, "realloc to 0 returned memory", -1);
+  expect(tlsf.check() == nullptr, "edge cases broke the allocator", -1);
+
+  std::vector<Allocation> live(512, Allocation{nullptr, 0, 0});
+  long failed = 0;
+  for (long op = 0; op < operations && failures == 0; op++) {
+    Allocation& a = live[next() % live.size()];
+    const uint32_t kind = next() % 8;
+    if (!a.ptr) {
+      a.size = randomSize();
+      a.pattern = (unsigned char)next();
+      if (kind < 2) {
+        a.ptr = (unsigned char*)tlsf.calloc(a.size, 1);
+        if (a.ptr) {
+          bool zeroed = true;
+          for (size_t i = 0; i < a.size; i++) { zeroed &= (a.ptr[i] == 0); }
+          expect(zeroed, "calloc not zeroed", op);
+        }
+      } else {
+        a.ptr = (unsigned char*)tlsf.malloc(a.size);
+      }
+      if (!a.ptr) { failed++; continue; }
+      expect(uintptr_t(a.ptr) % Jaffx::Tlsf::ALIGN == 0, "misaligned payload", op);
+      expect(Jaffx::Tlsf::usableSize(a.ptr) >= a.size, "usable size below request", op);
+      fill(a);
+    } else if (kind < 3) {
+      const size_t size = randomSize();
+      unsigned char* moved = (unsigned char*)tlsf.realloc(a.ptr, size);
+      if (!moved) {
+        failed++;
+        expect(intact(a, a.size), "failed realloc changed the data", op);
+        continue;
+      }
+      a.ptr = moved;
+      expect(intact(a, size < a.size ? size : a.size), "realloc lost the data", op);
+      a.size = size;
+      fill(a);
+    } else {
+      expect(intact(a, a.size), "allocation overwritten", op);
+      tlsf.free(a.ptr);
+      a.ptr = nullptr;
+    }
+    if (op % 64 == 0) {
+      const char* broken = tlsf.check();
+      expect(broken == nullptr, broken ? broken : "", op);
+      for (const Allocation& other : live) {
+        if (other.ptr) { expect(intact(other, other.size), "allocation overwritten", op); }
+      }
+    }
+  }
+
+  for (Allocation& a : live) {
+    if (a.ptr) {
+      expect(intact(a, a.size), "allocation overwritten", operations);
+      tlsf.free(a.ptr);
+      a.ptr = nullptr;
+    }
+  }
+  const char* broken = tlsf.check();
+  expect(broken == nullptr, broken ? broken : "", operations);
+  const Jaffx::Tlsf::Stats stats = tlsf.getStats();
+  expect(stats.bytesInUse == 0 && stats.usedBlocks == 0, "memory still in use after freeing everything", operations);
+  expect(stats.freeBlocks == 1 && stats.freeBytes == empty.freeBytes, "free space not merged back into one block", operations);
+
+  // constant time: the cost of a malloc/free pair with the heap fragmented by live blocks
+  for (size_t i = 0; i < live.size(); i += 2) { live[i].ptr = (unsigned char*)tlsf.malloc(randomSize()); }
+  const int pairs = 1000000;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < pairs; i++) { tlsf.free(tlsf.malloc(1 + (i * 37) % 4096)); }
+  const auto stop = std::chrono::steady_clock::now();
+
+  std::printf("%ld operations, %ld out of memory, peak %zu of %zu bytes\n", operations, failed, stats.peakBytesInUse, stats.capacity);
+  std::printf("malloc + free: %.1f ns\n", std::chrono::duration<double, std::nano>(stop - start).count() / pairs);
+  std::printf("%s\n", failures ? "FAILED" : "all invariants held");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+// Benchmarks the NAM WaveNet engine (include/Wavenet.hpp) per sample vs per block,
+// and checks that both give exactly the same output, for each AmpModeler model.
+// Usage: make bench && ./build/bench/wavenet [seconds]
+//        make bench RTNEURAL=1 also checks it against RTNeural's rt-nam, the reference,
+//        and fails unless every sample is identical
+#include "../../Jaffx.hpp"
+#include "../../examples/namTest/AmpModeler.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+static const int blockSize = 128;
+static const int sampleRate = 48000;
+
+// guitar-ish test signal: decaying plucks over a little noise
+static std::vector<float> makeSignal(size_t length) {
+  std::vector<float> signal(length);
+  uint32_t seed = 1;
+  for (size_t i = 0; i < length; i++) {
+    const float t = float(i % sampleRate) / sampleRate;
+    seed = seed * 1664525u + 1013904223u;
+    const float noise = float(int32_t(seed)) / 2147483648.f;
+    signal[i] = 0.5f * std::exp(-4.f * t) * std::sin(2.f * float(M_PI) * 110.f * t) + 0.01f * noise;
+  }
+  return signal;
+}
+
+template <typename Process>
+static double nsPerSample(size_t length, Process process) {
+  const auto start = std::chrono::steady_clock::now();
+  process();
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / double(length);
+}
+
+// Returns the number of failed checks for one model
+static size_t compare(const char* name, const float* weights, size_t count, const std::vector<float>& input) {
+  const size_t length = input.size();
+  std::vector<float> perSample(length), perBlock(length);
+
+  std::unique_ptr<BlockAmpModel> model(new BlockAmpModel);
+  if (!model->loadModel(weights, count)) {
+    std::fprintf(stderr, "%s: weights don't match the architecture (%zu, expected %d)\n", name, count, BlockAmpModel::numWeights());
+    return 1;
+  }
+  const double sampleNs = nsPerSample(length, [&] {
+    for (size_t i = 0; i < length; i++) { perSample[i] = model->forward(input[i]); }
+  });
+
+  model->loadModel(weights, count);
+  const double blockNs = nsPerSample(length, [&] {
+    for (size_t i = 0; i < length; i += blockSize) { model->process(&input[i], &perBlock[i], blockSize); }
+  });
+
+  size_t mismatches = 0;
+  for (size_t i = 0; i < length; i++) { mismatches += (perSample[i] != perBlock[i]); }
+
+  const double budget = 1e9 / sampleRate;
+  std::printf("%s:\n", name);
+  std::printf("  per sample: %8.2f ns/sample (%5.2f%% of real time)\n", sampleNs, 100.0 * sampleNs / budget);
+  std::printf("  per block:  %8.2f ns/sample (%5.2f%% of real time), %.2fx\n", blockNs, 100.0 * blockNs / budget, sampleNs / blockNs);
+  std::printf("  block vs sample: %zu mismatched samples\n", mismatches);
+  size_t failures = mismatches ? 1 : 0;
+
+#ifdef JAFFX_BENCH_RTNEURAL
+  // both prewarm over the whole receptive field, so they match from the first sample
+  std::unique_ptr<RTNamAmpModel> reference(new RTNamAmpModel);
+  reference->loadModel(weights, count);
+  std::vector<float> expected(length);
+  const double referenceNs = nsPerSample(length, [&] {
+    for (size_t i = 0; i < length; i++) { expected[i] = reference->forward(input[i]); }
+  });
+  // the block engine replaces rt-nam only if nothing changes, so no tolerance
+  float maxError = 0.f;
+  size_t different = 0;
+  for (size_t i = 0; i < length; i++) {
+    maxError = std::fmax(maxError, std::fabs(expected[i] - perBlock[i]));
+    different += !(expected[i] == perBlock[i]); // NaN fails too
+  }
+  std::printf("  rt-nam:     %8.2f ns/sample (%5.2f%% of real time), %.2fx the block engine\n", referenceNs,
+              100.0 * referenceNs / budget, referenceNs / blockNs);
+  std::printf("  block vs rt-nam: %zu mismatched samples, max abs error %g\n", different, maxError);
+  failures += different ? 1 : 0;
+#endif
+
+  return failures;
+}
+
+int main(int argc, char** argv) {
+  const double seconds = argc > 1 ? std::atof(argv[1]) : 10.0;
+  const size_t length = (size_t(seconds * sampleRate) / blockSize) * blockSize;
+  const std::vector<float> input = makeSignal(length);
+
+  std::printf("%zu samples, block size %d, receptive field %d\n", length, blockSize, BlockAmpModel::receptiveField());
+  size_t failures = compare("dumble", DumbleModel_weights, DumbleModel_weights_len, input);
+  failures += compare("marshall", MarshallModel_weights, MarshallModel_weights_len, input);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,247 @@
+// Offline renderer for host builds of Jaffx firmware
+// The firmware's `main()` is compiled as `jaffxMain()` (see Makefile), and
+// `Firmware::start()` hands its audio callback to `Jaffx::Host::render()`
+
+#include "../include/Host.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int jaffxMain();
+
+namespace {
+
+struct Options {
+  const char* inPath = nullptr;
+  const char* outPath = "out.wav";
+  enum class Signal { Sine, Noise, Impulse, Silence } signal = Signal::Sine;
+  float frequency = 440.f;
+  float amplitude = 0.5f;
+  float seconds = 10.f;
+  bool runLoop = true;
+} options;
+
+void usage(const char* name) {
+  fprintf(stderr,
+    "Usage: %s [options]\n"
+    "  --in <file.wav>     render a WAV file (16/24/32-bit PCM or 32-bit float)\n"
+    "  --sine <hz>         render a sine (default, 440Hz)\n"
+    "  --noise             render white noise\n"
+    "  --impulse           render a single impulse\n"
+    "  --silence           render silence\n"
+    "  --amp <gain>        amplitude of generated signals (default 0.5)\n"
+    "  --seconds <s>       length of generated signals (default 10)\n"
+    "  --out <file.wav>    output path, 32-bit float stereo (default out.wav)\n"
+    "  --no-loop           don't call loop() between blocks\n",
+    name);
+}
+
+bool parseArgs(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--in" && hasValue) { options.inPath = argv[++i]; }
+    else if (arg == "--out" && hasValue) { options.outPath = argv[++i]; }
+    else if (arg == "--sine" && hasValue) {
+      options.signal = Options::Signal::Sine;
+      options.frequency = float(atof(argv[++i]));
+    }
+    else if (arg == "--noise") { options.signal = Options::Signal::Noise; }
+    else if (arg == "--impulse") { options.signal = Options::Signal::Impulse; }
+    else if (arg == "--silence") { options.signal = Options::Signal::Silence; }
+    else if (arg == "--amp" && hasValue) { options.amplitude = float(atof(argv[++i])); }
+    else if (arg == "--seconds" && hasValue) { options.seconds = float(atof(argv[++i])); }
+    else if (arg == "--no-loop") { options.runLoop = false; }
+    else { return false; }
+  }
+  return true;
+}
+
+/************************************ WAV I/O ************************************/
+
+struct Audio {
+  std::vector<float> left, right;
+  float sampleRate = 48000.f;
+};
+
+uint32_t readU32(const unsigned char* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24); }
+uint16_t readU16(const unsigned char* p) { return uint16_t(p[0] | (p[1] << 8)); }
+
+bool readWav(const char* path, Audio& audio) {
+  FILE* file = fopen(path, "rb");
+  if (!file) { fprintf(stderr, "Could not open %s\n", path); return false; }
+  std::vector<unsigned char> bytes;
+  unsigned char chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) { bytes.insert(bytes.end(), chunk, chunk + n); }
+  fclose(file);
+
+  if (bytes.size() < 12 || memcmp(bytes.data(), "RIFF", 4) || memcmp(bytes.data() + 8, "WAVE", 4)) {
+    fprintf(stderr, "%s is not a WAV file\n", path);
+    return false;
+  }
+
+  uint16_t format = 0, channels = 0, bits = 0;
+  const unsigned char* data = nullptr;
+  size_t dataSize = 0;
+  for (size_t pos = 12; pos + 8 <= bytes.size();) {
+    const unsigned char* header = bytes.data() + pos;
+    const size_t size = readU32(header + 4);
+    const unsigned char* body = header + 8;
+    if (!memcmp(header, "fmt ", 4) && size >= 16) {
+      format = readU16(body);
+      channels = readU16(body + 2);
+      audio.sampleRate = float(readU32(body + 4));
+      bits = readU16(body + 14);
+      if (format == 0xFFFE && size >= 26) { format = readU16(body + 24); } // WAVE_FORMAT_EXTENSIBLE
+    } else if (!memcmp(header, "data", 4)) {
+      data = body;
+      dataSize = std::min(size, bytes.size() - pos - 8);
+    }
+    pos += 8 + size + (size & 1);
+  }
+
+  const bool pcm = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+  const bool ieee = format == 3 && bits == 32;
+  if (!data || channels == 0 || !(pcm || ieee)) {
+    fprintf(stderr, "%s: unsupported WAV format (%u, %u-bit)\n", path, format, bits);
+    return false;
+  }
+
+  const size_t bytesPerSample = bits / 8;
+  const size_t frames = dataSize / (bytesPerSample * channels);
+  audio.left.resize(frames);
+  audio.right.resize(frames);
+  for (size_t i = 0; i < frames; i++) {
+    for (size_t c = 0; c < 2; c++) {
+      const unsigned char* p = data + (i * channels + std::min<size_t>(c, channels - 1)) * bytesPerSample;
+      float sample;
+      if (ieee) { memcpy(&sample, p, 4); }
+      else if (bits == 16) { sample = int16_t(readU16(p)) / 32768.f; }
+      else if (bits == 24) { sample = int32_t((p[0] << 8) | (p[1] << 16) | (uint32_t(p[2]) << 24)) / 2147483648.f; }
+      else { sample = int32_t(readU32(p)) / 2147483648.f; }
+      (c ? audio.right : audio.left)[i] = sample;
+    }
+  }
+  return true;
+}
+
+void writeU32(FILE* f, uint32_t v) { unsigned char b[4] = { uint8_t(v), uint8_t(v >> 8), uint8_t(v >> 16), uint8_t(v >> 24) }; fwrite(b, 1, 4, f); }
+void writeU16(FILE* f, uint16_t v) { unsigned char b[2] = { uint8_t(v), uint8_t(v >> 8) }; fwrite(b, 1, 2, f); }
+
+bool writeWav(const char* path, const Audio& audio) {
+  FILE* file = fopen(path, "wb");
+  if (!file) { fprintf(stderr, "Could not open %s\n", path); return false; }
+  const uint32_t dataSize = uint32_t(audio.left.size() * 2 * sizeof(float));
+  fwrite("RIFF", 1, 4, file); writeU32(file, 36 + dataSize); fwrite("WAVE", 1, 4, file);
+  fwrite("fmt ", 1, 4, file); writeU32(file, 16);
+  writeU16(file, 3); // IEEE float
+  writeU16(file, 2); // channels
+  writeU32(file, uint32_t(audio.sampleRate));
+  writeU32(file, uint32_t(audio.sampleRate) * 2 * sizeof(float)); // byte rate
+  writeU16(file, 2 * sizeof(float)); // block align
+  writeU16(file, 32); // bits per sample
+  fwrite("data", 1, 4, file); writeU32(file, dataSize);
+  for (size_t i = 0; i < audio.left.size(); i++) {
+    const float frame[2] = { audio.left[i], audio.right[i] };
+    fwrite(frame, sizeof(float), 2, file);
+  }
+  fclose(file);
+  return true;
+}
+
+void generate(Audio& audio, float sampleRate) {
+  audio.sampleRate = sampleRate;
+  const size_t frames = size_t(options.seconds * sampleRate);
+  audio.left.assign(frames, 0.f);
+  uint32_t seed = 22222;
+  for (size_t i = 0; i < frames; i++) {
+    float& sample = audio.left[i];
+    switch (options.signal) {
+      case Options::Signal::Sine:
+        sample = options.amplitude * float(std::sin(6.283185307179586 * options.frequency * double(i) / sampleRate));
+        break;
+      case Options::Signal::Noise:
+        seed = seed * 196314165 + 907633515; // LCG, deterministic across runs
+        sample = options.amplitude * (float(seed) / 2147483648.f - 1.f);
+        break;
+      case Options::Signal::Impulse:
+        sample = (i == 0) ? options.amplitude : 0.f;
+        break;
+      case Options::Signal::Silence:
+        break;
+    }
+  }
+  audio.right = audio.left;
+}
+
+} // namespace
+
+namespace Jaffx {
+namespace Host {
+
+int render(daisy::AudioHandle::AudioCallback callback, size_t blockSize, float sampleRate,
+           void (*idle)(void*), void* context) {
+  if (!callback) { fprintf(stderr, "Firmware did not start audio\n"); return 1; }
+
+  Audio input, output;
+  if (options.inPath) {
+    if (!readWav(options.inPath, input)) { return 1; }
+    if (input.sampleRate != sampleRate) {
+      fprintf(stderr, "Warning: %s is %.0fHz, firmware runs at %.0fHz\n", options.inPath, input.sampleRate, sampleRate);
+    }
+  } else {
+    generate(input, sampleRate);
+  }
+
+  // pad to a whole number of blocks, as the hardware only ever delivers full blocks
+  const size_t blocks = (input.left.size() + blockSize - 1) / blockSize;
+  input.left.resize(blocks * blockSize, 0.f);
+  input.right.resize(blocks * blockSize, 0.f);
+  output.sampleRate = sampleRate;
+  output.left.resize(input.left.size());
+  output.right.resize(input.right.size());
+
+  // render through separate per-block buffers, like the SAI DMA buffers
+  std::vector<float> inBuffer(blockSize * 2), outBuffer(blockSize * 2);
+  const float* in[2] = { inBuffer.data(), inBuffer.data() + blockSize };
+  float* out[2] = { outBuffer.data(), outBuffer.data() + blockSize };
+
+  std::chrono::nanoseconds callbackTime(0);
+  for (size_t b = 0; b < blocks; b++) {
+    const size_t offset = b * blockSize;
+    memcpy(inBuffer.data(), &input.left[offset], blockSize * sizeof(float));
+    memcpy(inBuffer.data() + blockSize, &input.right[offset], blockSize * sizeof(float));
+
+    const auto start = std::chrono::steady_clock::now();
+    callback(in, out, blockSize);
+    callbackTime += std::chrono::steady_clock::now() - start;
+
+    memcpy(&output.left[offset], out[0], blockSize * sizeof(float));
+    memcpy(&output.right[offset], out[1], blockSize * sizeof(float));
+    if (idle && options.runLoop) { idle(context); }
+  }
+
+  if (!writeWav(options.outPath, output)) { return 1; }
+
+  const double seconds = std::chrono::duration<double>(callbackTime).count();
+  const double samples = double(blocks * blockSize);
+  fprintf(stderr, "Rendered %zu blocks of %zu samples to %s\n", blocks, blockSize, options.outPath);
+  fprintf(stderr, "Callback time: %.3f ms\n", seconds * 1e3);
+  fprintf(stderr, "Throughput: %.0f blocks/sec, %.2f ns/sample, %.1fx real-time\n",
+          blocks / seconds, seconds * 1e9 / samples, samples / sampleRate / seconds);
+  return 0;
+}
+
+} // namespace Host
+} // namespace Jaffx
+
+int main(int argc, char** argv) {
+  if (!parseArgs(argc, argv)) {
+    usage(argv[0]);
+    return 1;
+  }
+  return jaffxMain(); // `Firmware::start()` exits with the render status
+}
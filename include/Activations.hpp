@@ -0,0 +1,111 @@
+#pragma once
+#include <cmath>
+
+// Strict floating point like Wavenet.hpp, so an approximation gives the same
+// result wherever it's inlined, and its error is the one benchmarked
+#if defined(__clang__)
+#pragma float_control(precise, on, push)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("no-fast-math", "no-trapping-math")
+#endif
+
+namespace Jaffx {
+
+// Accuracy tiers of the activation approximations (max abs error of `tanh`)
+enum class Accuracy {
+  Low, // ~1.4e-3, 3x NeuralAmpModelerCore's fast tanh (4.4e-4), though closer to tanh near 0
+  Medium, // ~1e-4
+  High // ~4e-7, a few float ulps
+};
+
+/**
+ * @brief Branch-free activation functions, for neural models
+ *
+ * Each `tanh` is one rational function of `x * x` on a clamped input, so it
+ * has no branches or table lookups and loops over buffers vectorize. Use
+ * them through `Jaffx::wavenet::FastMathsProvider`, and see
+ * `host/bench/activations.cpp` for their accuracy and speed.
+ */
+namespace activations {
+
+inline float clamp(float x, float limit) { return x < -limit ? -limit : (x > limit ? limit : x); }
+
+template <Accuracy A> inline float tanh(float x);
+
+// Lambert's continued fraction to order 4, clamped where it reaches 1
+template <> inline float tanh<Accuracy::Low>(float x) {
+  x = clamp(x, 3.6467386f);
+  const float x2 = x * x;
+  return x * (945.f + x2 * (105.f + x2)) / (945.f + x2 * (420.f + x2 * 15.f));
+}
+
+// Lambert's continued fraction to order 6, clamped where it reaches 1
+template <> inline float tanh<Accuracy::Medium>(float x) {
+  x = clamp(x, 4.97178686f);
+  const float x2 = x * x;
+  return x * (135135.f + x2 * (17325.f + x2 * (378.f + x2))) / (135135.f + x2 * (62370.f + x2 * (3150.f + x2 * 28.f)));
+}
+
+// 13/6 minimax rational (as in Eigen), clamped where tanh rounds to 1 in float
+template <> inline float tanh<Accuracy::High>(float x) {
+  x = clamp(x, 7.90531110763549805f);
+  const float x2 = x * x;
+  float p = -2.76076847742355e-16f;
+  p = p * x2 + 2.00018790482477e-13f;
+  p = p * x2 + -8.60467152213735e-11f;
+  p = p * x2 + 5.12229709037114e-08f;
+  p = p * x2 + 1.48572235717979e-05f;
+  p = p * x2 + 6.37261928875436e-04f;
+  p = p * x2 + 4.89352455891786e-03f;
+  float q = 1.19825839466702e-06f;
+  q = q * x2 + 1.18534705686654e-04f;
+  q = q * x2 + 2.26843463243900e-03f;
+  q = q * x2 + 4.89352518554385e-03f;
+  return x * p / q;
+}
+
+template <Accuracy A> inline float sigmoid(float x) { return 0.5f + 0.5f * tanh<A>(0.5f * x); }
+template <Accuracy A> inline float silu(float x) { return x * sigmoid<A>(x); }
+inline float relu(float x) { return x > 0.f ? x : 0.f; }
+inline float leakyRelu(float x, float slope = 0.01f) { return x > 0.f ? x : slope * x; }
+inline float hardTanh(float x) { return clamp(x, 1.f); }
+
+} // namespace activations
+
+namespace wavenet {
+
+/**
+ * @brief Maths provider for `LayerArray` using `Jaffx::activations`
+ *
+ * Low is the cheapest call, but that doesn't carry over to a WaveNet. Built
+ * without vectorization, like for the Cortex-M7's scalar FPU, Low and Medium
+ * both ran ~15% faster than `NAMMathsProvider`, and vectorized on a host, Low
+ * was slower than both Medium and `NAMMathsProvider`. Medium is the default:
+ * at least as fast as NAM's tanh, and 4x more accurate. Measure with
+ * `host/bench/activations.cpp` (`make bench OPT="-O3 -fno-tree-vectorize"`
+ * for the scalar case).
+ *
+ * @code
+ * using Array1 = Jaffx::wavenet::LayerArray<float, 1, 1, 2, 2, 3, Dilations<1, 2, 4>, false,
+ *                                           Jaffx::wavenet::FastMathsProvider<Jaffx::Accuracy::Medium>>;
+ * @endcode
+ */
+template <Accuracy A = Accuracy::Medium>
+struct FastMathsProvider {
+  static inline float tanh(float x) { return activations::tanh<A>(x); }
+  static inline float sigmoid(float x) { return activations::sigmoid<A>(x); }
+  static inline float silu(float x) { return activations::silu<A>(x); }
+  static inline float relu(float x) { return activations::relu(x); }
+  static inline float leakyRelu(float x) { return activations::leakyRelu(x); }
+  static inline float hardTanh(float x) { return activations::hardTanh(x); }
+};
+
+} // namespace wavenet
+} // namespace Jaffx
+
+#if defined(__clang__)
+#pragma float_control(pop)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
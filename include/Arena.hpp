@@ -0,0 +1,138 @@
+#pragma once
+#include <cstring>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Jaffx {
+
+/**
+ * @brief Pointer-bump arena with checkpoints
+ *
+ * Allocation is a constant-time bump with no per-allocation header, and
+ * individual frees are no-ops. Memory comes back all at once by rolling back
+ * to a checkpoint taken with `mark()`, e.g. when rebuilding an effect chain on
+ * a preset change.
+ *
+ * While `open()`, the `giml` allocation hooks in `Jaffx.hpp` are routed
+ * here instead of the general-purpose SDRAM allocator.
+ */
+class Arena {
+public:
+  typedef size_t Checkpoint; // bytes in use at the time of `mark()`
+
+private:
+  static const size_t ALIGN = 8;
+  static const size_t NONE = size_t(-1);
+  unsigned char* pBegin = nullptr;
+  size_t capacity = 0;
+  size_t top = 0; // offset of the next free byte
+  size_t last = NONE; // offset of the most recent allocation, for in-place realloc
+  size_t highWater = 0;
+  bool opened = false;
+
+  static size_t alignUp(size_t a) { return (a + ALIGN - 1) & ~(ALIGN - 1); }
+
+public:
+  Arena() {}
+
+  //Have copy & copy-assignment constructors disabled, allocations point into the region
+  Arena(const Arena&) = delete;
+  void operator=(const Arena&) = delete;
+
+  /**
+   * @brief Hands the arena a region to allocate from, e.g. a block from `mSDRAM`
+   *
+   * @return false if `memory` is `nullptr`
+   */
+  bool init(void* memory, size_t size) {
+    const uintptr_t start = (uintptr_t(memory) + ALIGN - 1) & ~uintptr_t(ALIGN - 1);
+    const size_t lost = size_t(start - uintptr_t(memory));
+    if (!memory || size < lost) { this->pBegin = nullptr; this->capacity = 0; return false; }
+    this->pBegin = (unsigned char*)start;
+    this->capacity = (size - lost) & ~(ALIGN - 1); // whole aligned allocations only
+    this->top = this->highWater = 0;
+    this->last = NONE;
+    return true;
+  }
+
+  // route `giml` allocations here until `close()`
+  void open() { this->opened = (this->pBegin != nullptr); }
+  void close() { this->opened = false; }
+  bool isOpen() const { return this->opened; }
+
+  // Returns 8-byte aligned memory, or `nullptr` if the arena is full or `size` is 0
+  void* allocate(size_t size) {
+    if (size == 0 || size > this->capacity - this->top) { return nullptr; }
+    const size_t aligned = alignUp(size);
+    if (aligned > this->capacity - this->top) { return nullptr; }
+    this->last = this->top;
+    this->top += aligned;
+    if (this->top > this->highWater) { this->highWater = this->top; }
+    return this->pBegin + this->last;
+  }
+
+  void* allocateZeroed(size_t numElements, size_t size) {
+    if (size && numElements > size_t(-1) / size) { return nullptr; } // overflow
+    void* ptr = this->allocate(numElements * size);
+    if (ptr) { ::memset(ptr, 0, numElements * size); }
+    return ptr;
+  }
+
+  /**
+   * @brief Grows or shrinks the most recent allocation in place, otherwise
+   * copies to a new allocation (the old one is reclaimed on rollback)
+   *
+   * Sizes aren't stored, so a moved allocation copies up to `size` bytes, but
+   * never past the arena's top (or `oldSize`, if the caller knows it).
+   * @return `nullptr` if the arena is full, or `ptr` was released by a rollback
+   */
+  void* reallocate(void* ptr, size_t size, size_t oldSize = NONE) {
+    if (!ptr) { return this->allocate(size); }
+    if (size == 0) { return nullptr; }
+    const size_t offset = size_t((unsigned char*)ptr - this->pBegin);
+    if (offset >= this->top) { return nullptr; }
+    if (offset == this->last) {
+      const size_t aligned = alignUp(size);
+      if (aligned > this->capacity - offset) { return nullptr; }
+      this->top = offset + aligned;
+      if (this->top > this->highWater) { this->highWater = this->top; }
+      return ptr;
+    }
+    size_t count = this->top - offset; // the most the old allocation can hold
+    if (oldSize < count) { count = oldSize; }
+    if (size < count) { count = size; }
+    void* moved = this->allocate(size);
+    if (moved) { ::memcpy(moved, ptr, count); }
+    return moved;
+  }
+
+  // Checkpoint to later `rollback()` to
+  Checkpoint mark() const { return this->top; }
+
+  /**
+   * @brief Releases everything allocated since `checkpoint` in constant time
+   *
+   * Objects living in that memory must already be destroyed.
+   */
+  void rollback(Checkpoint checkpoint) {
+    if (checkpoint > this->top) { return; }
+    this->top = checkpoint;
+    this->last = NONE; // allocations left are not grown in place
+  }
+
+  void reset() { this->rollback(0); }
+
+  bool owns(const void* p) const {
+    return this->pBegin && (const unsigned char*)p >= this->pBegin &&
+           (const unsigned char*)p < this->pBegin + this->capacity;
+  }
+
+  size_t used() const { return this->top; }
+  size_t available() const { return this->capacity - this->top; }
+  size_t size() const { return this->capacity; }
+  size_t peak() const { return this->highWater; }
+};
+
+Arena mArena; // global arena, see `Arena::open()`
+
+} // namespace Jaffx
@@ -0,0 +1,147 @@
+#pragma once
+#include "Telemetry.hpp" // SpscQueue
+#include <atomic>
+
+namespace Jaffx {
+
+// A debounced change of a switch or encoder, published by a `ControlScanner`
+struct ControlEvent {
+  enum class Type : uint8_t {
+    Pressed, // rising edge (`RisingEdge()`)
+    Released, // falling edge (`FallingEdge()`), how the examples toggle
+    Turned // an encoder moved by `increment`
+  };
+  enum class Source : uint8_t { Switch, Encoder };
+
+  Type type;
+  Source source;
+  uint8_t index; // in the order added, counted per source
+  int8_t increment;
+};
+
+/**
+ * @brief Scans switches and encoders at a fixed rate, away from the audio callback
+ *
+ * `scan()` debounces every control added and publishes their edges and
+ * increments as `ControlEvent`s through a lock-free queue, so the audio
+ * callback (or `loop()`) only pops events and never touches GPIO. It runs
+ * from a hardware timer (`startTimer()`), or call `scan()` at a fixed rate
+ * yourself (e.g. a `Jaffx::Scheduler` task). Once scanning starts, only the
+ * scanner may use the controls, the state of switches is available through
+ * `isPressed()` and `getTimeHeldMs()`.
+ *
+ * `pop()` has a single consumer, and `scan()` a single producer (the timer
+ * interrupt, or `loop()`). Events that don't fit are dropped and counted.
+ *
+ * @code
+ * mControls.add(mSwitch);
+ * mControls.add(mEncoder);
+ * mControls.startTimer(1000.f); // in `init()`
+ * // in `blockStart()`
+ * Jaffx::ControlEvent event;
+ * while (mControls.pop(event)) {
+ *   if (event.type == Jaffx::ControlEvent::Type::Turned) { value += event.increment; }
+ * }
+ * @endcode
+ *
+ * @tparam Switch a `daisy::Switch`, `Debounce()`d by the scanner
+ * @tparam Encoder a `daisy::Encoder`, `Debounce()`d by the scanner
+ * @tparam QueueSize events in flight, a power of two
+ */
+template <typename Switch, typename Encoder, size_t MaxSwitches = 8, size_t MaxEncoders = 4, size_t QueueSize = 64>
+class ControlScanner {
+public:
+  // Adds a switch, returns its index, -1 if there are `MaxSwitches` already
+  int add(Switch& control) {
+    if (this->numSwitches == MaxSwitches) { return -1; }
+    this->switches[this->numSwitches] = &control;
+    return int(this->numSwitches++);
+  }
+
+  // Adds an encoder, returns its index, -1 if there are `MaxEncoders` already
+  int add(Encoder& control) {
+    if (this->numEncoders == MaxEncoders) { return -1; }
+    this->encoders[this->numEncoders] = &control;
+    return int(this->numEncoders++);
+  }
+
+  // Debounces every control and publishes what changed, call at a fixed rate
+  void scan() {
+    for (size_t i = 0; i < this->numSwitches; i++) {
+      Switch& control = *this->switches[i];
+      control.Debounce();
+      if (control.RisingEdge()) { this->publish(ControlEvent::Type::Pressed, ControlEvent::Source::Switch, i, 0); }
+      if (control.FallingEdge()) { this->publish(ControlEvent::Type::Released, ControlEvent::Source::Switch, i, 0); }
+      this->pressed[i].store(control.Pressed(), std::memory_order_relaxed);
+      this->held[i].store(control.Pressed() ? control.TimeHeldMs() : 0.f, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < this->numEncoders; i++) {
+      Encoder& control = *this->encoders[i];
+      control.Debounce();
+      const int increment = control.Increment();
+      if (increment != 0) {
+        this->publish(ControlEvent::Type::Turned, ControlEvent::Source::Encoder, i, increment);
+      }
+      if (control.RisingEdge()) { this->publish(ControlEvent::Type::Pressed, ControlEvent::Source::Encoder, i, 0); }
+      if (control.FallingEdge()) { this->publish(ControlEvent::Type::Released, ControlEvent::Source::Encoder, i, 0); }
+    }
+  }
+
+#ifndef JAFFX_HOST
+  /**
+   * @brief Scans `rate` times per second from a timer interrupt
+   *
+   * TIM_2 keeps libDaisy's `daisy::System` time, use another timer.
+   */
+  void startTimer(float rate = 1000.f,
+                  daisy::TimerHandle::Config::Peripheral periph = daisy::TimerHandle::Config::Peripheral::TIM_5) {
+    daisy::TimerHandle::Config config;
+    config.periph = periph;
+    config.dir = daisy::TimerHandle::Config::CounterDir::UP;
+    config.enable_irq = true;
+    this->timer.Init(config);
+    this->timer.SetPeriod(uint32_t(float(this->timer.GetFreq()) / rate) - 1);
+    this->timer.SetCallback([](void* self) { static_cast<ControlScanner*>(self)->scan(); }, this);
+    this->timer.Start();
+  }
+
+  void stopTimer() { this->timer.Stop(); }
+#endif
+
+  // Consumer side, returns false if there are no events
+  bool pop(ControlEvent& event) { return this->events.pop(event); }
+
+  // Whether switch `index` is held down, as of the last scan
+  bool isPressed(size_t index) const { return this->pressed[index].load(std::memory_order_relaxed); }
+
+  // How long switch `index` has been held down, 0 if it's up, as of the last scan
+  float getTimeHeldMs(size_t index) const { return this->held[index].load(std::memory_order_relaxed); }
+
+  // Events dropped because the queue was full, since the last call
+  uint32_t takeDropped() { return this->dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+  Switch* switches[MaxSwitches] = {};
+  Encoder* encoders[MaxEncoders] = {};
+  size_t numSwitches = 0, numEncoders = 0;
+  SpscQueue<ControlEvent, QueueSize> events;
+  std::atomic<bool> pressed[MaxSwitches] = {};
+  std::atomic<float> held[MaxSwitches] = {};
+  std::atomic<uint32_t> dropped{0};
+#ifndef JAFFX_HOST
+  daisy::TimerHandle timer;
+#endif
+
+  void publish(ControlEvent::Type type, ControlEvent::Source source, size_t index, int increment) {
+    if (!this->events.push({type, source, uint8_t(index), int8_t(increment)})) {
+      this->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+};
+
+#ifndef JAFFX_HOST
+// Scanner of libDaisy's controls
+using Controls = ControlScanner<daisy::Switch, daisy::Encoder>;
+#endif
+
+} // namespace Jaffx
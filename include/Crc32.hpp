@@ -0,0 +1,23 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Jaffx {
+
+/**
+ * @brief CRC-32 (IEEE 802.3, as zlib's `crc32()` and Python's `zlib.crc32()`)
+ *
+ * Pass the previous result as `crc` to checksum data in pieces. Bitwise, so
+ * no table in RAM, meant for integrity checks at load time, not streaming.
+ */
+inline uint32_t crc32(const void* data, size_t size, uint32_t crc = 0) {
+  const unsigned char* bytes = (const unsigned char*)data;
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++) {
+    crc ^= bytes[i];
+    for (int bit = 0; bit < 8; bit++) { crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u))); }
+  }
+  return ~crc;
+}
+
+} // namespace Jaffx
@@ -0,0 +1,215 @@
+#pragma once
+#include "../Gimmel/include/gimmel.hpp"
+#include "Profiler.hpp"
+#include <cstring>
+#include <vector>
+
+namespace Jaffx {
+
+/**
+ * @brief `giml::Effect` that can also process whole blocks
+ *
+ * Override `processBlock()` when an effect is cheaper a block at a time
+ * (e.g. neural models), `Jaffx::EffectsLine::processBlock()` calls it
+ * instead of `processSample()` per sample.
+ */
+template <typename T>
+class BlockEffect : public giml::Effect<T> {
+public:
+  // processes `size` samples, `in` and `out` may alias
+  virtual void processBlock(const T* in, T* out, size_t size) {
+    for (size_t i = 0; i < size; i++) { out[i] = this->processSample(in[i]); }
+  }
+
+  // whether the effect passes its input through when disabled (giml's
+  // convention), so `Jaffx::EffectsLine` can skip it then
+  virtual bool bypassable() const { return true; }
+};
+
+/**
+ * @brief `giml::EffectsLine` that skips disabled stages and can name them for profiling
+ *
+ * Stages are processed from a compacted list of the enabled ones, rebuilt only
+ * when a stage is toggled, so a disabled effect costs nothing per sample.
+ * Toggle stages through `toggle()` to crossfade between the dry and processed
+ * signal over `setFadeLength()` samples. Effects toggled directly are picked up
+ * by `update()` (called by `processBlock()`) once any fade of theirs is over,
+ * enabled ones fade in but disabled ones stop at once, since a disabled effect
+ * can't be heard fading out.
+ *
+ * If `JAFFX_PROFILE` is defined, each stage's processing time is accumulated
+ * per block and reported by `Firmware::debugLoop()`.
+ *
+ * `processBlock()` runs the line stage by stage over a whole block, letting
+ * stages pushed as `BlockEffect`s process the block in one call.
+ */
+template <typename T>
+class EffectsLine : public giml::EffectsLine<T> {
+public:
+  using giml::EffectsLine<T>::EffectsLine;
+
+  // push a stage with a name to show in profiling reports
+  void pushBack(giml::Effect<T>* effect, const char* name = nullptr) {
+#ifdef JAFFX_PROFILE
+    const size_t index = this->size();
+    if (index < JAFFX_PROFILE_MAX_STAGES) { this->stages[index] = Profiler::registry().add(name); }
+#else
+    (void)name;
+#endif
+    giml::EffectsLine<T>::pushBack(effect);
+    const bool on = Flag::of(effect);
+    this->slots.push_back({effect, nullptr, true, on, on ? 1.f : 0.f});
+    this->active.reserve(this->slots.size()); // so rebuilding never allocates
+    this->rebuild();
+  }
+
+  // push a stage that `processBlock()` runs a block at a time
+  void pushBack(BlockEffect<T>* effect, const char* name = nullptr) {
+    this->pushBack(static_cast<giml::Effect<T>*>(effect), name);
+    Slot& slot = this->slots.back();
+    slot.block = effect;
+    slot.bypassable = effect->bypassable();
+    this->rebuild();
+  }
+
+  // Enables or disables stage `index`, crossfading if it changes
+  void toggle(size_t index, bool state) {
+    Slot& slot = this->slots[index];
+    if (!slot.bypassable) { slot.effect->toggle(state); }
+    else if (state != slot.on) {
+      slot.on = state;
+      if (state) {
+        slot.effect->enable();
+        if (slot.mix == 0.f) { this->rebuild(); }
+      }
+      // disabled once faded out, see `fade()`
+    }
+  }
+
+  void enable(size_t index) { this->toggle(index, true); }
+  void disable(size_t index) { this->toggle(index, false); }
+
+  // Length of the crossfades of `toggle()`, in samples
+  void setFadeLength(size_t samples) { this->fadeStep = samples ? 1.f / float(samples) : 1.f; }
+
+  // Picks up stages toggled directly, once per block before `processSample()`
+  void update() {
+    bool changed = false;
+    for (Slot& slot : this->slots) {
+      // a stage fading out stays enabled until it's silent, and a fade runs to its end first
+      if (!slot.bypassable || slot.fading() || Flag::of(slot.effect) == slot.on) { continue; }
+      slot.on = !slot.on;
+      slot.mix = 0.f;
+      changed = true;
+    }
+    if (changed) { this->rebuild(); }
+  }
+
+  // processes `size` samples stage by stage, `in` and `out` may alias
+  void processBlock(const T* in, T* out, size_t size) {
+    this->update();
+    if (out != in) { ::memcpy(out, in, size * sizeof(T)); }
+    for (size_t n = 0; n < this->active.size(); n++) {
+      const size_t i = this->active[n];
+      Slot& slot = this->slots[i];
+#ifdef JAFFX_PROFILE
+      const uint32_t start = Profiler::now();
+#endif
+      if (slot.fading()) {
+        // crossfade in chunks, so the dry signal fits on the stack
+        for (size_t offset = 0; offset < size; offset += fadeChunk) {
+          const size_t count = size - offset < fadeChunk ? size - offset : fadeChunk;
+          T dry[fadeChunk];
+          ::memcpy(dry, out + offset, count * sizeof(T));
+          slot.process(out + offset, count);
+          for (size_t j = 0; j < count; j++) { out[offset + j] = this->fade(slot, dry[j], out[offset + j]); }
+        }
+      }
+      else { slot.process(out, size); }
+#ifdef JAFFX_PROFILE
+      if (i < JAFFX_PROFILE_MAX_STAGES && this->stages[i]) {
+        this->stages[i]->current += Profiler::now() - start;
+      }
+#endif
+    }
+    if (this->finished) { this->rebuild(); }
+  }
+
+  // processes a sample through the enabled stages
+  T processSample(const T& in) {
+    T out = in;
+    for (size_t n = 0; n < this->active.size(); n++) {
+      const size_t i = this->active[n];
+      Slot& slot = this->slots[i];
+#ifdef JAFFX_PROFILE
+      const uint32_t start = Profiler::now();
+#endif
+      const T wet = slot.effect->processSample(out);
+      out = slot.fading() ? this->fade(slot, out, wet) : wet;
+#ifdef JAFFX_PROFILE
+      if (i < JAFFX_PROFILE_MAX_STAGES && this->stages[i]) {
+        this->stages[i]->current += Profiler::now() - start;
+      }
+#endif
+    }
+    if (this->finished) { this->rebuild(); }
+    return out;
+  }
+
+private:
+  static const size_t fadeChunk = 32;
+
+  // reads the protected `giml::Effect::enabled` of any effect
+  struct Flag : giml::Effect<T> {
+    static bool of(const giml::Effect<T>* effect) { return effect->*(&Flag::enabled); }
+  };
+
+  struct Slot {
+    giml::Effect<T>* effect;
+    BlockEffect<T>* block; // `effect` if it processes blocks, `nullptr` otherwise
+    bool bypassable; // skipped when disabled
+    bool on; // target state
+    float mix; // of the processed signal, fading towards `on`
+
+    bool fading() const { return this->bypassable && this->mix != (this->on ? 1.f : 0.f); }
+
+    void process(T* buffer, size_t size) {
+      if (this->block) { this->block->processBlock(buffer, buffer, size); }
+      else {
+        for (size_t j = 0; j < size; j++) { buffer[j] = this->effect->processSample(buffer[j]); }
+      }
+    }
+  };
+
+  std::vector<Slot> slots;
+  std::vector<size_t> active; // indices of the stages to process
+  float fadeStep = 1.f / 256.f;
+  bool finished = false; // a fade out has ended, `active` needs rebuilding
+
+  T fade(Slot& slot, const T& dry, const T& wet) {
+    if (slot.on) { slot.mix = slot.mix + this->fadeStep < 1.f ? slot.mix + this->fadeStep : 1.f; }
+    else {
+      slot.mix = slot.mix - this->fadeStep > 0.f ? slot.mix - this->fadeStep : 0.f;
+      if (slot.mix == 0.f) {
+        slot.effect->disable();
+        this->finished = true;
+      }
+    }
+    return dry + T(slot.mix) * (wet - dry);
+  }
+
+  void rebuild() {
+    this->active.clear();
+    for (size_t i = 0; i < this->slots.size(); i++) {
+      const Slot& slot = this->slots[i];
+      if (!slot.bypassable || slot.on || slot.mix > 0.f) { this->active.push_back(i); }
+    }
+    this->finished = false;
+  }
+
+#ifdef JAFFX_PROFILE
+  Profiler::Stage* stages[JAFFX_PROFILE_MAX_STAGES] = {};
+#endif
+};
+
+} // namespace Jaffx
@@ -0,0 +1,297 @@
+#pragma once
+#include "EffectsLine.hpp"
+#include <cstring>
+#include <vector>
+
+namespace Jaffx {
+
+/**
+ * @brief Audio graph of effects with splits, mixes and feedback sends
+ *
+ * Nodes are effects or mixes, connected by edges with a gain. A node's input
+ * is the sum of its incoming edges, and a node connected to several others
+ * splits its output between them. Feedback edges (`connectFeedback()`) may
+ * form cycles, and deliver their source's output one block later.
+ *
+ * `compile()` sorts the graph once into a flat schedule of steps, and assigns
+ * each node's output a scratch buffer, reused as soon as its last consumer
+ * has run (a node processes in place when it's the last consumer of an
+ * input), so `processBlock()` is plain loops over a few buffers, like
+ * hand-written routing. Blocks are processed `MaxBlock` samples at a time.
+ *
+ * @code
+ * Jaffx::Graph<float> graph;
+ * const int amp = graph.addEffect(&model);
+ * const int delay1 = graph.addEffect(mDelay.get()), delay2 = graph.addEffect(mDelay2.get());
+ * const int mix = graph.addMix();
+ * graph.connect(graph.input(), amp);
+ * graph.connect(amp, delay1);
+ * graph.connect(amp, delay2);
+ * graph.connect(delay1, mix, 0.5f);
+ * graph.connect(delay2, mix, 0.5f);
+ * graph.connect(mix, graph.output());
+ * graph.compile();
+ * @endcode
+ */
+template <typename T, size_t MaxBlock = 128>
+class Graph {
+public:
+  Graph() {
+    this->nodes.push_back({nullptr, nullptr}); // input
+    this->nodes.push_back({nullptr, nullptr}); // output
+  }
+
+  int input() const { return 0; }
+  int output() const { return 1; }
+
+  // Adds a node processing its input with `effect`, returns its index
+  int addEffect(giml::Effect<T>* effect) { return this->addNode(effect, nullptr); }
+
+  // Adds a node processing its input a block at a time, returns its index
+  int addEffect(BlockEffect<T>* effect) { return this->addNode(effect, effect); }
+
+  // Adds a node passing its (summed) input through, returns its index
+  int addMix() { return this->addNode(nullptr, nullptr); }
+
+  // Adds `from`'s output times `gain` to `to`'s input, false if not possible
+  bool connect(int from, int to, T gain = T(1)) { return this->addEdge(from, to, gain, false); }
+
+  // Like `connect()`, but a block later, so it may close a loop
+  bool connectFeedback(int from, int to, T gain = T(1)) { return this->addEdge(from, to, gain, true); }
+
+  /**
+   * @brief Schedules the graph, call after connecting nodes and before processing
+   *
+   * @return false if `connect()` edges form a loop (use `connectFeedback()`)
+   */
+  bool compile() {
+    const int numNodes = int(this->nodes.size());
+    this->steps.clear();
+    this->sources.clear();
+    this->stores.clear();
+    this->compiled = false;
+
+    // sort the nodes (Kahn's algorithm), the output goes last
+    std::vector<int> order, pending(numNodes, 0);
+    for (const Edge& edge : this->edges) {
+      if (!edge.feedback) { pending[edge.to]++; }
+    }
+    order.push_back(this->input());
+    for (size_t n = 0; n < order.size(); n++) {
+      for (const Edge& edge : this->edges) {
+        if (edge.feedback || edge.from != order[n] || --pending[edge.to] != 0) { continue; }
+        if (edge.to != this->output()) { order.push_back(edge.to); }
+      }
+      // nodes without inputs (e.g. generators) start once the input is scheduled
+      if (n == 0) {
+        for (int node = 2; node < numNodes; node++) {
+          if (pending[node] == 0 && !this->hasInputs(node)) { order.push_back(node); }
+        }
+      }
+    }
+    if (int(order.size()) != numNodes - 1) { return false; } // a loop
+    order.push_back(this->output());
+
+    // where each node's output is last read, feedback sends read it after the last step
+    std::vector<int> stepOf(numNodes), lastUse(numNodes, -1);
+    for (int s = 0; s < numNodes; s++) { stepOf[order[s]] = s; }
+    for (const Edge& edge : this->edges) {
+      const int use = edge.feedback ? numNodes : stepOf[edge.to];
+      if (use > lastUse[edge.from]) { lastUse[edge.from] = use; }
+    }
+
+    // a persistent buffer per feedback edge, then scratch buffers as needed
+    this->numBuffers = 0;
+    std::vector<int> feedbackBuffer(this->edges.size(), -1), bufferOf(numNodes, -1), owner, free;
+    for (size_t e = 0; e < this->edges.size(); e++) {
+      if (this->edges[e].feedback) { feedbackBuffer[e] = this->numBuffers++; }
+    }
+    owner.assign(this->numBuffers, -1);
+    bufferOf[this->input()] = Input;
+    for (int s = 1; s < numNodes; s++) {
+      const int node = order[s];
+      Step step = {node, -1, this->sources.size(), 0};
+      // the graph's input first, so the output can overwrite it when they alias
+      for (const Edge& edge : this->edges) {
+        if (edge.to == node && !edge.feedback && edge.from == this->input()) { this->addSource(step, Input, edge.gain); }
+      }
+      for (size_t e = 0; e < this->edges.size(); e++) {
+        const Edge& edge = this->edges[e];
+        if (edge.to != node || (!edge.feedback && edge.from == this->input())) { continue; }
+        const int buffer = edge.feedback ? feedbackBuffer[e] : bufferOf[edge.from];
+        if (this->addSource(step, buffer, edge.gain)) { continue; } // another edge from the same node
+        // process in place in the first source that isn't read later
+        if (step.buffer < 0 && node != this->output() && !edge.feedback && lastUse[edge.from] == s) {
+          step.buffer = buffer;
+          this->sources.insert(this->sources.begin() + step.firstSource, this->sources.back());
+          this->sources.pop_back();
+        }
+      }
+      step.numSources = this->sources.size() - step.firstSource;
+
+      // take the node's buffer before releasing its sources, it's written before they're all read
+      if (node == this->output()) { step.buffer = Output; }
+      else if (step.buffer < 0) {
+        if (free.empty()) {
+          step.buffer = this->numBuffers++;
+          owner.push_back(-1);
+        }
+        else {
+          step.buffer = free.back();
+          free.pop_back();
+        }
+      }
+      if (step.buffer >= 0) { owner[step.buffer] = node; }
+      bufferOf[node] = step.buffer;
+      this->steps.push_back(step);
+
+      // release the buffers read for the last time
+      for (size_t i = step.firstSource; i < step.firstSource + step.numSources; i++) {
+        const int buffer = this->sources[i].buffer;
+        if (buffer < 0 || buffer == step.buffer || owner[buffer] < 0 || lastUse[owner[buffer]] != s) { continue; }
+        owner[buffer] = -1;
+        free.push_back(buffer);
+      }
+
+      // a node nobody reads frees its buffer at once
+      if (step.buffer >= 0 && lastUse[node] < 0) {
+        owner[step.buffer] = -1;
+        free.push_back(step.buffer);
+      }
+    }
+
+    // feedback sends are copied once the block is done, so they always arrive a block later
+    for (size_t e = 0; e < this->edges.size(); e++) {
+      if (this->edges[e].feedback) { this->stores.push_back({bufferOf[this->edges[e].from], feedbackBuffer[e]}); }
+    }
+
+    this->buffers.assign(this->numBuffers * MaxBlock, T(0));
+    this->compiled = true;
+    return true;
+  }
+
+  // Number of scratch and feedback buffers of `MaxBlock` samples used
+  int getNumBuffers() const { return this->numBuffers; }
+
+  // processes `size` samples through the compiled graph, `in` and `out` may alias
+  void processBlock(const T* in, T* out, size_t size) {
+    if (!this->compiled) {
+      if (out != in) { ::memmove(out, in, size * sizeof(T)); }
+      return;
+    }
+    while (size > 0) {
+      const size_t n = size < MaxBlock ? size : MaxBlock;
+      for (const Step& step : this->steps) { this->run(step, in, out, n); }
+      for (const Store& store : this->stores) {
+        ::memcpy(this->buffer(store.to), store.from == Output ? out : this->buffer(store.from), n * sizeof(T));
+      }
+      in += n;
+      out += n;
+      size -= n;
+    }
+  }
+
+private:
+  static const int Input = -1, Output = -2;
+
+  struct Node {
+    giml::Effect<T>* effect; // `nullptr` for the input, output and mixes
+    BlockEffect<T>* block; // `effect` if it processes blocks, `nullptr` otherwise
+  };
+
+  struct Edge {
+    int from, to;
+    T gain;
+    bool feedback;
+  };
+
+  struct Source {
+    int buffer; // or `Input`
+    T gain;
+  };
+
+  struct Step {
+    int node;
+    int buffer; // of the node's output, or `Output`
+    size_t firstSource, numSources; // in `sources`, the first one is `buffer` when in place
+  };
+
+  struct Store {
+    int from; // buffer of a node with feedback sends, or `Output`
+    int to; // buffer of the feedback edge
+  };
+
+  std::vector<Node> nodes;
+  std::vector<Edge> edges;
+  std::vector<Step> steps;
+  std::vector<Source> sources;
+  std::vector<Store> stores;
+  std::vector<T> buffers;
+  int numBuffers = 0;
+  bool compiled = false;
+
+  int addNode(giml::Effect<T>* effect, BlockEffect<T>* block) {
+    this->nodes.push_back({effect, block});
+    this->compiled = false;
+    return int(this->nodes.size()) - 1;
+  }
+
+  bool addEdge(int from, int to, T gain, bool feedback) {
+    const int numNodes = int(this->nodes.size());
+    if (from < 0 || from >= numNodes || to < 0 || to >= numNodes || from == this->output() || to == this->input()) {
+      return false;
+    }
+    if ((!feedback && from == to) || (feedback && from == this->input())) { return false; }
+    this->edges.push_back({from, to, gain, feedback});
+    this->compiled = false;
+    return true;
+  }
+
+  bool hasInputs(int node) const {
+    for (const Edge& edge : this->edges) {
+      if (edge.to == node && !edge.feedback) { return true; }
+    }
+    return false;
+  }
+
+  // Adds `buffer` to the step's sources, false if it was one already (its gains add up)
+  bool addSource(const Step& step, int buffer, T gain) {
+    for (size_t i = step.firstSource; i < this->sources.size(); i++) {
+      if (this->sources[i].buffer == buffer) {
+        this->sources[i].gain += gain;
+        return true;
+      }
+    }
+    this->sources.push_back({buffer, gain});
+    return false;
+  }
+
+  T* buffer(int index) { return &this->buffers[size_t(index) * MaxBlock]; }
+
+  void run(const Step& step, const T* in, T* out, size_t size) {
+    T* dest = step.buffer == Output ? out : this->buffer(step.buffer);
+
+    // sum the inputs
+    const Source* source = &this->sources[step.firstSource];
+    if (step.numSources == 0) { ::memset(dest, 0, size * sizeof(T)); }
+    for (size_t i = 0; i < step.numSources; i++, source++) {
+      const T* src = source->buffer == Input ? in : this->buffer(source->buffer);
+      const T gain = source->gain;
+      if (i > 0) {
+        for (size_t j = 0; j < size; j++) { dest[j] += gain * src[j]; }
+      }
+      else if (gain != T(1)) {
+        for (size_t j = 0; j < size; j++) { dest[j] = gain * src[j]; }
+      }
+      else if (src != dest) { ::memmove(dest, src, size * sizeof(T)); }
+    }
+
+    const Node& node = this->nodes[step.node];
+    if (node.block) { node.block->processBlock(dest, dest, size); }
+    else if (node.effect) {
+      for (size_t j = 0; j < size; j++) { dest[j] = node.effect->processSample(dest[j]); }
+    }
+  }
+};
+
+} // namespace Jaffx
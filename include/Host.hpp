@@ -0,0 +1,170 @@
+#pragma once
+#include <cstdio>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <chrono>
+
+// Host (x86/Linux) stand-ins for the parts of libDaisy used by `Jaffx.hpp`,
+// enabled by defining `JAFFX_HOST`. See `host/` for the offline renderer.
+// Only audio, system and logging calls are provided; firmware that touches
+// other peripherals (adc, qspi, GPIO...) will not build on host.
+
+// libDaisy float print helpers, host printf handles floats directly
+#ifndef FLT_FMT3
+#define FLT_FMT3 "%.3f"
+#define FLT_VAR3(x) (double)(x)
+#endif
+
+// CMSIS-DSP stand-ins for `arm_math.h`
+inline float arm_sin_f32(float x) { return std::sin(x); }
+inline float arm_cos_f32(float x) { return std::cos(x); }
+
+namespace daisy {
+
+struct AudioHandle {
+  typedef const float* const* InputBuffer;
+  typedef float** OutputBuffer;
+  typedef void (*AudioCallback)(InputBuffer in, OutputBuffer out, size_t size);
+};
+
+struct SaiHandle {
+  struct Config {
+    enum class SampleRate { SAI_8KHZ, SAI_16KHZ, SAI_32KHZ, SAI_48KHZ, SAI_96KHZ };
+  };
+};
+
+class System {
+public:
+  enum class BootloaderMode { STM, DAISY, DAISY_SKIP_TIMEOUT, DAISY_INFINITE_TIMEOUT };
+
+  // No-op so the host renders as fast as possible
+  static void Delay(uint32_t delay_ms) { (void)delay_ms; }
+  static void DelayUs(uint32_t delay_us) { (void)delay_us; }
+
+  // Milliseconds/microseconds since first call
+  static uint32_t GetNow() { return uint32_t(elapsed<std::chrono::milliseconds>()); }
+  static uint32_t GetUs() { return uint32_t(elapsed<std::chrono::microseconds>()); }
+
+  // Free-running tick (1MHz here), wraps at 32 bits
+  static uint32_t GetTick() { return GetUs(); }
+  static uint32_t GetTickFreq() { return 1000000; }
+
+  static void ResetToBootloader(BootloaderMode mode = BootloaderMode::STM) { (void)mode; }
+
+private:
+  template <typename Duration>
+  static int64_t elapsed() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now() - start).count();
+  }
+};
+
+// Measures load against the real-time budget of each block, like libDaisy's
+class CpuLoadMeter {
+public:
+  void Init(float sampleRateInHz, int blockSizeInSamples, float smoothingFilterCutoffHz = 1.0f) {
+    (void)smoothingFilterCutoffHz;
+    budgetNs = double(blockSizeInSamples) / double(sampleRateInHz) * 1e9;
+    Reset();
+  }
+
+  void OnBlockStart() { blockStart = std::chrono::steady_clock::now(); }
+
+  void OnBlockEnd() {
+    const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - blockStart).count());
+    const float load = float(ns / budgetNs);
+    if (first) { avg = min = max = load; first = false; }
+    avg += (load - avg) * 0.01f;
+    if (load < min) { min = load; }
+    if (load > max) { max = load; }
+  }
+
+  float GetAvgCpuLoad() const { return avg; }
+  float GetMinCpuLoad() const { return min; }
+  float GetMaxCpuLoad() const { return max; }
+  void Reset() { first = true; avg = min = max = 0.f; }
+
+private:
+  std::chrono::steady_clock::time_point blockStart;
+  double budgetNs = 1.0;
+  bool first = true;
+  float avg = 0.f, min = 0.f, max = 0.f;
+};
+
+class DaisySeed {
+public:
+  System system;
+
+  void Init(bool boost = false) { (void)boost; }
+
+  void SetAudioBlockSize(size_t size) { blockSize = size; }
+  size_t AudioBlockSize() { return blockSize; }
+
+  void SetAudioSampleRate(SaiHandle::Config::SampleRate sr) {
+    switch (sr) {
+      case SaiHandle::Config::SampleRate::SAI_8KHZ: sampleRate = 8000.f; break;
+      case SaiHandle::Config::SampleRate::SAI_16KHZ: sampleRate = 16000.f; break;
+      case SaiHandle::Config::SampleRate::SAI_32KHZ: sampleRate = 32000.f; break;
+      case SaiHandle::Config::SampleRate::SAI_48KHZ: sampleRate = 48000.f; break;
+      case SaiHandle::Config::SampleRate::SAI_96KHZ: sampleRate = 96000.f; break;
+    }
+  }
+  float AudioSampleRate() { return sampleRate; }
+
+  // The host renderer drives the callback, see `Jaffx::Host::render()`
+  void StartAudio(AudioHandle::AudioCallback cb) { callback = cb; }
+  void StopAudio() { callback = nullptr; }
+
+  void SetLed(bool state) { (void)state; }
+
+  static void StartLog(bool wait_for_pc = false) { (void)wait_for_pc; }
+
+  static void Print(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+  }
+
+  static void PrintLine(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+  }
+
+  AudioHandle::AudioCallback callback = nullptr;
+
+private:
+  size_t blockSize = 48;
+  float sampleRate = 48000.f;
+};
+
+} // namespace daisy
+
+namespace Jaffx {
+namespace Host {
+
+/**
+ * @brief Offline render of an audio callback, defined in `host/render.cpp`
+ *
+ * Feeds the callback blocks from a WAV file or generated signal as fast as
+ * possible, writes the output to a WAV file and reports throughput.
+ *
+ * @param callback the firmware's audio callback
+ * @param blockSize samples per callback
+ * @param sampleRate sample rate of generated signals and the output file
+ * @param idle called between blocks to emulate the main loop, may be `nullptr`
+ * @param context passed to `idle`
+ * @return process exit status
+ */
+int render(daisy::AudioHandle::AudioCallback callback, size_t blockSize, float sampleRate,
+           void (*idle)(void*), void* context);
+
+} // namespace Host
+} // namespace Jaffx
@@ -0,0 +1,280 @@
+#pragma once
+#include <memory> // for unique_ptr
+#include <new> // for placement new
+#include <utility> // for std::forward
+#include <cstring>
+#include <stddef.h>
+#include <stdint.h>
+#include "SDRAM.hpp" // for mSDRAM, the external heap
+#include "Tlsf.hpp"
+
+namespace Jaffx {
+
+// Size of the fast (DTCM) heap in bytes, set with `FAST_HEAP_SIZE` in common.mk
+#ifndef JAFFX_FAST_HEAP_SIZE
+#define JAFFX_FAST_HEAP_SIZE 65536
+#endif
+
+// `Placement::Auto` allocations up to this size go to the fast heap,
+// set with `FAST_ALLOC_THRESHOLD` in common.mk
+#ifndef JAFFX_FAST_THRESHOLD
+#define JAFFX_FAST_THRESHOLD 1024
+#endif
+
+#ifndef JAFFX_MEMORY_MAX_TAGS
+#define JAFFX_MEMORY_MAX_TAGS 16
+#endif
+
+// libDaisy places this in the Cortex-M7's tightly coupled data RAM
+#ifndef DTCM_MEM_SECTION
+#ifdef JAFFX_HOST
+#define DTCM_MEM_SECTION
+#else
+#define DTCM_MEM_SECTION __attribute__((section(".dtcmram_bss")))
+#endif
+#endif
+
+// Where an allocation should live
+enum class Placement {
+  Auto, // fast if no larger than `JAFFX_FAST_THRESHOLD`, otherwise external
+  Fast, // internal DTCM: zero wait states, but small
+  External // SDRAM: large, but much slower to access
+};
+
+#if JAFFX_FAST_HEAP_SIZE > 0
+DTCM_MEM_SECTION alignas(8) unsigned char fastHeapMemory[JAFFX_FAST_HEAP_SIZE];
+#endif
+
+/**
+ * @brief Placement-aware allocator over the fast (DTCM) heap and SDRAM
+ *
+ * Small, hot state (filter coefficients and histories, per-sample model
+ * state) belongs in internal memory, large cold buffers (delay lines) in
+ * SDRAM. Allocations pick a region from an explicit `Placement`, or by
+ * size for `Placement::Auto`, and fall back to SDRAM when the fast heap is
+ * full. `Scope` sets a default placement and a tag for everything allocated
+ * while it lives (including by `giml` effects), and `report()` lists how
+ * many bytes each tag placed in each region.
+ */
+class Memory {
+public:
+  enum class Region { None, Fast, External };
+
+  struct TagStats {
+    const char* name = nullptr;
+    size_t fastBytes = 0, externalBytes = 0;
+    uint32_t fastCount = 0, externalCount = 0;
+    size_t fallbackBytes = 0; // of `externalBytes`, placed fast but the fast heap was full
+    uint32_t fallbackCount = 0;
+  };
+
+private:
+  Tlsf fastHeap;
+  Placement defaultPlacement = Placement::Auto;
+  const char* currentTag = nullptr;
+  TagStats tags[JAFFX_MEMORY_MAX_TAGS];
+  size_t numTags = 0;
+
+public:
+  // Needs to be called AFTER `mSDRAM.init()`
+  void init() {
+#if JAFFX_FAST_HEAP_SIZE > 0
+    this->fastHeap.init(fastHeapMemory, sizeof(fastHeapMemory));
+#endif
+  }
+
+  // Default placement and tag for allocations without an explicit placement
+  void setPlacement(Placement placement) { this->defaultPlacement = placement; }
+  void setTag(const char* tag) { this->currentTag = tag; }
+
+  /**
+   * @brief Sets a default placement and tag until destroyed
+   *
+   * @code
+   * { Jaffx::Memory::Scope scope(Jaffx::Placement::Fast, "amp"); mAmp = ...; }
+   * @endcode
+   */
+  class Scope {
+    Placement previousPlacement;
+    const char* previousTag;
+  public:
+    Scope(Placement placement, const char* tag = nullptr);
+    Scope(const char* tag);
+    ~Scope();
+  };
+
+  // Resolves `Auto` (and the default placement) to a concrete one
+  Placement resolve(size_t size, Placement placement = Placement::Auto) const {
+    if (placement == Placement::Auto) { placement = this->defaultPlacement; }
+    if (placement == Placement::Auto) {
+      placement = (size <= JAFFX_FAST_THRESHOLD) ? Placement::Fast : Placement::External;
+    }
+    return placement;
+  }
+
+  /**
+   * @brief Allocates from the fast heap only, without falling back
+   *
+   * @return `nullptr` if the fast heap is full (or disabled)
+   */
+  void* allocateFast(size_t size) {
+    void* ptr = this->fastHeap.malloc(size);
+    if (ptr) { this->record(Region::Fast, size); }
+    return ptr;
+  }
+
+  // Allocates from SDRAM
+  void* allocateExternal(size_t size) {
+    void* ptr = mSDRAM.malloc(size);
+    if (ptr) { this->record(Region::External, size); }
+    return ptr;
+  }
+
+  // Allocates `size` bytes where `placement` says, falling back to SDRAM (counted per tag)
+  void* allocate(size_t size, Placement placement = Placement::Auto) {
+    if (this->resolve(size, placement) == Placement::Fast) {
+      void* ptr = this->allocateFast(size);
+      if (ptr) { return ptr; }
+      ptr = this->allocateExternal(size);
+      if (ptr) { this->recordFallback(size); }
+      return ptr;
+    }
+    return this->allocateExternal(size);
+  }
+
+  void* allocateZeroed(size_t numElements, size_t size, Placement placement = Placement::Auto) {
+    if (size && numElements > size_t(-1) / size) { return nullptr; } // overflow
+    void* ptr = this->allocate(numElements * size, placement);
+    if (ptr) { ::memset(ptr, 0, numElements * size); }
+    return ptr;
+  }
+
+  // Resizes within the allocation's region, moving to SDRAM if the fast heap is full
+  void* reallocate(void* ptr, size_t size) {
+    if (!ptr) { return this->allocate(size); }
+    if (!this->fastHeap.owns(ptr)) { return mSDRAM.realloc(ptr, size); }
+    if (size == 0) { this->fastHeap.free(ptr); return nullptr; }
+    void* resized = this->fastHeap.realloc(ptr, size);
+    if (resized) { return resized; }
+    void* moved = this->allocateExternal(size);
+    if (!moved) { return nullptr; }
+    this->recordFallback(size);
+    const size_t old = Tlsf::usableSize(ptr);
+    ::memcpy(moved, ptr, old < size ? old : size);
+    this->fastHeap.free(ptr);
+    return moved;
+  }
+
+  void free(void* ptr) {
+    if (this->fastHeap.owns(ptr)) { this->fastHeap.free(ptr); }
+    else { mSDRAM.free(ptr); }
+  }
+
+  Region regionOf(const void* ptr) const {
+    if (this->fastHeap.owns(ptr)) { return Region::Fast; }
+    if (mSDRAM.owns(ptr)) { return Region::External; }
+    return Region::None;
+  }
+
+  // Tracks an allocation made elsewhere (e.g. by `mArena`) under the current tag
+  void record(Region region, size_t size) {
+    TagStats* stats = this->findTag(this->currentTag);
+    if (!stats) { return; }
+    if (region == Region::Fast) { stats->fastBytes += size; stats->fastCount++; }
+    else { stats->externalBytes += size; stats->externalCount++; }
+  }
+
+  // Prints bytes (and allocation counts) placed in each region per tag, then both heaps' stats
+  template <typename Printer>
+  void report(Printer print) const {
+    print("Memory placement (fast heap %lu bytes, threshold %lu bytes):",
+          (unsigned long)JAFFX_FAST_HEAP_SIZE, (unsigned long)JAFFX_FAST_THRESHOLD);
+    for (size_t i = 0; i < this->numTags; i++) {
+      const TagStats& t = this->tags[i];
+      print("%s: fast %lu (%lu), external %lu (%lu)", t.name ? t.name : "(untagged)",
+            (unsigned long)t.fastBytes, (unsigned long)t.fastCount,
+            (unsigned long)t.externalBytes, (unsigned long)t.externalCount);
+      if (t.fallbackCount) {
+        print("  %lu bytes (%lu) placed fast went to SDRAM, the fast heap was full",
+              (unsigned long)t.fallbackBytes, (unsigned long)t.fallbackCount);
+      }
+    }
+    print("Fast heap:");
+    this->fastHeap.report(print);
+    print("SDRAM:");
+    mSDRAM.report(print);
+  }
+
+  const Tlsf& getFastHeap() const { return this->fastHeap; }
+
+  const TagStats* getTags() const { return this->tags; }
+  size_t getNumTags() const { return this->numTags; }
+
+  // Allocations placed fast that went to SDRAM, over all tags
+  uint32_t getFallbacks() const {
+    uint32_t count = 0;
+    for (size_t i = 0; i < this->numTags; i++) { count += this->tags[i].fallbackCount; }
+    return count;
+  }
+
+private:
+  void recordFallback(size_t size) {
+    TagStats* stats = this->findTag(this->currentTag);
+    if (!stats) { return; }
+    stats->fallbackBytes += size;
+    stats->fallbackCount++;
+  }
+
+  TagStats* findTag(const char* name) {
+    for (size_t i = 0; i < this->numTags; i++) {
+      if (this->tags[i].name == name) { return &this->tags[i]; }
+    }
+    if (this->numTags >= JAFFX_MEMORY_MAX_TAGS) { return nullptr; }
+    TagStats* stats = &this->tags[this->numTags++];
+    stats->name = name;
+    return stats;
+  }
+};
+
+Memory mMemory; // global instance of the placement-aware allocator
+
+inline Memory::Scope::Scope(Placement placement, const char* tag)
+  : previousPlacement(mMemory.defaultPlacement), previousTag(mMemory.currentTag) {
+  mMemory.setPlacement(placement);
+  mMemory.setTag(tag);
+}
+
+inline Memory::Scope::Scope(const char* tag) : Scope(mMemory.defaultPlacement, tag) {}
+
+inline Memory::Scope::~Scope() {
+  mMemory.setPlacement(this->previousPlacement);
+  mMemory.setTag(this->previousTag);
+}
+
+// Deleter for objects created with `makePlaced()`
+template <typename T>
+struct PlacedDeleter {
+  void operator()(T* object) const {
+    if (!object) { return; }
+    object->~T();
+    mMemory.free(object);
+  }
+};
+
+template <typename T>
+using PlacedPtr = std::unique_ptr<T, PlacedDeleter<T>>;
+
+/**
+ * @brief Constructs a `T` in the region chosen by `placement`,
+ * e.g. an effect whose per-sample state should live in fast memory
+ *
+ * @return the object, or an empty pointer if out of memory
+ */
+template <typename T, typename... Args>
+PlacedPtr<T> makePlaced(Placement placement, Args&&... args) {
+  void* memory = mMemory.allocate(sizeof(T), placement);
+  if (!memory) { return PlacedPtr<T>(); }
+  return PlacedPtr<T>(new (memory) T(std::forward<Args>(args)...));
+}
+
+} // namespace Jaffx
@@ -0,0 +1,212 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include "ModelFile.hpp"
+
+namespace Jaffx {
+
+/**
+ * @brief Bank of neural models sharing one architecture, with only the
+ * active one materialized
+ *
+ * Models are registered as pointers to their weights, which stay where they
+ * are (const arrays in the firmware image, memory-mapped QSPI, or a buffer
+ * filled from SD by `Jaffx::ModelFile`). Only the active network's state is
+ * allocated. Switching loads the requested
+ * weights into a second network in the main loop (`update()`), then the
+ * audio callback runs both for `fadeLength` samples while crossfading, and
+ * the old network is freed by the next `update()`.
+ *
+ * `Model` needs `loadModel(const float*, size_t, const int8_t*)`,
+ * `process(in, out, size)` and `maxBlock()`, e.g. `Jaffx::wavenet::Wavenet`
+ * or `Jaffx::wavenet::QuantizedWavenet`. Include after `Jaffx.hpp`.
+ *
+ * @code
+ * bank.add("dumble", DumbleModel_weights, DumbleModel_weights_len);
+ * bank.add("marshall", MarshallModel_weights, MarshallModel_weights_len);
+ * bank.load(0); // in init()
+ * bank.select(1); // from anywhere
+ * bank.update(); // in loop()
+ * bank.process(in, out, size); // in the audio callback
+ * @endcode
+ */
+template <typename Model, size_t MaxModels = 8>
+class ModelBank {
+public:
+  struct Entry {
+    const char* name;
+    const float* weights;
+    size_t count;
+    const int8_t* calibration; // for quantized models, may be nullptr
+  };
+
+private:
+  typedef float T;
+  enum Stage { IDLE, READY, FADING, DONE }; // IDLE/DONE owned by `update()`, READY/FADING by `process()`
+
+  Entry entries[MaxModels] = {};
+  size_t numModels = 0;
+  Placement placement = Placement::Auto;
+
+  Model* active = nullptr;
+  Model* incoming = nullptr; // loaded by `update()`, faded in by `process()`
+  Model* retired = nullptr; // faded out, freed by `update()`
+  std::atomic<int> stage{IDLE};
+  std::atomic<int> requested{-1};
+  int current = -1;
+  int incomingIndex = -1;
+  size_t fadeLength = 1024; // samples
+  size_t fadePosition = 0;
+  T fadeBuffer[Model::maxBlock()];
+
+  Model* create(int index) {
+    Model* model = makePlaced<Model>(this->placement).release();
+    const Entry& entry = this->entries[index];
+    if (model && !model->loadModel(entry.weights, entry.count, entry.calibration)) {
+      this->destroy(model);
+      model = nullptr;
+    }
+    return model;
+  }
+
+  void destroy(Model*& model) {
+    PlacedDeleter<Model>()(model);
+    model = nullptr;
+  }
+
+public:
+  ModelBank() {}
+  ~ModelBank() {
+    this->destroy(this->active);
+    this->destroy(this->incoming);
+    this->destroy(this->retired);
+  }
+
+  //Have copy & copy-assignment constructors disabled, the bank owns its networks
+  ModelBank(const ModelBank&) = delete;
+  void operator=(const ModelBank&) = delete;
+
+  /**
+   * @brief Registers a model, the weights (and calibration) must outlive the bank
+   *
+   * @return its index, or -1 if the bank is full
+   */
+  int add(const char* name, const float* weights, size_t count, const int8_t* calibration = nullptr) {
+    if (this->numModels >= MaxModels) { return -1; }
+    this->entries[this->numModels] = { name, weights, count, calibration };
+    return int(this->numModels++);
+  }
+
+  /**
+   * @brief Registers a model loaded by `Jaffx::ModelFile`, whose weights must outlive the bank
+   *
+   * @return its index, or -1 if the bank is full or the file's architecture isn't `Model`'s
+   */
+  int add(const char* name, const ModelFile& file) {
+    if (!file.template matches<Model>()) { return -1; }
+    return this->add(name, file.weights(), file.numWeights(), file.calibration());
+  }
+
+  // Where networks are allocated, see `Jaffx::Placement`
+  void setPlacement(Placement where) { this->placement = where; }
+
+  // Crossfade length in samples
+  void setFadeLength(size_t samples) { this->fadeLength = samples ? samples : 1; }
+
+  /**
+   * @brief Makes `index` active immediately, without a crossfade
+   *
+   * Not thread-safe with `process()`, call from `init()`.
+   * @return false if the model failed to load (wrong architecture or out of memory)
+   */
+  bool load(int index) {
+    if (index < 0 || size_t(index) >= this->numModels) { return false; }
+    Model* model = this->create(index);
+    if (!model) { return false; }
+    this->destroy(this->active);
+    this->active = model;
+    this->current = index;
+    this->requested.store(index);
+    return true;
+  }
+
+  // Requests a switch to `index`, carried out by `update()`
+  void select(int index) {
+    if (index >= 0 && size_t(index) < this->numModels) { this->requested.store(index); }
+  }
+
+  /**
+   * @brief Loads a requested model and frees faded-out ones
+   *
+   * Allocates and prewarms a whole network, call from the main loop.
+   */
+  void update() {
+    if (this->stage.load(std::memory_order_acquire) == DONE) {
+      this->destroy(this->retired);
+      this->stage.store(IDLE, std::memory_order_release);
+    }
+    if (this->stage.load(std::memory_order_acquire) != IDLE) { return; }
+    const int index = this->requested.load();
+    if (index < 0 || index == this->current) { return; }
+    this->incoming = this->create(index);
+    if (!this->incoming) { this->requested.store(this->current); return; } // stay on the current model
+    this->incomingIndex = index;
+    this->stage.store(READY, std::memory_order_release);
+  }
+
+  // Processes `size` samples through the active model, crossfading while switching
+  void process(const T* in, T* out, size_t size) {
+    if (!this->active) {
+      for (size_t i = 0; i < size; i++) { out[i] = 0; }
+      return;
+    }
+    int stage = this->stage.load(std::memory_order_acquire);
+    if (stage == READY) {
+      this->fadePosition = 0;
+      stage = FADING;
+      this->stage.store(FADING, std::memory_order_relaxed);
+    }
+    if (stage != FADING) {
+      this->active->process(in, out, size);
+      return;
+    }
+
+    while (size > 0) {
+      const size_t n = size < size_t(Model::maxBlock()) ? size : size_t(Model::maxBlock());
+      this->incoming->process(in, this->fadeBuffer, n);
+      this->active->process(in, out, n);
+      for (size_t i = 0; i < n; i++) {
+        const T gain = this->fadePosition < this->fadeLength ? T(this->fadePosition) / T(this->fadeLength) : T(1);
+        out[i] += gain * (this->fadeBuffer[i] - out[i]);
+        this->fadePosition++;
+      }
+      in += n;
+      out += n;
+      size -= n;
+    }
+
+    if (this->fadePosition >= this->fadeLength) {
+      this->retired = this->active;
+      this->active = this->incoming;
+      this->incoming = nullptr;
+      this->current = this->incomingIndex;
+      this->stage.store(DONE, std::memory_order_release);
+    }
+  }
+
+  T forward(T input) {
+    T output;
+    this->process(&input, &output, 1);
+    return output;
+  }
+
+  int getActive() const { return this->current; }
+  // Where the active network ended up, `Placement::Fast` falls back to SDRAM when the fast heap is full
+  Memory::Region getRegion() const { return mMemory.regionOf(this->active); }
+  bool isSwitching() const { return this->stage.load() != IDLE; }
+  size_t size() const { return this->numModels; }
+  const Entry& operator[](size_t index) const { return this->entries[index]; }
+};
+
+} // namespace Jaffx
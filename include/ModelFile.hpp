@@ -0,0 +1,216 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <stddef.h>
+#include <stdint.h>
+#include "Crc32.hpp"
+
+namespace Jaffx {
+
+/**
+ * @brief Reader for `.jnam` binary NAM WaveNet models, written by
+ * `examples/namTest/namToBinary.py`
+ *
+ * Layout (little-endian): a `Header`, `numArrays` `LayerArrayInfo`s, from
+ * version 2 the calibrated residual formats of `QuantizedWavenet` (one
+ * int8 per layer plus one per array), then `numWeights` float32 weights in
+ * `.nam` order at `weightsOffset` (4-byte aligned), checksummed by
+ * `weightsCrc` (CRC-32).
+ *
+ * `parse()` validates a model that is already in memory (e.g. memory-mapped
+ * QSPI, `hardware.qspi.GetData()`) and points straight at its weights, no
+ * copy. `read()` streams a model from a file (e.g. SD card through
+ * `FatFsReader`) into a preallocated buffer. Either way, `weights()` can be
+ * handed to `Jaffx::ModelBank::add()` once `matches<Model>()` confirms the
+ * architecture.
+ */
+class ModelFile {
+public:
+  static const uint32_t MAGIC = 0x4D414E4A; // "JNAM"
+  static const uint16_t VERSION = 2; // 1 has no calibration
+  static const int MAX_ARRAYS = 4;
+  static const int MAX_DILATIONS = 32;
+
+  struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t numArrays;
+    uint32_t numWeights;
+    uint32_t sampleRate; // 0 if unknown
+    uint32_t weightsOffset; // bytes from the start of the file
+    uint32_t weightsCrc;
+  };
+
+  struct LayerArrayInfo {
+    uint16_t inputSize, conditionSize, headSize, channels, kernelSize, headBias, numDilations, reserved;
+    uint16_t dilations[MAX_DILATIONS];
+  };
+
+  static_assert(sizeof(Header) == 24, "Header must match namToBinary.py");
+  static_assert(sizeof(LayerArrayInfo) == 80, "LayerArrayInfo must match namToBinary.py");
+
+  enum class Error { None, Truncated, BadMagic, BadVersion, BadLayout, BadChecksum, TooLarge };
+
+private:
+  Header header = {};
+  LayerArrayInfo arrays[MAX_ARRAYS] = {};
+  int8_t residualBits[MAX_ARRAYS * (MAX_DILATIONS + 1)] = {};
+  size_t numResidualBits = 0;
+  const float* pWeights = nullptr;
+  Error error = Error::None;
+
+  bool fail(Error e) {
+    this->error = e;
+    this->pWeights = nullptr;
+    return false;
+  }
+
+  // checks the header and array infos once read, and sizes the calibration after them
+  bool validate(size_t fileSize) {
+    const Header& h = this->header;
+    if (h.magic != MAGIC) { return this->fail(Error::BadMagic); }
+    if (h.version == 0 || h.version > VERSION) { return this->fail(Error::BadVersion); }
+    if (h.numArrays == 0 || h.numArrays > MAX_ARRAYS) { return this->fail(Error::BadLayout); }
+    this->numResidualBits = 0;
+    for (int i = 0; i < h.numArrays; i++) {
+      if (this->arrays[i].numDilations > MAX_DILATIONS) { return this->fail(Error::BadLayout); }
+      if (h.version >= 2) { this->numResidualBits += this->arrays[i].numDilations + 1; }
+    }
+    if (h.weightsOffset % 4 != 0 ||
+        h.weightsOffset < sizeof(Header) + h.numArrays * sizeof(LayerArrayInfo) + this->numResidualBits) {
+      return this->fail(Error::BadLayout);
+    }
+    if (fileSize < h.weightsOffset || (fileSize - h.weightsOffset) / sizeof(float) < h.numWeights) {
+      return this->fail(Error::Truncated);
+    }
+    return true;
+  }
+
+public:
+  /**
+   * @brief Validates a model in memory, `weights()` then points into `data`
+   *
+   * `data` must be 4-byte aligned and outlive the use of `weights()`.
+   */
+  bool parse(const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    if (!data || size < sizeof(Header) || (uintptr_t(data) & 3)) { return this->fail(Error::Truncated); }
+    ::memcpy(&this->header, bytes, sizeof(Header));
+    const size_t arraysSize = size_t(this->header.numArrays) * sizeof(LayerArrayInfo);
+    if (this->header.numArrays > MAX_ARRAYS) { return this->fail(Error::BadLayout); }
+    if (size < sizeof(Header) + arraysSize) { return this->fail(Error::Truncated); }
+    ::memcpy(this->arrays, bytes + sizeof(Header), arraysSize);
+    if (!this->validate(size)) { return false; }
+    ::memcpy(this->residualBits, bytes + sizeof(Header) + arraysSize, this->numResidualBits);
+
+    const void* weights = bytes + this->header.weightsOffset;
+    if (crc32(weights, this->header.numWeights * sizeof(float)) != this->header.weightsCrc) {
+      return this->fail(Error::BadChecksum);
+    }
+    this->pWeights = (const float*)weights;
+    this->error = Error::None;
+    return true;
+  }
+
+  /**
+   * @brief Streams a model into `buffer`, `weights()` then points at it
+   *
+   * Nothing is allocated, so this can run on a preset change as long as it's
+   * from the main loop (file access blocks).
+   * @param reader anything with `size_t read(void* dst, size_t bytes)`, reading sequentially
+   * @param capacity of `buffer` in floats
+   */
+  template <typename Reader>
+  bool read(Reader& reader, float* buffer, size_t capacity) {
+    if (reader.read(&this->header, sizeof(Header)) != sizeof(Header)) { return this->fail(Error::Truncated); }
+    if (this->header.numArrays > MAX_ARRAYS) { return this->fail(Error::BadLayout); }
+    const size_t arraysSize = size_t(this->header.numArrays) * sizeof(LayerArrayInfo);
+    if (reader.read(this->arrays, arraysSize) != arraysSize) { return this->fail(Error::Truncated); }
+    if (!this->validate(size_t(-1))) { return false; }
+    if (this->header.numWeights > capacity) { return this->fail(Error::TooLarge); }
+    if (reader.read(this->residualBits, this->numResidualBits) != this->numResidualBits) {
+      return this->fail(Error::Truncated);
+    }
+
+    // skip any padding up to the weights
+    size_t position = sizeof(Header) + arraysSize + this->numResidualBits;
+    while (position < this->header.weightsOffset) {
+      unsigned char pad;
+      if (reader.read(&pad, 1) != 1) { return this->fail(Error::Truncated); }
+      position++;
+    }
+
+    const size_t bytes = this->header.numWeights * sizeof(float);
+    if (reader.read(buffer, bytes) != bytes) { return this->fail(Error::Truncated); }
+    if (crc32(buffer, bytes) != this->header.weightsCrc) { return this->fail(Error::BadChecksum); }
+    this->pWeights = buffer;
+    this->error = Error::None;
+    return true;
+  }
+
+  /**
+   * @brief Whether the model has exactly the architecture of a
+   * two-array `Jaffx::wavenet::Wavenet`
+   */
+  template <typename Model>
+  bool matches() const {
+    return this->pWeights && this->header.numArrays == 2 &&
+           this->header.numWeights == uint32_t(Model::numWeights()) &&
+           matchesArray<typename Model::LayerArray1>(this->arrays[0]) &&
+           matchesArray<typename Model::LayerArray2>(this->arrays[1]);
+  }
+
+  const float* weights() const { return this->pWeights; }
+  size_t numWeights() const { return this->pWeights ? this->header.numWeights : 0; }
+  uint32_t sampleRate() const { return this->header.sampleRate; }
+
+  // Calibrated residual formats for `QuantizedWavenet::loadModel()`, nullptr if the file has none
+  const int8_t* calibration() const { return this->pWeights && this->numResidualBits ? this->residualBits : nullptr; }
+  int numArrays() const { return this->header.numArrays; }
+  const LayerArrayInfo& array(int index) const { return this->arrays[index]; }
+  Error getError() const { return this->error; }
+
+private:
+  template <typename Config>
+  static bool matchesArray(const LayerArrayInfo& info) {
+    if (info.inputSize != Config::inputSize || info.conditionSize != 1 || info.headSize != Config::headSize ||
+        info.channels != Config::channels || info.kernelSize != Config::kernelSize ||
+        bool(info.headBias) != Config::headBias || info.numDilations != Config::numLayers) {
+      return false;
+    }
+    for (int i = 0; i < Config::numLayers; i++) {
+      if (info.dilations[i] != Config::dilation(i)) { return false; }
+    }
+    return true;
+  }
+};
+
+#ifdef JAFFX_HOST
+// `ModelFile::read()` adapter for a stdio `FILE*`
+struct StdioReader {
+  FILE* file;
+  size_t read(void* dst, size_t bytes) { return fread(dst, 1, bytes, this->file); }
+};
+#endif
+
+/**
+ * @brief `ModelFile::read()` adapter for an open FatFs file (SD card)
+ *
+ * @code
+ * FIL file;
+ * f_open(&file, "amp.jnam", FA_READ);
+ * Jaffx::FatFsReader<FIL> reader{&file};
+ * bool ok = model.read(reader, buffer, capacity);
+ * f_close(&file);
+ * @endcode
+ */
+template <typename File>
+struct FatFsReader {
+  File* file;
+  size_t read(void* dst, size_t bytes) {
+    unsigned int got = 0; // `UINT`
+    return f_read(this->file, dst, (unsigned int)bytes, &got) == 0 ? got : 0;
+  }
+};
+
+} // namespace Jaffx
@@ -0,0 +1,187 @@
+#pragma once
+#include "EffectsLine.hpp"
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace Jaffx {
+
+/**
+ * @brief Polyphase half-band filter, for 2x interpolation and decimation
+ *
+ * A linear-phase lowpass at a quarter of the higher rate, with `4 * K - 1`
+ * taps designed with a Kaiser window of shape `beta`. Every other tap of a
+ * half-band filter is zero apart from the centre one (0.5), so split into its
+ * two phases it costs `K` multiplies per lower-rate sample each way.
+ *
+ * Blocks are filtered through linear histories, like `Jaffx::wavenet`, so the
+ * inner loops vectorize. Each direction has its own state, one instance can
+ * upsample into an effect and downsample its output.
+ */
+template <typename T, int K, int MaxBlock>
+class Halfband {
+  static_assert(K > 0, "Halfband needs at least one coefficient");
+
+public:
+  static constexpr int numTaps = 4 * K - 1;
+
+  explicit Halfband(double beta) {
+    // windowed sinc h[i] = sin(pi d / 2) / (pi d) * w(d), d = i - (2K - 1), at the odd d
+    const double center = 2 * K - 1, pi = 3.14159265358979323846;
+    double sum = 0.0;
+    double design[K];
+    for (int p = 0; p < K; p++) {
+      const double d = 2 * p - center, r = d / center;
+      design[p] = std::sin(pi * d / 2.0) / (pi * d) * bessel(beta * std::sqrt(1.0 - r * r)) / bessel(beta);
+      sum += 2.0 * design[p];
+    }
+    // normalize the odd phase to 0.5, for unity gain at DC
+    for (int p = 0; p < K; p++) { this->coefficients[p] = T(0.5 * design[p] / sum); }
+    this->reset();
+  }
+
+  void reset() {
+    ::memset(this->upHistory, 0, sizeof(this->upHistory));
+    ::memset(this->evenHistory, 0, sizeof(this->evenHistory));
+    ::memset(this->oddHistory, 0, sizeof(this->oddHistory));
+  }
+
+  // Latency of interpolation followed by decimation, in lower-rate samples
+  static constexpr int latency() { return 2 * K - 1; }
+
+  // Interpolates `size` samples of `in` to `2 * size` samples of `out`
+  void upsample(const T* in, T* out, int size) {
+    T* x = this->upHistory + (2 * K - 1);
+    ::memcpy(x, in, size * sizeof(T));
+    for (int n = 0; n < size; n++) {
+      T sum = 0;
+      for (int p = 0; p < K; p++) { sum += this->coefficients[p] * (x[n - p] + x[n - (2 * K - 1) + p]); }
+      out[2 * n] = 2 * sum;
+      out[2 * n + 1] = x[n - K + 1];
+    }
+    ::memmove(this->upHistory, this->upHistory + size, (2 * K - 1) * sizeof(T));
+  }
+
+  // Decimates `2 * size` samples of `in` to `size` samples of `out`, `in` and `out` may alias
+  void downsample(const T* in, T* out, int size) {
+    T* even = this->evenHistory + (2 * K - 1);
+    T* odd = this->oddHistory + K;
+    for (int n = 0; n < size; n++) {
+      even[n] = in[2 * n];
+      odd[n] = in[2 * n + 1];
+    }
+    for (int n = 0; n < size; n++) {
+      T sum = T(0.5) * odd[n - K];
+      for (int p = 0; p < K; p++) { sum += this->coefficients[p] * (even[n - p] + even[n - (2 * K - 1) + p]); }
+      out[n] = sum;
+    }
+    ::memmove(this->evenHistory, this->evenHistory + size, (2 * K - 1) * sizeof(T));
+    ::memmove(this->oddHistory, this->oddHistory + size, K * sizeof(T));
+  }
+
+private:
+  T coefficients[K]; // first half of the odd phase, the other half mirrors it
+  T upHistory[2 * K - 1 + MaxBlock];
+  T evenHistory[2 * K - 1 + MaxBlock];
+  T oddHistory[K + MaxBlock];
+
+  // modified Bessel function of the first kind, order 0 (for the Kaiser window)
+  static double bessel(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+      term *= (x / (2.0 * k)) * (x / (2.0 * k));
+      sum += term;
+    }
+    return sum;
+  }
+};
+
+/**
+ * @brief Runs an effect at 2x or 4x the sample rate, to reduce aliasing
+ *
+ * Nonlinear effects (waveshapers, saturation, clipping) create harmonics above
+ * Nyquist which fold back as inharmonic aliases. This upsamples each block
+ * with half-band filters, runs the hosted effect over it, and decimates the
+ * result. 4x cascades a steep 2x stage with a cheap one, since the second only
+ * has to reject images above the first's passband.
+ *
+ * The hosted effect must be constructed for `sampleRate * Factor`, and sees
+ * blocks of up to `Factor * MaxBlock` samples. Toggle the hosted effect rather
+ * than the wrapper to keep the latency constant, disabling the wrapper also
+ * bypasses the filters.
+ *
+ * @code
+ * giml::Distortion<float> distortion{samplerate * 4};
+ * Jaffx::Oversampled<float, 4> oversampled{distortion};
+ * line.pushBack(&oversampled, "distortion x4");
+ * @endcode
+ *
+ * See `host/bench/oversampling.cpp` for its cost and alias suppression.
+ */
+template <typename T, int Factor, int MaxBlock = 128>
+class Oversampled : public BlockEffect<T> {
+  static_assert(Factor == 2 || Factor == 4, "Oversampled supports 2x and 4x");
+
+public:
+  explicit Oversampled(giml::Effect<T>& effect) : effect(&effect), blockEffect(nullptr) { this->enable(); }
+  explicit Oversampled(BlockEffect<T>& effect) : effect(&effect), blockEffect(&effect) { this->enable(); }
+
+  // Clears the filters' state
+  void reset() {
+    this->first.reset();
+    this->second.reset();
+  }
+
+  // Latency in samples at the base rate (rounded down at 4x)
+  static constexpr int latency() { return First::latency() + (Factor == 4 ? Second::latency() / 2 : 0); }
+
+  // Prefer `processBlock()`, each call filters a block of 1
+  T processSample(const T& input) override {
+    T output;
+    this->processBlock(&input, &output, 1);
+    return output;
+  }
+
+  void processBlock(const T* in, T* out, size_t size) override {
+    if (!this->enabled) {
+      if (out != in) { ::memmove(out, in, size * sizeof(T)); }
+      return;
+    }
+    while (size > 0) {
+      const int n = size < size_t(MaxBlock) ? int(size) : MaxBlock;
+      this->first.upsample(in, this->buffer2x, n);
+      if (Factor == 4) {
+        this->second.upsample(this->buffer2x, this->buffer4x, 2 * n);
+        this->run(this->buffer4x, 4 * n);
+        this->second.downsample(this->buffer4x, this->buffer2x, 2 * n);
+      }
+      else { this->run(this->buffer2x, 2 * n); }
+      this->first.downsample(this->buffer2x, out, n);
+      in += n;
+      out += n;
+      size -= n;
+    }
+  }
+
+private:
+  // 63 taps, ~80 dB stopband from 0.29 of the 2x rate (27.8kHz at 48kHz)
+  using First = Halfband<T, 16, MaxBlock>;
+  // 23 taps, ~100 dB stopband above the first stage's passband (a stub at 2x)
+  using Second = typename std::conditional<Factor == 4, Halfband<T, 6, 2 * MaxBlock>, Halfband<T, 1, 1>>::type;
+
+  giml::Effect<T>* effect;
+  BlockEffect<T>* blockEffect; // `effect` if it processes blocks, `nullptr` otherwise
+  First first{8.0};
+  Second second{10.0};
+  T buffer2x[2 * MaxBlock];
+  T buffer4x[Factor == 4 ? 4 * MaxBlock : 1];
+
+  void run(T* buffer, int size) {
+    if (this->blockEffect) { this->blockEffect->processBlock(buffer, buffer, size); }
+    else {
+      for (int i = 0; i < size; i++) { buffer[i] = this->effect->processSample(buffer[i]); }
+    }
+  }
+};
+
+} // namespace Jaffx
@@ -0,0 +1,228 @@
+#pragma once
+#include "Ramp.hpp"
+#include <math.h>
+#include <stddef.h>
+
+namespace Jaffx {
+
+// How a param's normalized value (0 to 1) maps to its range
+enum class Taper {
+  Linear,
+  Exponential // equal ratios per step, for times and frequencies (`min` > 0)
+};
+
+// How often a param's value moves towards a new target
+enum class Smoothing {
+  None, // jumps
+  Block, // a step per `ParamRegistry::dispatch()`
+  Sample // a step per `Param::nextSample()`
+};
+
+/**
+ * @brief Parameter with a range and taper, stored as a normalized value
+ *
+ * The normalized value (0 to 1, what knobs and presets edit) lives in
+ * `storage` when given, e.g. a field of a settings struct, so presets can be
+ * recalled by writing the struct. `set()` and `nudge()` clamp it, which
+ * replaces clamping by hand. `getValue()` is the value in range, smoothed
+ * towards `getTarget()` once the param is updated by a `ParamRegistry`.
+ */
+template <typename T>
+class Param {
+public:
+  Param() = default; // 0 to 1, linear
+
+  Param(const char* name, T min, T max, Taper taper = Taper::Linear, T* storage = nullptr)
+    : name(name), min(min), max(max), taper(taper), storage(storage) {
+    this->ramp.reset(this->getTarget());
+  }
+
+  // Sets the normalized value, clamped to 0 to 1
+  void set(T normalized) {
+    normalized = normalized < T(0) ? T(0) : (normalized > T(1) ? T(1) : normalized);
+    if (normalized != this->get()) {
+      this->ref() = normalized;
+      this->dirty = true;
+    }
+  }
+
+  // Moves by `steps` times the step size (e.g. an encoder's increment)
+  void nudge(int steps) {
+    if (steps != 0) { this->set(this->get() + T(steps) * this->stepSize); }
+  }
+
+  // Sets the value in range
+  void setValue(T value) { this->set(this->normalize(value)); }
+
+  // Normalized step of `nudge()`, 0.05 by default
+  void setStep(T step) { this->stepSize = step; }
+
+  // Smoothing of `getValue()`, over `steps` blocks or samples
+  void setSmoothing(Smoothing smoothing, size_t steps) {
+    this->smoothing = smoothing;
+    this->ramp.setTime(smoothing == Smoothing::None ? 0 : steps);
+  }
+
+  T get() const { return this->storage ? *this->storage : this->value; } // normalized
+  T getTarget() const { return this->denormalize(this->get()); } // in range, not smoothed
+  T getValue() const { return this->ramp.get(); } // in range, smoothed
+  T getMin() const { return this->min; }
+  T getMax() const { return this->max; }
+  const char* getName() const { return this->name; }
+  Smoothing getSmoothing() const { return this->smoothing; }
+  bool isRamping() const { return this->ramp.isRamping(); }
+
+  // Steps a `Smoothing::Sample` param, call once per sample
+  T nextSample() { return this->ramp.next(); }
+
+  /**
+   * @brief Picks up a new value (set, or written to `storage`), starting its ramp
+   *
+   * Called by `ParamRegistry::dispatch()`.
+   * @return true if the target changed
+   */
+  bool update() {
+    const T normalized = this->get();
+    if (!this->dirty && normalized == this->seen) { return false; }
+    this->dirty = false;
+    this->seen = normalized;
+    this->ramp.setTarget(this->denormalize(normalized));
+    return true;
+  }
+
+  // Jumps to the current target, without smoothing
+  void reset() {
+    this->seen = this->get();
+    this->dirty = false;
+    this->ramp.reset(this->getTarget());
+  }
+
+  // Steps a `Smoothing::Block` param, returns true if it moved
+  bool step() {
+    if (this->smoothing != Smoothing::Block || !this->ramp.isRamping()) { return false; }
+    this->ramp.next();
+    return true;
+  }
+
+  T denormalize(T normalized) const {
+    if (this->taper == Taper::Exponential) { return this->min * T(::pow(double(this->max / this->min), double(normalized))); }
+    return this->min + normalized * (this->max - this->min);
+  }
+
+  T normalize(T value) const {
+    if (this->taper == Taper::Exponential) {
+      return T(::log(double(value / this->min)) / ::log(double(this->max / this->min)));
+    }
+    return (value - this->min) / (this->max - this->min);
+  }
+
+private:
+  const char* name = nullptr;
+  T min = T(0), max = T(1);
+  Taper taper = Taper::Linear;
+  Smoothing smoothing = Smoothing::None;
+  T stepSize = T(0.05);
+  T* storage = nullptr; // normalized value, `value` if `nullptr`
+  T value = T(0);
+  T seen = T(0); // normalized value of the current target
+  bool dirty = false;
+  Ramp<T> ramp;
+
+  T& ref() { return this->storage ? *this->storage : this->value; }
+};
+
+/**
+ * @brief Params grouped by effect, with one change callback per group per block
+ *
+ * Each group's callback runs from `dispatch()`, once per block at most, and
+ * only when one of its params got a new target or took a smoothing step, so
+ * effects recompute coefficients only when a value changes instead of every
+ * block. Params added after `addGroup()` belong to that group, and the
+ * callback gets them in the order added.
+ *
+ * @code
+ * Jaffx::ParamRegistry<float> mParams{samplerate, buffersize};
+ * mParams.addGroup([](void* self, const Jaffx::Param<float>* p) {
+ *   static_cast<Main*>(self)->mDelay->setParams(p[0].getValue(), p[1].getValue());
+ * }, this);
+ * mParams.add("time", &mSettings.time, 10.f, 1000.f, Jaffx::Taper::Exponential); // ms
+ * mParams.add("feedback", &mSettings.feedback, 0.f, 1.f);
+ * mParams.reset(); // in `init()`, applies every group on the first dispatch
+ * mParams.dispatch(); // in `blockStart()`
+ * @endcode
+ */
+template <typename T, size_t MaxParams = 32, size_t MaxGroups = 8>
+class ParamRegistry {
+public:
+  using Callback = void (*)(void* context, const Param<T>* params);
+
+  ParamRegistry(int samplerate, int blocksize) : samplerate(samplerate), blocksize(blocksize) {}
+
+  /**
+   * @brief Starts a group of params, applied by `callback` when they change
+   *
+   * @return the group's index, -1 if there are `MaxGroups` already
+   */
+  int addGroup(Callback callback, void* context) {
+    if (this->numGroups == MaxGroups) { return -1; }
+    this->groups[this->numGroups] = {callback, context, this->numParams, 0};
+    return int(this->numGroups++);
+  }
+
+  /**
+   * @brief Adds a param to the last group
+   *
+   * @param storage normalized value, e.g. a settings field
+   * @param ms smoothing time
+   * @return the param, `nullptr` if there are `MaxParams` already or no group
+   */
+  Param<T>* add(const char* name, T* storage, T min, T max, Taper taper = Taper::Linear,
+                Smoothing smoothing = Smoothing::Block, float ms = 50.f) {
+    if (this->numParams == MaxParams || this->numGroups == 0) { return nullptr; }
+    Param<T>& param = this->params[this->numParams++];
+    param = Param<T>(name, min, max, taper, storage);
+    const float steps = ms * 0.001f * float(this->samplerate) / (smoothing == Smoothing::Block ? float(this->blocksize) : 1.f);
+    param.setSmoothing(smoothing, size_t(steps + 0.5f));
+    param.reset();
+    this->groups[this->numGroups - 1].count++;
+    return &param;
+  }
+
+  Param<T>& operator[](size_t index) { return this->params[index]; }
+  size_t size() const { return this->numParams; }
+
+  // Jumps every param to its target, every group is applied on the next `dispatch()`
+  void reset() {
+    for (size_t i = 0; i < this->numParams; i++) { this->params[i].reset(); }
+    this->pending = true;
+  }
+
+  // Updates the params and runs the callbacks of groups that changed, call once per block
+  void dispatch() {
+    for (size_t g = 0; g < this->numGroups; g++) {
+      const Group& group = this->groups[g];
+      bool changed = this->pending;
+      for (size_t i = group.first; i < group.first + group.count; i++) {
+        changed |= this->params[i].update();
+        changed |= this->params[i].step();
+      }
+      if (changed && group.callback) { group.callback(group.context, &this->params[group.first]); }
+    }
+    this->pending = false;
+  }
+
+private:
+  struct Group {
+    Callback callback;
+    void* context;
+    size_t first, count; // in `params`
+  };
+
+  const int samplerate, blocksize;
+  Param<T> params[MaxParams];
+  Group groups[MaxGroups];
+  size_t numParams = 0, numGroups = 0;
+  bool pending = false; // apply every group
+};
+
+} // namespace Jaffx
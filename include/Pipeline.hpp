@@ -0,0 +1,123 @@
+#pragma once
+#include "Telemetry.hpp" // SpscQueue
+#include <atomic>
+#include <cstring>
+
+namespace Jaffx {
+
+/**
+ * @brief Runs latency-tolerant stages in the main loop, one block behind the audio callback
+ *
+ * The audio callback hands each block to `exchange()`, which queues a copy
+ * for the main loop and returns the foreground's output for the previous
+ * block. `service()`, called from `loop()`, runs the foreground stages on
+ * the queued blocks. Heavy stages that tolerate a block of latency (reverb
+ * tails, analysis, metering) then run outside the audio interrupt, using
+ * the time `loop()` would otherwise spend idle.
+ *
+ * Blocks move between the two contexts through lock-free queues of slot
+ * indices, never blocking either side. When `loop()` falls behind, the
+ * callback returns silence for that block (an underrun), and skips to the
+ * newest finished block once it catches up, so the latency stays one block.
+ * `loop()` must not block for longer than a block (2.7ms at 128 samples).
+ *
+ * @code
+ * void processBlock(const float* in, float* out, size_t size) override {
+ *   mPipeline.exchange(in, mWet, size); // wet signal from the previous block
+ *   for (size_t i = 0; i < size; i++) { out[i] = in[i] + mWet[i]; }
+ * }
+ * void loop() override {
+ *   mPipeline.service([this](float* block, size_t size) { mReverbLine.processBlock(block, block, size); });
+ * }
+ * @endcode
+ *
+ * @tparam BlockSize largest block size
+ * @tparam Slots blocks in flight, must be a power of two of at least 4
+ */
+template <typename T, size_t BlockSize = 128, size_t Slots = 4>
+class Pipeline {
+  static_assert(Slots >= 4 && !(Slots & (Slots - 1)), "Slots must be a power of two of at least 4");
+
+public:
+  Pipeline() {
+    for (size_t i = 0; i < Slots; i++) { this->free[i] = uint8_t(i); }
+    this->numFree = Slots;
+  }
+
+  /**
+   * @brief Audio callback side, queues `send` and returns the previous block's output
+   *
+   * @param send block for the foreground stages
+   * @param ret where to write the foreground's output for the previous block,
+   * silence if it isn't ready. May alias `send`
+   * @return false on an underrun
+   */
+  bool exchange(const T* send, T* ret, size_t size) {
+    // the newest finished block, dropping older ones after an underrun
+    uint8_t slot, ready = None;
+    while (this->done.pop(slot)) {
+      if (ready != None) { this->release(ready); }
+      ready = slot;
+    }
+
+    // queue `send` before overwriting `ret`, which may alias it
+    const bool expected = this->primed;
+    if (size <= BlockSize && this->numFree > 0) {
+      slot = this->free[--this->numFree];
+      ::memcpy(this->blocks[slot], send, size * sizeof(T));
+      this->sizes[slot] = size;
+      this->pending.push(slot);
+      this->primed = true;
+    }
+    else { this->overruns.fetch_add(1, std::memory_order_relaxed); }
+
+    const bool ok = ready != None && this->sizes[ready] == size;
+    if (ok) { ::memcpy(ret, this->blocks[ready], size * sizeof(T)); }
+    else {
+      ::memset(ret, 0, size * sizeof(T));
+      if (expected) { this->underruns.fetch_add(1, std::memory_order_relaxed); }
+    }
+    if (ready != None) { this->release(ready); }
+    return ok;
+  }
+
+  /**
+   * @brief Main loop side, runs `process(T* block, size_t size)` on each queued block
+   *
+   * @return the number of blocks processed
+   */
+  template <typename Process>
+  size_t service(Process&& process) {
+    size_t count = 0;
+    uint8_t slot;
+    while (this->pending.pop(slot)) {
+      process(this->blocks[slot], this->sizes[slot]);
+      this->done.push(slot);
+      count++;
+    }
+    return count;
+  }
+
+  // Blocks whose foreground output wasn't ready in time, since the last call
+  uint32_t takeUnderruns() { return this->underruns.exchange(0, std::memory_order_relaxed); }
+
+  // Blocks that couldn't be queued (`loop()` stalled, or too large), since the last call
+  uint32_t takeOverruns() { return this->overruns.exchange(0, std::memory_order_relaxed); }
+
+private:
+  static const uint8_t None = 0xFF;
+
+  T blocks[Slots][BlockSize];
+  size_t sizes[Slots] = {};
+  SpscQueue<uint8_t, Slots> pending; // callback -> loop
+  SpscQueue<uint8_t, Slots> done; // loop -> callback
+  uint8_t free[Slots]; // owned by the callback
+  size_t numFree = 0;
+  bool primed = false; // a block has been queued, so one is expected back
+  std::atomic<uint32_t> underruns{0};
+  std::atomic<uint32_t> overruns{0};
+
+  void release(uint8_t slot) { this->free[this->numFree++] = slot; }
+};
+
+} // namespace Jaffx
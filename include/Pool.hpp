@@ -0,0 +1,140 @@
+#pragma once
+#include <new> // for placement new
+#include <utility> // for std::forward
+#include <stddef.h>
+#include <stdint.h>
+#include "SDRAM.hpp"
+
+namespace Jaffx {
+
+// Cortex-M7 data cache line, for `Pool` alignment
+static const size_t CACHE_LINE = 32;
+
+/**
+ * @brief Fixed-size pool of `N` objects of type `T` in one SDRAM block
+ *
+ * Free slots are kept in an intrusive singly-linked list threaded through
+ * the unused slots themselves, so `acquire()` and `release()` are O(1) with
+ * no per-object header, no allocator calls and no locks. That makes them
+ * safe to call from the audio callback, as long as a pool is only used
+ * from one context (e.g. voices acquired and released in the callback).
+ * One bit per slot, kept in the pool itself, lets `release()` ignore
+ * objects released twice.
+ *
+ * @code
+ * Jaffx::Pool<Voice, 16, Jaffx::CACHE_LINE> voices; // one voice per cache line
+ * voices.init(); // after `mSDRAM.init()`, e.g. in `Firmware::init()`
+ * Voice* v = voices.acquire(samplerate); // constructs in place, nullptr if exhausted
+ * voices.release(v); // destroys and returns the slot
+ * @endcode
+ *
+ * @tparam T object type
+ * @tparam N number of slots
+ * @tparam Align slot alignment, e.g. `CACHE_LINE` to keep objects from sharing lines
+ */
+template <typename T, size_t N, size_t Align = alignof(T)>
+class Pool {
+  static_assert(N > 0, "Pool needs at least one slot");
+  static_assert(Align && !(Align & (Align - 1)), "Align must be a power of two");
+
+  struct FreeSlot { FreeSlot* next; };
+
+  static const size_t ALIGNMENT = Align > alignof(FreeSlot) ? Align : alignof(FreeSlot);
+  static const size_t OBJECT_SIZE = sizeof(T) > sizeof(FreeSlot) ? sizeof(T) : sizeof(FreeSlot);
+
+public:
+  // bytes between consecutive slots
+  static const size_t SLOT_SIZE = (OBJECT_SIZE + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+private:
+  void* pBlock = nullptr; // as returned by the allocator
+  unsigned char* pSlots = nullptr; // aligned start of slot 0
+  FreeSlot* freeList = nullptr;
+  size_t numInUse = 0;
+  uint32_t acquired[(N + 31) / 32] = {}; // one bit per slot, set while in use
+
+  size_t indexOf(const void* slot) const { return size_t((const unsigned char*)slot - this->pSlots) / SLOT_SIZE; }
+  bool isAcquired(size_t i) const { return (this->acquired[i / 32] >> (i % 32)) & 1u; }
+  void setAcquired(size_t i, bool on) {
+    if (on) { this->acquired[i / 32] |= 1u << (i % 32); }
+    else { this->acquired[i / 32] &= ~(1u << (i % 32)); }
+  }
+
+public:
+  Pool() {}
+  ~Pool() { this->deinit(); }
+
+  //Have copy & copy-assignment constructors disabled, slots point into the block
+  Pool(const Pool&) = delete;
+  void operator=(const Pool&) = delete;
+
+  /**
+   * @brief Allocates the pool's block from `mSDRAM` and links all slots free
+   *
+   * Call from `init()` or the main loop, not from the audio callback.
+   * @return false if SDRAM is out of space
+   */
+  bool init() {
+    this->deinit();
+    this->pBlock = mSDRAM.malloc(N * SLOT_SIZE + ALIGNMENT - 1);
+    if (!this->pBlock) { return false; }
+    const uintptr_t aligned = (uintptr_t(this->pBlock) + ALIGNMENT - 1) & ~uintptr_t(ALIGNMENT - 1);
+    this->pSlots = (unsigned char*)aligned;
+    this->freeList = nullptr;
+    for (size_t i = N; i-- > 0;) { // link in address order
+      FreeSlot* slot = (FreeSlot*)(this->pSlots + i * SLOT_SIZE);
+      slot->next = this->freeList;
+      this->freeList = slot;
+    }
+    return true;
+  }
+
+  // Returns the block to `mSDRAM`, objects still acquired are not destroyed
+  void deinit() {
+    if (this->pBlock) { mSDRAM.free(this->pBlock); }
+    this->pBlock = nullptr;
+    this->pSlots = nullptr;
+    this->freeList = nullptr;
+    this->numInUse = 0;
+    for (uint32_t& word : this->acquired) { word = 0; }
+  }
+
+  /**
+   * @brief Constructs a `T` in a free slot
+   *
+   * @return the object, or `nullptr` if all slots are in use
+   */
+  template <typename... Args>
+  T* acquire(Args&&... args) {
+    FreeSlot* slot = this->freeList;
+    if (!slot) { return nullptr; }
+    this->freeList = slot->next;
+    this->numInUse++;
+    this->setAcquired(this->indexOf(slot), true);
+    return new (slot) T(std::forward<Args>(args)...);
+  }
+
+  // Destroys `object` and returns its slot, ignores `nullptr`, other pools' objects and double releases
+  void release(T* object) {
+    if (!this->owns(object) || !this->isAcquired(this->indexOf(object))) { return; }
+    this->setAcquired(this->indexOf(object), false);
+    object->~T();
+    FreeSlot* slot = (FreeSlot*)(void*)object;
+    slot->next = this->freeList;
+    this->freeList = slot;
+    this->numInUse--;
+  }
+
+  // Returns whether `object` points at one of this pool's slots
+  bool owns(const T* object) const {
+    const unsigned char* p = (const unsigned char*)object;
+    return this->pSlots && p >= this->pSlots && p < this->pSlots + N * SLOT_SIZE &&
+           size_t(p - this->pSlots) % SLOT_SIZE == 0;
+  }
+
+  size_t inUse() const { return this->numInUse; }
+  size_t available() const { return this->pSlots ? N - this->numInUse : 0; }
+  static constexpr size_t capacity() { return N; }
+};
+
+} // namespace Jaffx
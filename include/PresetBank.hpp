@@ -0,0 +1,143 @@
+#pragma once
+#include "PresetJournal.hpp"
+#include <string.h>
+#include <type_traits>
+
+namespace Jaffx {
+
+/**
+ * @brief Bank of preset slots, cached in RAM and saved with a `PresetJournal`
+ *
+ * Every slot is kept in RAM, so `recall()` is a copy of a few bytes and can
+ * switch presets from the audio callback. `store()` updates the cache and
+ * queues the bank to be saved by `service()` from `loop()`. Only the bytes
+ * that changed are written (see `PresetJournal`).
+ *
+ * `T` declares its schema version as `static const uint16_t VERSION`. Slots
+ * take `SlotBytes` in flash whatever `sizeof(T)`, so `T` can change without
+ * losing the bank: bump `VERSION`, and `mount()` passes each stored slot to
+ * the migration hook, or resets it to the defaults without one.
+ *
+ * @code
+ * // upgrades presets saved before `version 2` added `T::level`
+ * bool migrate(uint16_t version, const uint8_t* data, size_t size, Settings& preset) {
+ *   if (version != 1 || size > sizeof(Settings)) { return false; }
+ *   ::memcpy(&preset, data, size); // the new fields keep their defaults
+ *   return true;
+ * }
+ * Jaffx::PresetBank<Settings, 5, Jaffx::QspiFlash> mPresets{mFlash, migrate};
+ * @endcode
+ *
+ * @tparam Slots number of presets
+ * @tparam SlotBytes flash reserved per preset, room for `T` to grow
+ */
+template <typename T, size_t Slots, typename Flash, size_t SlotBytes = 96>
+class PresetBank {
+  static_assert(std::is_trivially_copyable<T>::value, "PresetBank needs a trivially copyable preset");
+  static_assert(sizeof(T) <= SlotBytes, "the preset doesn't fit in SlotBytes");
+  static_assert(Slots > 0 && Slots <= 0xFFFF, "Slots must be between 1 and 65535");
+
+  // the bank as saved, its size only depends on `Slots` and `SlotBytes`
+  struct Image {
+    uint16_t version = T::VERSION;
+    uint16_t size = uint16_t(sizeof(T));
+    uint16_t current = 0;
+    uint16_t reserved = 0;
+    uint8_t slots[Slots][SlotBytes];
+  };
+
+public:
+  /**
+   * @brief Converts a preset saved with another `VERSION` (or size) of `T`
+   *
+   * @param version and `size` of the saved preset
+   * @param preset the defaults, to update from `data`
+   * @return false to keep the defaults
+   */
+  using Migrate = bool (*)(uint16_t version, const uint8_t* data, size_t size, T& preset);
+
+  explicit PresetBank(Flash& flash, Migrate migrate = nullptr) : journal(flash), migrate(migrate) {
+    for (size_t i = 0; i < Slots; i++) { this->write(i, this->presets[i]); }
+  }
+
+  /**
+   * @brief Loads the bank into RAM, migrating older presets, call once from `init()`
+   *
+   * @return true if a saved bank was loaded
+   */
+  bool mount() {
+    if (!this->journal.mount(this->image)) { return false; }
+    if (this->image.current >= Slots) { this->image.current = 0; }
+    const bool current = this->image.version == T::VERSION && this->image.size == sizeof(T);
+    for (size_t i = 0; i < Slots; i++) {
+      T preset = T(); // the defaults
+      if (current) { ::memcpy(&preset, this->image.slots[i], sizeof(T)); }
+      else if (!this->migrate || this->image.size > SlotBytes ||
+               !this->migrate(this->image.version, this->image.slots[i], this->image.size, preset)) {
+        preset = T(); // a failed migration may have changed it
+      }
+      this->presets[i] = preset;
+    }
+    if (!current) {
+      // saved in the new layout, so this only happens once
+      this->image.version = T::VERSION;
+      this->image.size = uint16_t(sizeof(T));
+      for (size_t i = 0; i < Slots; i++) { this->write(i, this->presets[i]); }
+      this->journal.save(this->image);
+    }
+    return true;
+  }
+
+  // The cached preset of `slot`
+  const T& operator[](size_t slot) const { return this->presets[slot]; }
+
+  /**
+   * @brief Makes `slot` the current preset, and returns it
+   *
+   * Safe from the audio callback. The current slot is saved, so it's
+   * recalled again after a reboot.
+   */
+  const T& recall(size_t slot) {
+    if (slot >= Slots) { slot = this->image.current; }
+    if (slot != this->image.current) {
+      this->image.current = uint16_t(slot);
+      this->journal.save(this->image);
+    }
+    return this->presets[slot];
+  }
+
+  /**
+   * @brief Replaces the preset of `slot`, and queues the bank to be saved
+   *
+   * Safe from the audio callback, call from one context only.
+   * @return false if `slot` is out of range, or too many saves are queued (retry later)
+   */
+  bool store(size_t slot, const T& preset) {
+    if (slot >= Slots) { return false; }
+    this->presets[slot] = preset;
+    this->write(slot, preset);
+    return this->journal.save(this->image);
+  }
+
+  // Writes queued saves to flash, call from `loop()`
+  bool service() { return this->journal.service(); }
+
+  size_t getCurrent() const { return this->image.current; }
+  static constexpr size_t size() { return Slots; }
+
+  using Journal = PresetJournal<Image, Flash>;
+  typename Journal::Error getError() const { return this->journal.getError(); }
+
+private:
+  Journal journal;
+  Migrate migrate;
+  Image image;
+  T presets[Slots] = {};
+
+  void write(size_t slot, const T& preset) {
+    ::memcpy(this->image.slots[slot], &preset, sizeof(T));
+    ::memset(this->image.slots[slot] + sizeof(T), 0, SlotBytes - sizeof(T));
+  }
+};
+
+} // namespace Jaffx
@@ -0,0 +1,378 @@
+#pragma once
+#include "Crc32.hpp"
+#include "Telemetry.hpp" // SpscQueue
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+namespace Jaffx {
+
+#ifndef JAFFX_HOST
+/**
+ * @brief Region of the Daisy's QSPI flash, for `Jaffx::PresetJournal`
+ *
+ * Defaults to the last 64KB of the 8MB chip, away from programs flashed to
+ * QSPI. Erasing a sector takes tens of milliseconds, only call `erase()` and
+ * `program()` from the main loop.
+ */
+class QspiFlash {
+public:
+  static const size_t SECTOR_SIZE = 4096;
+
+  explicit QspiFlash(daisy::QSPIHandle& qspi, uint32_t offset = 0x7F0000, size_t numSectors = 16)
+    : qspi(qspi), offset(offset), sectors(numSectors) {}
+
+  size_t sectorSize() const { return SECTOR_SIZE; }
+  size_t numSectors() const { return this->sectors; }
+
+  void read(size_t address, void* data, size_t size) {
+    ::memcpy(data, static_cast<const uint8_t*>(this->qspi.GetData(this->offset + address)), size);
+  }
+
+  bool erase(size_t sector) {
+    const uint32_t start = this->offset + sector * SECTOR_SIZE;
+    return this->qspi.Erase(start, start + SECTOR_SIZE) == daisy::QSPIHandle::Result::OK;
+  }
+
+  bool program(size_t address, const void* data, size_t size) {
+    uint8_t* bytes = static_cast<uint8_t*>(const_cast<void*>(data));
+    return this->qspi.Write(this->offset + address, size, bytes) == daisy::QSPIHandle::Result::OK;
+  }
+
+private:
+  daisy::QSPIHandle& qspi;
+  uint32_t offset;
+  size_t sectors;
+};
+#endif
+
+/**
+ * @brief Log-structured store of a settings struct in flash
+ *
+ * Instead of erasing and rewriting a sector per save, each save appends a
+ * record of the bytes that changed since the last one. When the active
+ * sector fills up (or is three quarters full while idle), the state is
+ * compacted into a snapshot at the start of the next sector, so erases
+ * rotate through all the sectors (wear leveling).
+ *
+ * Records carry a CRC, and a sector only counts once its header, written
+ * last, is valid. Power loss during a save leaves the previous state, or the
+ * new one if its record completed, never a mix.
+ *
+ * `save()` only queues the state, and is safe to call from the audio
+ * callback. `service()` does the flash work one erase or write at a time,
+ * call it from `loop()`.
+ *
+ * `Flash` provides `sectorSize()`, `numSectors()` (at least 2), `read(address, data, size)`,
+ * `erase(sector)` and `program(address, data, size)`, with NOR semantics
+ * (erased bytes read 0xFF, programming only clears bits). See
+ * `Jaffx::QspiFlash`, and `host/bench/journal.cpp` for a simulated flash.
+ *
+ * @code
+ * Jaffx::QspiFlash mFlash{hardware.qspi};
+ * Jaffx::PresetJournal<Settings, Jaffx::QspiFlash> mJournal{mFlash};
+ * void init() override { mJournal.mount(mSettings); } // keeps the defaults if nothing was saved
+ * void loop() override { mJournal.service(); }
+ * // anywhere: mJournal.save(mSettings);
+ * @endcode
+ *
+ * @tparam T trivially copyable state, at most a quarter of a sector
+ */
+template <typename T, typename Flash>
+class PresetJournal {
+  static_assert(std::is_trivially_copyable<T>::value, "PresetJournal needs a trivially copyable state");
+
+public:
+  static const uint32_t MAGIC = 0x5352504A; // "JPRS"
+
+  enum class Error {
+    None,
+    TooLarge, // the state doesn't fit in a quarter of a sector
+    TooFewSectors, // compacting needs a second sector, so the current state is never erased
+    Write // an erase or write failed, cleared once a save succeeds
+  };
+
+  explicit PresetJournal(Flash& flash) : flash(flash) {}
+
+  /**
+   * @brief Loads the last saved state, call once from `init()`
+   *
+   * @param state left unchanged (the defaults) if nothing valid was saved
+   * @return true if a saved state was loaded
+   */
+  bool mount(T& state) {
+    this->active = -1;
+    this->sequence = 0;
+    this->dirty = false;
+    this->retry = false;
+    this->step = Step::Idle;
+    this->error = Error::None;
+    ::memcpy(&this->image, &state, sizeof(T));
+    if (4 * recordSize(sizeof(T)) > this->flash.sectorSize() - HEADER_SIZE) {
+      this->error = Error::TooLarge;
+      return false;
+    }
+    if (this->flash.numSectors() < 2) {
+      this->error = Error::TooFewSectors;
+      return false;
+    }
+
+    // newest valid sector first
+    const int numSectors = int(this->flash.numSectors());
+    uint32_t tried = 0xFFFFFFFF;
+    for (int attempt = 0; attempt < numSectors; attempt++) {
+      int best = -1;
+      uint32_t bestSequence = 0;
+      for (int sector = 0; sector < numSectors; sector++) {
+        Header header;
+        this->flash.read(sector * this->flash.sectorSize(), &header, sizeof(header));
+        if (!this->valid(header)) { continue; }
+        if (header.sequence > this->sequence) { this->sequence = header.sequence; }
+        if (header.sequence < tried && (best < 0 || header.sequence > bestSequence)) {
+          best = sector;
+          bestSequence = header.sequence;
+        }
+      }
+      if (best < 0) { break; }
+      tried = bestSequence;
+      if (this->replay(best)) {
+        ::memcpy(&state, &this->image, sizeof(T));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Queues `state` to be saved by `service()`, returns false if the queue is full
+  bool save(const T& state) { return this->requests.push(state); }
+
+  /**
+   * @brief Does the next flash operation (at most one erase or write), call from `loop()`
+   *
+   * @return true while work remains
+   */
+  bool service() {
+    if (this->step == Step::Idle && !this->start()) { return false; }
+    const size_t sectorSize = this->flash.sectorSize();
+    bool ok = true;
+    switch (this->step) {
+      case Step::Append:
+        ok = this->flash.program(this->active * sectorSize + this->position, this->record, this->recordLength);
+        if (ok) {
+          this->position += this->recordLength;
+          ::memcpy(&this->image, &this->next, sizeof(T));
+          this->step = Step::Idle;
+          this->error = Error::None;
+        }
+        break;
+      case Step::Erase:
+        ok = this->flash.erase(this->target);
+        this->step = Step::Snapshot;
+        break;
+      case Step::Snapshot:
+        this->recordLength = this->encode(Kind::Snapshot, &this->next, sizeof(T));
+        ok = this->flash.program(this->target * sectorSize + HEADER_SIZE, this->record, this->recordLength);
+        this->step = Step::Commit;
+        break;
+      case Step::Commit: {
+        Header header = {MAGIC, this->sequence + 1, uint32_t(sizeof(T)), 0};
+        header.crc = crc32(&header, offsetof(Header, crc));
+        ok = this->flash.program(this->target * sectorSize, &header, sizeof(header));
+        if (ok) {
+          this->active = this->target;
+          this->sequence++;
+          this->position = HEADER_SIZE + this->recordLength;
+          this->dirty = false;
+          ::memcpy(&this->image, &this->next, sizeof(T));
+          this->error = Error::None;
+        }
+        this->step = Step::Idle;
+        break;
+      }
+      case Step::Idle:
+        break;
+    }
+    if (!ok) {
+      // retried from a fresh sector
+      this->error = Error::Write;
+      this->dirty = true;
+      this->retry = true;
+      this->step = Step::Idle;
+    }
+    return this->busy();
+  }
+
+  // Whether saves are queued or being written
+  bool busy() const { return this->step != Step::Idle || this->retry || !this->requests.empty(); }
+
+  // Sector holding the current state, -1 if none
+  int getActiveSector() const { return this->active; }
+
+  // Bytes used in the active sector
+  size_t getUsed() const { return this->active < 0 ? 0 : this->position; }
+
+  // Number of compactions so far (the sequence number of the active sector)
+  uint32_t getSequence() const { return this->sequence; }
+
+  Error getError() const { return this->error; }
+
+private:
+  enum class Step { Idle, Append, Erase, Snapshot, Commit };
+  enum Kind : uint16_t { Snapshot = 0x5301, Delta = 0x4402, Erased = 0xFFFF };
+
+  struct Header {
+    uint32_t magic;
+    uint32_t sequence; // incremented per compaction
+    uint32_t stateSize; // `sizeof(T)`, a different size is another struct
+    uint32_t crc; // of the fields above
+  };
+  static const size_t HEADER_SIZE = sizeof(Header);
+
+  // record: kind (u16), payload length (u16), payload padded to 4 bytes, CRC (u32)
+  // delta payload: runs of offset (u16), count (u16) and the changed bytes
+  static constexpr size_t recordSize(size_t payload) { return 4 + ((payload + 3) & ~size_t(3)) + 4; }
+  static const size_t MAX_RECORD = 4 + ((sizeof(T) + 3) & ~size_t(3)) + 4;
+
+  Flash& flash;
+  SpscQueue<T, 4> requests;
+  T image; // last saved state
+  T next; // state being saved
+  uint8_t record[MAX_RECORD];
+  size_t recordLength = 0;
+  int active = -1;
+  int target = 0; // sector being compacted into
+  uint32_t sequence = 0;
+  size_t position = 0; // end of the log in the active sector
+  bool dirty = false; // the active sector can't be appended to
+  bool retry = false; // `next` failed to save
+  Step step = Step::Idle;
+  Error error = Error::None;
+
+  bool valid(const Header& header) const {
+    return header.magic == MAGIC && header.stateSize == sizeof(T) && header.crc == crc32(&header, offsetof(Header, crc));
+  }
+
+  // picks the next job, returns false if there is none
+  bool start() {
+    T latest;
+    bool requested = this->retry;
+    if (this->retry) { ::memcpy(&latest, &this->next, sizeof(T)); }
+    this->retry = false;
+    while (this->requests.pop(latest)) { requested = true; } // only the newest matters
+    const size_t sectorSize = this->flash.sectorSize();
+    if (this->error == Error::TooLarge || this->error == Error::TooFewSectors) { return false; }
+    if (requested && ::memcmp(&latest, &this->image, sizeof(T)) != 0) {
+      ::memcpy(&this->next, &latest, sizeof(T));
+      this->recordLength = this->encodeDelta();
+      if (this->active >= 0 && !this->dirty && this->position + this->recordLength <= sectorSize) {
+        this->step = Step::Append;
+        return true;
+      }
+    }
+    // compact ahead of time when idle, so saves rarely wait for an erase
+    else if (this->active < 0 || (!this->dirty && this->position <= sectorSize * 3 / 4)) { return false; }
+    else { ::memcpy(&this->next, &this->image, sizeof(T)); }
+    this->target = this->active < 0 ? 0 : (this->active + 1) % int(this->flash.numSectors());
+    this->step = Step::Erase;
+    return true;
+  }
+
+  // writes a record of `payload` to `record`, returns its size
+  size_t encode(uint16_t kind, const void* payload, size_t length) {
+    const size_t size = recordSize(length);
+    ::memset(this->record, 0, size);
+    const uint16_t fields[2] = {kind, uint16_t(length)};
+    ::memcpy(this->record, fields, 4);
+    ::memcpy(this->record + 4, payload, length);
+    const uint32_t crc = crc32(this->record, size - 4);
+    ::memcpy(this->record + size - 4, &crc, 4);
+    return size;
+  }
+
+  // encodes the changes from `image` to `next`, a snapshot if that's smaller
+  size_t encodeDelta() {
+    const uint8_t* from = reinterpret_cast<const uint8_t*>(&this->image);
+    const uint8_t* to = reinterpret_cast<const uint8_t*>(&this->next);
+    uint8_t payload[sizeof(T)];
+    size_t length = 0, i = 0;
+    while (i < sizeof(T)) {
+      if (from[i] == to[i]) {
+        i++;
+        continue;
+      }
+      // a run ends after 4 unchanged bytes, the cost of starting another
+      size_t end = i + 1, same = 0;
+      while (end < sizeof(T) && same < 4) {
+        same = from[end] == to[end] ? same + 1 : 0;
+        end++;
+      }
+      end -= same;
+      if (length + 4 + (end - i) > sizeof(T)) { return this->encode(Kind::Snapshot, to, sizeof(T)); }
+      const uint16_t run[2] = {uint16_t(i), uint16_t(end - i)};
+      ::memcpy(payload + length, run, 4);
+      ::memcpy(payload + length + 4, to + i, end - i);
+      length += 4 + (end - i);
+      i = end;
+    }
+    return this->encode(Kind::Delta, payload, length);
+  }
+
+  // replays the log of `sector` into `image`, returns false if it has no valid snapshot
+  bool replay(int sector) {
+    const size_t sectorSize = this->flash.sectorSize(), base = sector * sectorSize;
+    T state;
+    size_t position = HEADER_SIZE;
+    bool loaded = false, clean = false;
+    while (position + 4 <= sectorSize) {
+      uint16_t fields[2];
+      this->flash.read(base + position, fields, 4);
+      if (fields[0] == Kind::Erased && fields[1] == 0xFFFF) {
+        clean = true;
+        break;
+      }
+      const size_t size = recordSize(fields[1]);
+      if ((fields[0] != Kind::Snapshot && fields[0] != Kind::Delta) || fields[1] > sizeof(T) ||
+          position + size > sectorSize) { break; }
+      this->flash.read(base + position, this->record, size);
+      uint32_t crc;
+      ::memcpy(&crc, this->record + size - 4, 4);
+      if (crc != crc32(this->record, size - 4) || !(loaded || fields[0] == Kind::Snapshot) ||
+          !this->apply(state, fields[0], this->record + 4, fields[1])) { break; } // torn write
+      loaded = true;
+      position += size;
+    }
+    if (!loaded) { return false; }
+
+    // anything after the log means an interrupted write, so append to a fresh sector
+    for (size_t i = position; clean && i < sectorSize; i += 4) {
+      uint32_t word;
+      this->flash.read(base + i, &word, 4);
+      clean = word == 0xFFFFFFFF;
+    }
+    ::memcpy(&this->image, &state, sizeof(T));
+    this->active = sector;
+    this->position = position;
+    this->dirty = !clean;
+    return true;
+  }
+
+  static bool apply(T& state, uint16_t kind, const uint8_t* payload, size_t length) {
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&state);
+    if (kind == Kind::Snapshot) {
+      if (length != sizeof(T)) { return false; }
+      ::memcpy(bytes, payload, sizeof(T));
+      return true;
+    }
+    for (size_t i = 0; i + 4 <= length;) {
+      uint16_t run[2];
+      ::memcpy(run, payload + i, 4);
+      if (size_t(run[0]) + run[1] > sizeof(T) || i + 4 + run[1] > length) { return false; }
+      ::memcpy(bytes + run[0], payload + i + 4, run[1]);
+      i += 4 + run[1];
+    }
+    return true;
+  }
+};
+
+} // namespace Jaffx
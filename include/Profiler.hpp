@@ -0,0 +1,119 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#ifdef JAFFX_HOST
+#include <chrono>
+#endif
+
+namespace Jaffx {
+
+#ifdef JAFFX_PROFILE
+/**
+ * @brief Per-stage profiling for effect chains
+ *
+ * Enabled by defining `JAFFX_PROFILE` (`make PROFILE=1`). Stages are timed
+ * with the DWT cycle counter on target and a steady clock (in ns) on host,
+ * accumulated per audio block, and summarized as min/avg/max per block.
+ * When `JAFFX_PROFILE` is not defined nothing here is compiled in, so uses
+ * go inside `#ifdef JAFFX_PROFILE` too.
+ */
+namespace Profiler {
+
+#ifndef JAFFX_PROFILE_MAX_STAGES
+#define JAFFX_PROFILE_MAX_STAGES 16
+#endif
+
+// Per-stage timing, in ticks (cycles on target, ns on host)
+struct Stage {
+  const char* name = nullptr;
+  uint32_t current = 0; // accumulated during the current block
+  uint32_t min = 0xFFFFFFFF;
+  uint32_t max = 0;
+  uint64_t total = 0;
+  uint32_t blocks = 0;
+
+  void endBlock() {
+    if (current < min) { min = current; }
+    if (current > max) { max = current; }
+    total += current;
+    blocks++;
+    current = 0;
+  }
+
+  uint32_t avg() const { return blocks ? uint32_t(total / blocks) : 0; }
+
+  void reset() { current = 0; min = 0xFFFFFFFF; max = 0; total = 0; blocks = 0; }
+};
+
+#ifdef JAFFX_HOST
+inline const char* unit() { return "ns"; }
+inline uint32_t now() {
+  return uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+inline void enableCounter() {}
+// ticks per second, for converting to a share of the block budget
+inline float tickRate() { return 1e9f; }
+#else
+inline const char* unit() { return "cycles"; }
+inline uint32_t now() { return DWT->CYCCNT; }
+inline void enableCounter() {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = 0xC5ACCE55; // unlock DWT on Cortex-M7
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+inline float tickRate() { return float(SystemCoreClock); }
+#endif
+
+// Global stage table, filled by profiled effect chains
+struct Registry {
+  Stage stages[JAFFX_PROFILE_MAX_STAGES];
+  size_t numStages = 0;
+
+  Stage* add(const char* name) {
+    if (numStages >= JAFFX_PROFILE_MAX_STAGES) { return nullptr; }
+    Stage* stage = &stages[numStages++];
+    stage->name = name;
+    return stage;
+  }
+
+  // called at the end of each audio block
+  void endBlock() {
+    for (size_t i = 0; i < numStages; i++) { stages[i].endBlock(); }
+  }
+
+  void reset() {
+    for (size_t i = 0; i < numStages; i++) { stages[i].reset(); }
+  }
+};
+
+inline Registry& registry() {
+  static Registry instance;
+  return instance;
+}
+
+/**
+ * @brief Prints min/avg/max ticks per block for each stage, plus the
+ * average as a share of the real-time budget of one block
+ *
+ * @param print a printf-style line printer, e.g. `DaisySeed::PrintLine`
+ */
+template <typename Printer>
+void report(Printer print, size_t blockSize, float sampleRate) {
+  Registry& r = registry();
+  const float budget = tickRate() * float(blockSize) / sampleRate; // ticks per block
+  print("Stage Load (%s per block):", unit());
+  for (size_t i = 0; i < r.numStages; i++) {
+    const Stage& s = r.stages[i];
+    if (!s.blocks) { continue; }
+    print("%s: min %lu, avg %lu, max %lu (" FLT_FMT3 "%%)", s.name ? s.name : "(unnamed)",
+          (unsigned long)s.min, (unsigned long)s.avg(), (unsigned long)s.max,
+          FLT_VAR3(100.f * float(s.avg()) / budget));
+  }
+}
+
+} // namespace Profiler
+#endif // JAFFX_PROFILE
+
+} // namespace Jaffx
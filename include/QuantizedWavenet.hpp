@@ -0,0 +1,384 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "Wavenet.hpp"
+#if defined(__ARM_FEATURE_SIMD32)
+#include <arm_acle.h>
+#endif
+
+namespace Jaffx {
+namespace wavenet {
+
+// int16/int32 fixed-point helpers of the quantized engine
+namespace fixed {
+
+// Rounding arithmetic shift right by `s`, left if `s` is negative
+inline int64_t shift(int64_t v, int s) { return s > 0 ? (v + (int64_t(1) << (s - 1))) >> s : v * (int64_t(1) << -s); }
+
+// `shift()` by an amount fixed at load time, without branches in the audio path
+struct Shift {
+  int32_t scale = 1, round = 0;
+  int right = 0;
+
+  Shift() {}
+  Shift(int s) : scale(s < 0 ? 1 << -s : 1), round(s > 0 ? 1 << (s - 1) : 0), right(s > 0 ? s : 0) {}
+
+  int32_t operator()(int32_t v) const { return (v * this->scale + this->round) >> this->right; }
+};
+
+inline int16_t saturate(int32_t v) {
+#if defined(__ARM_FEATURE_SAT)
+  return int16_t(__ssat(v, 16));
+#else
+  return int16_t(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+#endif
+}
+
+// `acc + x[0] * y[0] + x[1] * y[1]`, one SMLAD on Cortex-M7
+inline int32_t dualMac(const int16_t* x, const int16_t* y, int32_t acc) {
+#if defined(__ARM_FEATURE_SIMD32)
+  int16x2_t a, b;
+  ::memcpy(&a, x, sizeof(a));
+  ::memcpy(&b, y, sizeof(b));
+  return __smlad(a, b, acc);
+#else
+  return acc + int32_t(x[0]) * y[0] + int32_t(x[1]) * y[1];
+#endif
+}
+
+// `acc + sum(x[i] * y[i])` over `N` pairs of int16, two at a time
+template <int N>
+inline int32_t dot(const int16_t* x, const int16_t* y, int32_t acc) {
+  for (int i = 0; i + 1 < N; i += 2) { acc = dualMac(x + i, y + i, acc); }
+  if (N & 1) { acc += int32_t(x[N - 1]) * y[N - 1]; }
+  return acc;
+}
+
+/**
+ * @brief Quantizes one row of weights to int16, returns its fractional bits
+ *
+ * The largest weight uses most of int16, unless the row's sum of magnitudes
+ * would let a dot product with Q15 activations overflow int32.
+ */
+inline int quantizeRow(const float* weights, int n, int16_t* out) {
+  float peak = 0.f, sum = 0.f;
+  for (int i = 0; i < n; i++) {
+    peak = std::fmax(peak, std::fabs(weights[i]));
+    sum += std::fabs(weights[i]);
+  }
+  int bits = 24;
+  if (peak > 0.f) {
+    bits = std::min(14 - int(std::floor(std::log2(peak))), 15 - int(std::floor(std::log2(sum))));
+    bits = std::max(0, std::min(24, bits));
+  }
+  for (int i = 0; i < n; i++) { out[i] = saturate(int32_t(std::lround(std::ldexp(weights[i], bits)))); }
+  return bits;
+}
+
+inline int32_t quantize(float value, int bits) { return int32_t(std::lround(std::ldexp(value, bits))); }
+
+/**
+ * @brief Q15 tanh of a Q16 argument, linearly interpolated from a table of
+ * `Maths::tanh` over [-8, 8] in steps of 1/64 (within a Q15 LSB)
+ */
+template <typename Maths>
+struct TanhTable {
+  static int16_t values[1025];
+  static bool ready;
+
+  static void init() {
+    if (ready) { return; }
+    for (int i = 0; i <= 1024; i++) { values[i] = saturate(quantize(Maths::tanh((i - 512) / 64.f), 15)); }
+    ready = true;
+  }
+
+  static inline int16_t tanh(int32_t x) {
+    const int32_t position = x + (8 << 16);
+    if (position <= 0) { return values[0]; }
+    if (position >= (16 << 16)) { return values[1024]; }
+    const int i = position >> 10;
+    const int32_t frac = position & 1023;
+    return int16_t(values[i] + (((values[i + 1] - values[i]) * frac + 512) >> 10));
+  }
+};
+template <typename Maths> int16_t TanhTable<Maths>::values[1025];
+template <typename Maths> bool TanhTable<Maths>::ready = false;
+
+} // namespace fixed
+
+// Fractional bits of a residual stream without calibration (|x| < 8 with a bit of headroom)
+static const int8_t DEFAULT_RESIDUAL_BITS = 11;
+
+/**
+ * @brief Runs one `LayerArray` in fixed point over blocks of up to `MaxBlock` frames
+ *
+ * Same structure as `LayerArrayProcessor`, with int16 weights and residual
+ * streams. Every weight row has its own fractional bits, and each layer's
+ * input has the format picked by calibration (`residualBits`, see
+ * `examples/namTest/namCalibrate.py`). Dot products accumulate in int32,
+ * two MACs per instruction, pre-activations are Q16, tanh outputs Q15 and
+ * head accumulators Q15 in int32.
+ */
+template <typename Config, int MaxBlock>
+class QuantizedLayerArrayProcessor {
+public:
+  static constexpr int C = Config::channels;
+  static constexpr int K = Config::kernelSize;
+  static constexpr int L = Config::numLayers;
+  static constexpr int IN = Config::inputSize;
+  static constexpr int H = Config::headSize;
+  static constexpr int SPAN = 2 * MaxBlock; // frames written between rewinds
+  typedef fixed::TanhTable<typename Config::Maths> Tanh;
+
+private:
+  struct Layer {
+    int16_t conv[C][K][C]; // [out][tap][in]
+    fixed::Shift convShift[C]; // to the Q16 pre-activation
+    int32_t convBias[C]; // Q16
+    int16_t mixin[C];
+    fixed::Shift mixinShift[C];
+    int16_t conv1x1[C][C]; // [out][in]
+    fixed::Shift conv1x1Shift[C]; // to the next layer's format
+    int32_t bias1x1[C]; // in the next layer's format
+    fixed::Shift residualShift; // this layer's format to the next one's
+  };
+
+  static constexpr int bufferOffset(int layer) { // in frames
+    int offset = 0;
+    for (int i = 0; i < layer; i++) { offset += Config::reach(i) + SPAN; }
+    return offset;
+  }
+
+  Layer layers[L];
+  int16_t rechannel[C][IN];
+  fixed::Shift rechannelShift[C];
+  int16_t head[H][C];
+  int headShift[H];
+  int32_t headBias[H] = {}; // Q15
+  int16_t history[bufferOffset(L) * C] = {};
+  int written = 0; // frames written since the last rewind
+
+  int16_t* current(int layer) { return this->history + (bufferOffset(layer) + Config::reach(layer) + this->written) * C; }
+
+  void rewind() {
+    for (int l = 0; l < L; l++) {
+      int16_t* buffer = this->history + bufferOffset(l) * C;
+      ::memmove(buffer, buffer + this->written * C, Config::reach(l) * C * sizeof(int16_t));
+    }
+    this->written = 0;
+  }
+
+  void processLayer(int l, const int16_t* cond, int32_t* headAcc, int16_t* next, int n) {
+    const Layer& w = this->layers[l];
+    const int d = Config::dilation(l);
+    const int16_t* x = this->current(l);
+    for (int t = 0; t < n; t++) {
+      int16_t z[C];
+      for (int c = 0; c < C; c++) {
+        int32_t acc = 0;
+        for (int k = 0; k < K; k++) { acc = fixed::dot<C>(w.conv[c][k], x + (t - d * (K - 1 - k)) * C, acc); }
+        const int32_t pre = w.convShift[c](acc) + w.convBias[c] + w.mixinShift[c](int32_t(w.mixin[c]) * cond[t]);
+        z[c] = Tanh::tanh(pre);
+        headAcc[t * C + c] += z[c];
+      }
+      for (int c = 0; c < C; c++) {
+        const int32_t acc = fixed::dot<C>(w.conv1x1[c], z, 0);
+        next[t * C + c] = fixed::saturate(w.residualShift(x[t * C + c]) + w.conv1x1Shift[c](acc) + w.bias1x1[c]);
+      }
+    }
+  }
+
+public:
+  /**
+   * @brief Quantizes `Config::numWeights()` weights in `.nam` order, returns the position after them
+   *
+   * @param inputBits fractional bits of the array's input
+   * @param residualBits fractional bits of each layer's input, then of the array's output (`L + 1`)
+   */
+  const float* loadWeights(const float* weights, int inputBits, const int8_t* residualBits) {
+    Tanh::init();
+    float row[C * K > IN ? C * K : IN];
+    for (int i = 0; i < C; i++) {
+      for (int j = 0; j < IN; j++) { row[j] = *weights++; }
+      this->rechannelShift[i] = fixed::Shift(fixed::quantizeRow(row, IN, this->rechannel[i]) + inputBits - residualBits[0]);
+    }
+    for (int l = 0; l < L; l++) {
+      Layer& layer = this->layers[l];
+      const int bits = residualBits[l], nextBits = residualBits[l + 1];
+      for (int i = 0; i < C; i++) {
+        for (int j = 0; j < C; j++) {
+          for (int k = 0; k < K; k++) { row[k * C + j] = *weights++; }
+        }
+        layer.convShift[i] = fixed::Shift(fixed::quantizeRow(row, C * K, &layer.conv[i][0][0]) + bits - 16);
+      }
+      for (int i = 0; i < C; i++) { layer.convBias[i] = fixed::quantize(*weights++, 16); }
+      for (int i = 0; i < C; i++) { layer.mixinShift[i] = fixed::Shift(fixed::quantizeRow(weights++, 1, &layer.mixin[i]) + 15 - 16); }
+      for (int i = 0; i < C; i++) {
+        layer.conv1x1Shift[i] = fixed::Shift(fixed::quantizeRow(weights, C, layer.conv1x1[i]) + 15 - nextBits);
+        weights += C;
+      }
+      for (int i = 0; i < C; i++) { layer.bias1x1[i] = fixed::quantize(*weights++, nextBits); }
+      layer.residualShift = fixed::Shift(bits - nextBits);
+    }
+    for (int i = 0; i < H; i++) {
+      this->headShift[i] = fixed::quantizeRow(weights, C, this->head[i]);
+      weights += C;
+    }
+    for (int i = 0; i < H; i++) { this->headBias[i] = Config::headBias ? fixed::quantize(*weights++, 15) : 0; }
+    return weights;
+  }
+
+  void reset() {
+    ::memset(this->history, 0, sizeof(this->history));
+    this->written = 0;
+  }
+
+  /**
+   * @brief Processes `n` <= `MaxBlock` frames
+   *
+   * @param input `n` x `IN` interleaved, in the format given to `loadWeights()`
+   * @param cond `n` Q15 conditioning samples (the model input)
+   * @param headAcc `n` x `C` Q15 head accumulator, added to by every layer
+   * @param output `n` x `C` output of the last layer, in its calibrated format
+   * @param headOut `n` x `H` Q15 head rechannel of `headAcc`
+   */
+  void process(const int16_t* input, const int16_t* cond, int32_t* headAcc, int16_t* output, int32_t* headOut, int n) {
+    if (this->written + n > SPAN) { this->rewind(); }
+
+    int16_t* x = this->current(0);
+    for (int t = 0; t < n; t++) {
+      for (int c = 0; c < C; c++) {
+        x[t * C + c] = fixed::saturate(this->rechannelShift[c](fixed::dot<IN>(this->rechannel[c], input + t * IN, 0)));
+      }
+    }
+
+    for (int l = 0; l < L; l++) {
+      int16_t* next = (l + 1 < L) ? this->current(l + 1) : output;
+      this->processLayer(l, cond, headAcc, next, n);
+    }
+
+    for (int t = 0; t < n; t++) {
+      for (int h = 0; h < H; h++) {
+        int64_t acc = 0;
+        for (int c = 0; c < C; c++) { acc += int64_t(this->head[h][c]) * headAcc[t * C + c]; }
+        headOut[t * H + h] = int32_t(fixed::shift(acc, this->headShift[h])) + this->headBias[h];
+      }
+    }
+    this->written += n;
+  }
+};
+
+/**
+ * @brief Fixed-point version of `Wavenet`: int16 weights and activations,
+ * float input and output
+ *
+ * Takes the same `LayerArray` configs and float weights, quantized when
+ * loaded, and about half the memory. Residual formats come from
+ * calibration (`namToArray.py`/`namToBinary.py --calibrate`), otherwise
+ * `DEFAULT_RESIDUAL_BITS`. `host/bench/quantized.cpp` reports its error
+ * against the float model.
+ *
+ * @code
+ * Jaffx::wavenet::QuantizedWavenet<Array1, Array2> model;
+ * model.loadModel(weights, weightsLen, residualBits);
+ * model.process(in, out, 128);
+ * @endcode
+ */
+template <typename Array1, typename Array2, int MaxBlock = 128>
+class QuantizedWavenet {
+  static_assert(Array1::inputSize == 1, "Mono input expected");
+  static_assert(Array2::inputSize == Array1::channels, "Array 2 input must match array 1 channels");
+  static_assert(Array2::channels == Array1::headSize, "Array 2 channels must match array 1 head size");
+  static_assert(Array2::headSize == 1, "Mono output expected");
+  typedef float T;
+
+  QuantizedLayerArrayProcessor<Array1, MaxBlock> array1;
+  QuantizedLayerArrayProcessor<Array2, MaxBlock> array2;
+  T outputScale = 0; // head scale and Q15 to float
+
+  // scratch between the arrays
+  int16_t input[MaxBlock];
+  int32_t head1[MaxBlock * Array1::channels];
+  int16_t output1[MaxBlock * Array1::channels];
+  int32_t head2[MaxBlock * Array1::headSize];
+  int16_t output2[MaxBlock * Array2::channels];
+  int32_t headOut2[MaxBlock];
+
+public:
+  typedef Array1 LayerArray1;
+  typedef Array2 LayerArray2;
+
+  static constexpr int numWeights() { return Array1::numWeights() + Array2::numWeights() + 1; } // + head scale
+  static constexpr int numResidualBits() { return Array1::numLayers + Array2::numLayers + 2; }
+  static constexpr int receptiveField() { return Array1::receptiveField() + Array2::receptiveField() + 1; }
+  static constexpr int maxBlock() { return MaxBlock; }
+
+  /**
+   * @brief Quantizes weights in `.nam` order, clears the state and prewarms
+   *
+   * @param residualBits `numResidualBits()` calibrated formats (array 1's
+   * layers and output, then array 2's), or nullptr for the default
+   * @return false (leaving the model silent) if `count` doesn't match the architecture
+   */
+  bool loadModel(const float* weights, size_t count, const int8_t* residualBits = nullptr) {
+    if (count != size_t(numWeights())) { this->outputScale = 0; return false; }
+    int8_t defaults[numResidualBits()];
+    if (!residualBits) {
+      for (int8_t& bits : defaults) { bits = DEFAULT_RESIDUAL_BITS; }
+      residualBits = defaults;
+    }
+    const int8_t* residualBits2 = residualBits + Array1::numLayers + 1;
+    weights = this->array1.loadWeights(weights, 15, residualBits);
+    weights = this->array2.loadWeights(weights, residualBits[Array1::numLayers], residualBits2);
+    this->outputScale = *weights / 32768.f;
+    this->reset();
+    this->prewarm();
+    return true;
+  }
+
+  bool loadModel(const std::vector<float>& weights, const int8_t* residualBits = nullptr) {
+    return this->loadModel(weights.data(), weights.size(), residualBits);
+  }
+
+  // Clears all layer histories
+  void reset() {
+    this->array1.reset();
+    this->array2.reset();
+  }
+
+  // Runs silence through the receptive field so the layers settle
+  void prewarm() {
+    T silence[MaxBlock] = {};
+    T discard[MaxBlock];
+    for (int i = 0; i < receptiveField(); i += MaxBlock) { this->process(silence, discard, MaxBlock); }
+  }
+
+  // Processes `size` samples (any length, in chunks of `MaxBlock`). `in` and `out` may alias
+  void process(const T* in, T* out, size_t size) {
+    while (size > 0) {
+      const int n = size < size_t(MaxBlock) ? int(size) : MaxBlock;
+      for (int t = 0; t < n; t++) { this->input[t] = fixed::saturate(int32_t(std::lrintf(in[t] * 32768.f))); }
+      ::memset(this->head1, 0, n * Array1::channels * sizeof(int32_t));
+      this->array1.process(this->input, this->input, this->head1, this->output1, this->head2, n);
+      this->array2.process(this->output1, this->input, this->head2, this->output2, this->headOut2, n);
+      for (int t = 0; t < n; t++) { out[t] = this->outputScale * T(this->headOut2[t]); }
+      in += n;
+      out += n;
+      size -= size_t(n);
+    }
+  }
+
+  // Processes one sample
+  T forward(T input) {
+    T output;
+    this->process(&input, &output, 1);
+    return output;
+  }
+};
+
+} // namespace wavenet
+} // namespace Jaffx
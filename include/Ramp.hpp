@@ -0,0 +1,59 @@
+#pragma once
+#include <stddef.h>
+
+namespace Jaffx {
+
+/**
+ * @brief Linear ramp towards a target value, to smooth parameter changes
+ *
+ * Each `next()` moves a step towards the target, reaching it after the
+ * number of steps set with `setTime()`. Steps can be samples, or blocks to
+ * update an effect's parameters once per block.
+ *
+ * @code
+ * Jaffx::Ramp<float> mix;
+ * mix.setTime(size_t(0.05f * samplerate / buffersize)); // 50ms, stepped per block
+ * mix.setTarget(0.5f);
+ * if (mix.isRamping()) { mDelay->setParams(398.f, 0.3f, 0.7f, mix.next()); }
+ * @endcode
+ */
+template <typename T>
+class Ramp {
+public:
+  explicit Ramp(T value = T(0)) : value(value), target(value) {}
+
+  // Steps taken to reach a new target, 0 to jump to it
+  void setTime(size_t steps) { this->steps = steps; }
+
+  // Jumps to `value`, stopping any ramp
+  void reset(T value) {
+    this->value = this->target = value;
+    this->remaining = 0;
+  }
+
+  // Starts ramping towards `target` from the current value
+  void setTarget(T target) {
+    if (target == this->target) { return; }
+    this->target = target;
+    if (this->steps == 0) { return this->reset(target); }
+    this->increment = (target - this->value) / T(this->steps);
+    this->remaining = this->steps;
+  }
+
+  // Advances a step, returns the new value
+  T next() {
+    if (this->remaining == 0) { return this->value; }
+    this->value = --this->remaining == 0 ? this->target : this->value + this->increment;
+    return this->value;
+  }
+
+  T get() const { return this->value; }
+  T getTarget() const { return this->target; }
+  bool isRamping() const { return this->remaining > 0; }
+
+private:
+  T value, target, increment = T(0);
+  size_t steps = 0, remaining = 0;
+};
+
+} // namespace Jaffx
@@ -0,0 +1,190 @@
+#pragma once
+#include "Telemetry.hpp" // SpscQueue
+#include <atomic>
+
+namespace Jaffx {
+
+/**
+ * @brief Cooperative scheduler for the main loop
+ *
+ * Runs periodic tasks at their own rates, and one-shot work posted from the
+ * audio callback, instead of `loop()` polling everything after a fixed
+ * `System::Delay()`. Tasks run to completion in the order they were added,
+ * with posted work first. When nothing is due the core sleeps (WFI) until the
+ * next interrupt (SysTick wakes it every ms), so once a task is added or
+ * posted the main loop must not spin-wait.
+ *
+ * A late task runs once, not once per missed period, and the missed periods
+ * are counted. Each task's run time and lateness are tracked for `report()`,
+ * so slow duties (e.g. a flash erase) show up as lateness of the others.
+ * Periods are timed with libDaisy's tick, and must be shorter than 2^31 ticks:
+ * ~10.7 seconds at the Daisy Seed's 200MHz (`maxPeriodMs()`).
+ *
+ * @code
+ * void init() override {
+ *   scheduler.every(20, [](void* self) { static_cast<Main*>(self)->updateLeds(); }, this, "leds");
+ * }
+ * void blockStart() override {
+ *   if (changed) { scheduler.post([](void* self) { static_cast<Main*>(self)->redraw(); }, this); }
+ * }
+ * @endcode
+ *
+ * @tparam MaxPosted one-shot tasks in flight, a power of two
+ */
+template <size_t MaxTasks = 16, size_t MaxPosted = 16>
+class Scheduler {
+public:
+  using Task = void (*)(void* context);
+
+  // Per-task timing, in microseconds
+  struct Stats {
+    const char* name;
+    uint32_t periodUs;
+    uint32_t runs;
+    uint32_t skipped; // periods missed while late
+    uint32_t maxRunUs;
+    uint64_t totalRunUs;
+    uint32_t maxLateUs;
+
+    uint32_t avgRunUs() const { return this->runs ? uint32_t(this->totalRunUs / this->runs) : 0; }
+  };
+
+  /**
+   * @brief Runs `task` every `periodMs`, starting now
+   *
+   * @return the task's index, -1 if there are `MaxTasks` already or
+   * `periodMs` is 0 or above `maxPeriodMs()`
+   */
+  int every(uint32_t periodMs, Task task, void* context, const char* name = nullptr) {
+    if (this->numTasks == MaxTasks || !task || periodMs == 0 || periodMs > maxPeriodMs()) { return -1; }
+    Entry& entry = this->tasks[this->numTasks];
+    entry.task = task;
+    entry.context = context;
+    entry.period = periodMs * (ticksPerUs() * 1000);
+    entry.due = now();
+    entry.stats = {name, periodMs * 1000, 0, 0, 0, 0, 0};
+    return int(this->numTasks++);
+  }
+
+  /**
+   * @brief Runs `task` once from the main loop, safe from the audio callback
+   *
+   * Single producer: post from one context only.
+   * @return false if `MaxPosted` tasks are waiting already (counted as dropped)
+   */
+  bool post(Task task, void* context) {
+    this->used.store(true, std::memory_order_relaxed);
+    if (this->posted.push({task, context})) { return true; }
+    this->dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Runs posted work and due tasks, sleeps until the next interrupt if none were, called by `Firmware::start()`
+  void run() {
+    bool ran = this->drain();
+    for (size_t i = 0; i < this->numTasks; i++) {
+      Entry& entry = this->tasks[i];
+      const uint32_t start = now();
+      if (int32_t(start - entry.due) < 0) { continue; }
+      entry.task(entry.context);
+      const uint32_t stop = now();
+
+      Stats& stats = entry.stats;
+      const uint32_t late = (start - entry.due) / ticksPerUs(), took = (stop - start) / ticksPerUs();
+      stats.runs++;
+      stats.totalRunUs += took;
+      if (took > stats.maxRunUs) { stats.maxRunUs = took; }
+      if (late > stats.maxLateUs) { stats.maxLateUs = late; }
+
+      // the next period, or the next one from now if it was missed
+      entry.due += entry.period;
+      if (int32_t(stop - entry.due) >= 0) {
+        const uint32_t missed = (stop - entry.due) / entry.period + 1;
+        stats.skipped += missed;
+        entry.due += missed * entry.period;
+      }
+      ran = true;
+      this->drain();
+    }
+    if (!ran && (this->numTasks > 0 || this->used.load(std::memory_order_relaxed))) { sleep(); }
+  }
+
+  size_t size() const { return this->numTasks; }
+
+  // Longest period of `every()`, `run()` compares times as signed 32-bit ticks
+  static uint32_t maxPeriodMs() { return uint32_t(0x7FFFFFFFu / (uint64_t(ticksPerUs()) * 1000)); }
+
+  const Stats& getStats(size_t index) const { return this->tasks[index].stats; }
+
+  // Clears the timing stats, e.g. after startup work that isn't representative
+  void resetStats() {
+    for (size_t i = 0; i < this->numTasks; i++) {
+      Stats& stats = this->tasks[i].stats;
+      stats = {stats.name, stats.periodUs, 0, 0, 0, 0, 0};
+    }
+  }
+
+  // Posted tasks dropped because the queue was full, since the last call
+  uint32_t takeDropped() { return this->dropped.exchange(0, std::memory_order_relaxed); }
+
+  /**
+   * @brief Prints each task's rate, run time and lateness
+   *
+   * @param print a printf-style line printer, e.g. `DaisySeed::PrintLine`
+   */
+  template <typename Printer>
+  void report(Printer print) const {
+    print("Tasks (us):");
+    for (size_t i = 0; i < this->numTasks; i++) {
+      const Stats& s = this->tasks[i].stats;
+      print("%s every %lu: %lu runs, avg %lu, max %lu, late max %lu, skipped %lu", s.name ? s.name : "(unnamed)",
+            (unsigned long)s.periodUs, (unsigned long)s.runs, (unsigned long)s.avgRunUs(), (unsigned long)s.maxRunUs,
+            (unsigned long)s.maxLateUs, (unsigned long)s.skipped);
+    }
+  }
+
+private:
+  struct Entry {
+    Task task;
+    void* context;
+    uint32_t period, due; // ticks
+    Stats stats;
+  };
+
+  struct Work {
+    Task task;
+    void* context;
+  };
+
+  Entry tasks[MaxTasks];
+  size_t numTasks = 0;
+  SpscQueue<Work, MaxPosted> posted;
+  std::atomic<uint32_t> dropped{0};
+  std::atomic<bool> used{false}; // something was posted, so sleeping is expected
+
+  // runs posted work, returns true if there was any
+  bool drain() {
+    Work work;
+    bool ran = false;
+    while (this->posted.pop(work)) {
+      work.task(work.context);
+      ran = true;
+    }
+    return ran;
+  }
+
+  // libDaisy's tick wraps cleanly, unlike `System::GetUs()`
+  static uint32_t now() { return daisy::System::GetTick(); }
+  static uint32_t ticksPerUs() {
+    static const uint32_t ticks = daisy::System::GetTickFreq() / 1000000 ? daisy::System::GetTickFreq() / 1000000 : 1;
+    return ticks;
+  }
+
+  static void sleep() {
+#ifndef JAFFX_HOST
+    __WFI();
+#endif
+  }
+};
+
+} // namespace Jaffx
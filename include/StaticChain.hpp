@@ -0,0 +1,93 @@
+#pragma once
+#include "EffectsLine.hpp"
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+namespace Jaffx {
+
+/**
+ * @brief Effect chain fixed at compile time, an alternative to `Jaffx::EffectsLine`
+ *
+ * Holds pointers to its stages with their exact types, and calls them without
+ * virtual dispatch, so the compiler can inline the whole chain into one loop.
+ * Consecutive per-sample stages run together sample by sample, stages that
+ * are `BlockEffect`s process the block in one call between them.
+ *
+ * The stages keep their own `enable()`/`toggle()` and pass their input through
+ * when disabled, as in a `giml::EffectsLine`. Each type in `Effects` must be
+ * the most-derived type of its stage, since its methods are called directly.
+ *
+ * @code
+ * Jaffx::StaticChain<float, giml::Chorus<float>, giml::Delay<float>> chain{chorus, delay};
+ * chain.toggle<1>(true); // delay on
+ * chain.processBlock(in, out, size);
+ * @endcode
+ *
+ * See `host/bench/chain.cpp` for a comparison with the virtual chain.
+ */
+template <typename T, typename... Effects>
+class StaticChain {
+public:
+  static constexpr size_t numStages = sizeof...(Effects);
+
+  template <size_t I>
+  using Stage = typename std::tuple_element<I, std::tuple<Effects...>>::type;
+
+  explicit StaticChain(Effects&... effects) : effects(&effects...) {}
+
+  template <size_t I> Stage<I>& get() { return *std::get<I>(this->effects); }
+  template <size_t I> void toggle(bool state) { this->get<I>().toggle(state); }
+  template <size_t I> void enable() { this->get<I>().enable(); }
+  template <size_t I> void disable() { this->get<I>().disable(); }
+
+  // processes a sample through every stage
+  T processSample(const T& in) { return this->run<0, numStages>(in); }
+
+  // processes `size` samples, `in` and `out` may alias
+  void processBlock(const T* in, T* out, size_t size) {
+    if (out != in) { ::memcpy(out, in, size * sizeof(T)); }
+    this->processFrom<0>(out, size);
+  }
+
+private:
+  std::tuple<Effects*...> effects;
+
+  // index of the first `BlockEffect` from `from`, `numStages` if none
+  static constexpr size_t nextBlockStage(size_t from) {
+    const bool isBlock[] = {std::is_base_of<BlockEffect<T>, Effects>::value..., true};
+    while (!isBlock[from]) { from++; }
+    return from;
+  }
+
+  // stages `I` to `End` of a sample
+  template <size_t I, size_t End>
+  typename std::enable_if<(I < End), T>::type run(T x) {
+    x = std::get<I>(this->effects)->Stage<I>::processSample(x);
+    return this->run<I + 1, End>(x);
+  }
+  template <size_t I, size_t End>
+  typename std::enable_if<(I >= End), T>::type run(T x) { return x; }
+
+  // per-sample stages from `Begin` to the next block stage together, then that one
+  template <size_t Begin>
+  typename std::enable_if<(Begin < numStages)>::type processFrom(T* buffer, size_t size) {
+    constexpr size_t End = nextBlockStage(Begin);
+    if (End > Begin) {
+      for (size_t i = 0; i < size; i++) { buffer[i] = this->run<Begin, End>(buffer[i]); }
+    }
+    this->processBlockStage<End>(buffer, size);
+  }
+  template <size_t Begin>
+  typename std::enable_if<(Begin >= numStages)>::type processFrom(T*, size_t) {}
+
+  template <size_t I>
+  typename std::enable_if<(I < numStages)>::type processBlockStage(T* buffer, size_t size) {
+    std::get<I>(this->effects)->Stage<I>::processBlock(buffer, buffer, size);
+    this->processFrom<I + 1>(buffer, size);
+  }
+  template <size_t I>
+  typename std::enable_if<(I >= numStages)>::type processBlockStage(T*, size_t) {}
+};
+
+} // namespace Jaffx
@@ -0,0 +1,152 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace Jaffx {
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ *
+ * One context (e.g. the audio callback) pushes, another (e.g. `loop()`)
+ * pops. Neither side ever blocks: `push()` fails when full and `pop()`
+ * fails when empty.
+ *
+ * @tparam T trivially copyable item type
+ * @tparam Capacity number of slots, must be a power of two
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+  static_assert(Capacity && !(Capacity & (Capacity - 1)), "Capacity must be a power of two");
+
+  T items[Capacity];
+  std::atomic<uint32_t> head{0}; // next slot to write, owned by producer
+  std::atomic<uint32_t> tail{0}; // next slot to read, owned by consumer
+
+public:
+  // producer side, returns false if the queue is full
+  bool push(const T& item) {
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= Capacity) { return false; }
+    items[h & (Capacity - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer side, returns false if the queue is empty
+  bool pop(T& item) {
+    const uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) { return false; }
+    item = items[t & (Capacity - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+  bool empty() const { return this->size() == 0; }
+
+  static constexpr size_t capacity() { return Capacity; }
+};
+
+/**
+ * @brief Fixed-size binary telemetry record
+ *
+ * `label` must point to a string with static storage (e.g. a literal),
+ * as only the pointer is queued. Include after libDaisy (or `Host.hpp`).
+ */
+struct TelemetryRecord {
+  const char* label = nullptr;
+  uint32_t timestamp = 0; // ms, from `System::GetNow()`
+  uint8_t numValues = 0;
+  float values[3] = { 0.f, 0.f, 0.f };
+};
+
+#ifndef JAFFX_TELEMETRY_SIZE
+#define JAFFX_TELEMETRY_SIZE 64
+#endif
+
+/**
+ * @brief Telemetry channel from the audio callback to the main loop
+ *
+ * Push records from the audio callback, they are drained in batches
+ * from the main loop by `Firmware::debugLoop()` and printed to serial.
+ * Records pushed while the queue is full are dropped and counted.
+ */
+class Telemetry {
+  SpscQueue<TelemetryRecord, JAFFX_TELEMETRY_SIZE> queue;
+  std::atomic<uint32_t> dropped{0};
+
+public:
+  // push a record with up to 3 values, safe to call from the audio callback
+  bool push(const char* label, const float* values = nullptr, uint8_t numValues = 0) {
+    TelemetryRecord record;
+    record.label = label;
+    record.timestamp = daisy::System::GetNow();
+    record.numValues = numValues > 3 ? 3 : numValues;
+    for (uint8_t i = 0; i < record.numValues; i++) { record.values[i] = values[i]; }
+    if (!queue.push(record)) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  bool push(const char* label, float a) {
+    const float values[1] = { a };
+    return this->push(label, values, 1);
+  }
+
+  bool push(const char* label, float a, float b) {
+    const float values[2] = { a, b };
+    return this->push(label, values, 2);
+  }
+
+  bool push(const char* label, float a, float b, float c) {
+    const float values[3] = { a, b, c };
+    return this->push(label, values, 3);
+  }
+
+  /**
+   * @brief Hands up to `maxRecords` queued records to `writer`, never blocks
+   *
+   * @param writer callable taking a `const TelemetryRecord&`
+   * @return number of records drained
+   */
+  template <typename Writer>
+  size_t drain(Writer&& writer, size_t maxRecords = JAFFX_TELEMETRY_SIZE) {
+    TelemetryRecord record;
+    size_t count = 0;
+    while (count < maxRecords && queue.pop(record)) {
+      writer(static_cast<const TelemetryRecord&>(record));
+      count++;
+    }
+    return count;
+  }
+
+  // number of records dropped since the last call
+  uint32_t takeDropped() { return dropped.exchange(0, std::memory_order_relaxed); }
+
+  size_t pending() const { return queue.size(); }
+};
+
+/**
+ * @brief Writes a telemetry record as one line through a printf-style
+ * line printer, e.g. `DaisySeed::PrintLine`
+ */
+template <typename Printer>
+void printRecord(Printer print, const TelemetryRecord& r) {
+  const char* label = r.label ? r.label : "";
+  switch (r.numValues) {
+    case 0: print("[%lu] %s", (unsigned long)r.timestamp, label); break;
+    case 1: print("[%lu] %s: " FLT_FMT3, (unsigned long)r.timestamp, label, FLT_VAR3(r.values[0])); break;
+    case 2: print("[%lu] %s: " FLT_FMT3 ", " FLT_FMT3, (unsigned long)r.timestamp, label,
+                  FLT_VAR3(r.values[0]), FLT_VAR3(r.values[1])); break;
+    default: print("[%lu] %s: " FLT_FMT3 ", " FLT_FMT3 ", " FLT_FMT3, (unsigned long)r.timestamp, label,
+                   FLT_VAR3(r.values[0]), FLT_VAR3(r.values[1]), FLT_VAR3(r.values[2])); break;
+  }
+}
+
+} // namespace Jaffx
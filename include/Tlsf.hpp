@@ -0,0 +1,534 @@
+#pragma once
+#include <cstring>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h> // for printf
+
+namespace Jaffx {
+
+// Records the call site of each live allocation when defined, see `Tlsf::reportLive()`
+// #define JAFFX_ALLOC_TRACKING
+#ifndef JAFFX_ALLOC_TRACKING_SIZE
+#define JAFFX_ALLOC_TRACKING_SIZE 256 // live allocations tracked at once
+#endif
+
+#define JAFFX_STRINGIFY_(x) #x
+#define JAFFX_STRINGIFY(x) JAFFX_STRINGIFY_(x)
+// "file:line" of the current line, for `Tlsf::setSite()`
+#define JAFFX_ALLOC_SITE __FILE__ ":" JAFFX_STRINGIFY(__LINE__)
+
+/**
+ * @brief Two-Level Segregated Fit (TLSF) allocator over a fixed memory region
+ *
+ * `malloc`/`free`/`realloc` run in bounded, constant time: free blocks are
+ * kept in segregated lists indexed by a first level (power of two) and a
+ * second level (16 linear subdivisions), and two bitmaps locate a suitable
+ * list with a couple of count-leading/trailing-zeros instructions. Freed
+ * blocks merge immediately with their physical neighbours, found through
+ * boundary tags, so no list walks or coalescing passes are needed.
+ *
+ * Each block costs one 8-byte header on target (16 bytes on 64-bit hosts),
+ * and payloads are 8-byte aligned.
+ *
+ * Usage counters (bytes in use, peak, allocation size histogram) are kept
+ * on every call at the cost of a few additions, `getStats()` adds the free
+ * space and fragmentation by walking the free lists. Defining
+ * `JAFFX_ALLOC_TRACKING` also records which call site made each live
+ * allocation, to find leaks with `reportLive()`.
+ *
+ * Based on M. Masmano et al., "TLSF: a New Dynamic Memory Allocator for
+ * Real-Time Systems" (2004).
+ */
+class Tlsf {
+public:
+  static const size_t ALIGN_LOG2 = 3;
+  static const size_t ALIGN = size_t(1) << ALIGN_LOG2;
+
+  // Allocation sizes are binned by power of two: bin `i` counts requests of
+  // up to `8 << i` bytes, the last bin everything larger
+  static const unsigned HISTOGRAM_BINS = 16;
+
+  struct Stats {
+    size_t capacity = 0; // bytes managed, including headers
+    size_t bytesInUse = 0; // payload bytes of used blocks
+    size_t peakBytesInUse = 0; // high-water mark of `bytesInUse`
+    size_t freeBytes = 0; // payload bytes of free blocks
+    size_t largestFree = 0; // largest single free block
+    uint32_t usedBlocks = 0, freeBlocks = 0;
+    uint32_t allocations = 0, frees = 0, failures = 0; // calls since `init()`/`resetCounters()`
+
+    // 0 when all free space is one block, approaching 1 as it splinters
+    float fragmentation() const { return this->freeBytes ? 1.f - float(this->largestFree) / float(this->freeBytes) : 0.f; }
+  };
+
+protected:
+  static const unsigned SL_INDEX_COUNT_LOG2 = 4;
+  static const unsigned SL_INDEX_COUNT = 1u << SL_INDEX_COUNT_LOG2;
+  static const unsigned FL_INDEX_MAX = 30; // blocks up to 1GB
+  static const unsigned FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGN_LOG2;
+  static const unsigned FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+  static const size_t SMALL_BLOCK_SIZE = size_t(1) << FL_INDEX_SHIFT;
+
+  static const size_t FREE_BIT = 1; // sizes are multiples of ALIGN, so the low bit is spare
+
+  // Block header. `nextFree`/`prevFree` only exist while the block is free,
+  // they overlay the start of the payload
+  struct Block {
+    Block* prevPhys; // physically previous block, nullptr for the first one
+    size_t sizeAndFlags; // payload size | FREE_BIT
+    Block* nextFree;
+    Block* prevFree;
+  };
+
+  static const size_t HEADER_SIZE = offsetof(Block, nextFree);
+  static const size_t MIN_BLOCK_SIZE = sizeof(Block) - HEADER_SIZE; // room for the free-list links
+  static const size_t MAX_BLOCK_SIZE = size_t(1) << FL_INDEX_MAX;
+
+  static_assert(HEADER_SIZE % ALIGN == 0, "Block header must keep payloads aligned");
+
+  unsigned char* pMemory = nullptr;
+  size_t memorySize = 0;
+  uint32_t flBitmap = 0;
+  uint32_t slBitmap[FL_INDEX_COUNT] = {};
+  Block* freeLists[FL_INDEX_COUNT][SL_INDEX_COUNT] = {};
+
+  // usage counters, see `getStats()`
+  size_t bytesInUse = 0, peakBytesInUse = 0;
+  uint32_t usedBlocks = 0, numAllocations = 0, numFrees = 0, numFailures = 0;
+  uint32_t histogram[HISTOGRAM_BINS] = {};
+
+#ifdef JAFFX_ALLOC_TRACKING
+  struct LiveAllocation {
+    const void* ptr;
+    size_t size;
+    const char* site;
+  };
+  LiveAllocation live[JAFFX_ALLOC_TRACKING_SIZE] = {};
+  uint32_t untracked = 0; // allocations that did not fit in `live`
+#endif
+  const char* site = nullptr; // call site attributed to new allocations
+
+public:
+  Tlsf() {}
+
+  //Have copy & copy-assignment constructors disabled, blocks point into the region
+  Tlsf(const Tlsf&) = delete;
+  void operator=(const Tlsf&) = delete;
+
+  /**
+   * @brief Takes ownership of `size` bytes at `memory` as one free block
+   *
+   * Any previous allocations are forgotten.
+   */
+  void init(void* memory, size_t size) {
+    ::memset(this->slBitmap, 0, sizeof(this->slBitmap));
+    ::memset(this->freeLists, 0, sizeof(this->freeLists));
+    this->flBitmap = 0;
+    this->bytesInUse = this->peakBytesInUse = 0;
+    this->usedBlocks = 0;
+    this->resetCounters();
+#ifdef JAFFX_ALLOC_TRACKING
+    ::memset(this->live, 0, sizeof(this->live));
+    this->untracked = 0;
+#endif
+
+    // align the start, and leave room for the end sentinel
+    uintptr_t start = alignUp(uintptr_t(memory));
+    const size_t lost = size_t(start - uintptr_t(memory));
+    if (!memory || size < lost + 2 * HEADER_SIZE + MIN_BLOCK_SIZE) { this->pMemory = nullptr; return; }
+    this->pMemory = (unsigned char*)start;
+    this->memorySize = alignDown(size - lost);
+
+    size_t payload = this->memorySize - 2 * HEADER_SIZE;
+    if (payload >= MAX_BLOCK_SIZE) { payload = MAX_BLOCK_SIZE - ALIGN; }
+    Block* first = (Block*)this->pMemory;
+    first->prevPhys = nullptr;
+    setSize(first, payload);
+    setFree(first, true);
+
+    // zero-size, permanently used block marking the end of the region
+    Block* sentinel = nextPhys(first);
+    sentinel->prevPhys = first;
+    sentinel->sizeAndFlags = 0;
+
+    this->insertFreeBlock(first);
+  }
+
+  // Rounds up to the allocation alignment (8 bytes)
+  static size_t alignUp(size_t a) { return (a + ALIGN - 1) & ~(ALIGN - 1); }
+  static size_t alignDown(size_t a) { return a & ~(ALIGN - 1); }
+
+  // Returns whether `p` lies inside the managed region
+  bool owns(const void* p) const {
+    return this->pMemory && (const unsigned char*)p >= this->pMemory &&
+           (const unsigned char*)p < this->pMemory + this->memorySize;
+  }
+
+  // Usable size of an allocation (at least what was requested)
+  static size_t usableSize(const void* ptr) { return ptr ? blockSize(fromPayload(ptr)) : 0; }
+
+  /**
+   * @brief acts just as stdlib::malloc with a couple of differences
+   *
+   * - Returns nullptr if there is not enough space to malloc the requested size
+   *
+   * - Returns nullptr if requested size = 0 (with no space allocated for it)
+   */
+  void* malloc(size_t requestedSize) {
+    const size_t size = adjustSize(requestedSize);
+    if (!size || !this->pMemory) { this->numFailures += (requestedSize != 0); return nullptr; }
+    Block* block = this->locateFreeBlock(size);
+    if (!block) { this->numFailures++; return nullptr; }
+    this->trimUsed(block, size);
+    this->countAllocation(block, requestedSize);
+    return payload(block);
+  }
+
+  // `malloc()` attributed to `site`, e.g. `JAFFX_ALLOC_SITE`
+  void* malloc(size_t requestedSize, const char* site) {
+    const char* previous = this->site;
+    this->site = site;
+    void* ptr = this->malloc(requestedSize);
+    this->site = previous;
+    return ptr;
+  }
+
+  /**
+   * @brief acts just as stdlib::calloc, zero-filling the allocation
+   */
+  void* calloc(size_t numElements, size_t size) {
+    if (size && numElements > size_t(-1) / size) { return nullptr; } // overflow
+    const size_t bytes = numElements * size;
+    void* returnVal = this->malloc(bytes);
+    if (returnVal) { ::memset(returnVal, 0, bytes); }
+    return returnVal;
+  }
+
+  /**
+   * @brief acts just as stdlib::realloc with a couple of differences
+   *
+   * - Frees array and returns nullptr if requested size = 0
+   *
+   * - `malloc()`s a new array of `size` if `ptr` is `nullptr`
+   *
+   * Shrinks in place, grows in place into a free physical successor when
+   * possible, and otherwise moves the data to a new allocation.
+   */
+  void* realloc(void* ptr, size_t requestedSize) {
+    if (requestedSize == 0) { this->free(ptr); return nullptr; }
+    if (!ptr) { return this->malloc(requestedSize); }
+    if (!this->owns(ptr)) { return nullptr; }
+
+    const size_t size = adjustSize(requestedSize);
+    if (!size) { this->numFailures++; return nullptr; }
+    Block* block = fromPayload(ptr);
+    const size_t current = blockSize(block);
+
+    if (size > current) {
+      // try to absorb the next block
+      Block* next = nextPhys(block);
+      if (!isFree(next) || current + HEADER_SIZE + blockSize(next) < size) {
+#ifdef JAFFX_ALLOC_TRACKING
+        LiveAllocation* entry = this->findLive(ptr);
+        void* moved = this->malloc(requestedSize, entry ? entry->site : this->site);
+#else
+        void* moved = this->malloc(requestedSize);
+#endif
+        if (!moved) { return nullptr; }
+        ::memcpy(moved, ptr, current);
+        this->free(ptr);
+        return moved;
+      }
+      this->removeFreeBlock(next);
+      setSize(block, current + HEADER_SIZE + blockSize(next));
+      nextPhys(block)->prevPhys = block;
+    }
+    this->trimUsed(block, size);
+    this->bytesInUse = this->bytesInUse - current + blockSize(block);
+    if (this->bytesInUse > this->peakBytesInUse) { this->peakBytesInUse = this->bytesInUse; }
+#ifdef JAFFX_ALLOC_TRACKING
+    if (LiveAllocation* entry = this->findLive(ptr)) { entry->size = requestedSize; }
+#endif
+    return ptr;
+  }
+
+  /**
+   * @brief acts just as stdlib::free
+   *
+   * - Will not do anything if passed `nullptr`, a pointer outside the region,
+   *   or a block that is already free
+   *
+   * - Undefined behavior if you pass in a pointer to something that was NOT
+   *   allocated using the accompanying `malloc`/`calloc`/`realloc` calls
+   */
+  void free(void* ptr) {
+    if (!ptr || !this->owns(ptr)) { return; }
+    Block* block = fromPayload(ptr);
+    if (isFree(block)) { return; }
+    this->bytesInUse -= blockSize(block);
+    this->usedBlocks--;
+    this->numFrees++;
+#ifdef JAFFX_ALLOC_TRACKING
+    if (LiveAllocation* entry = this->findLive(ptr)) { entry->ptr = nullptr; }
+#endif
+    setFree(block, true);
+    block = this->mergeWithPrev(block);
+    block = this->mergeWithNext(block);
+    this->insertFreeBlock(block);
+  }
+
+  // Call site attributed to later allocations, `nullptr` for none
+  void setSite(const char* site) { this->site = site; }
+
+  /**
+   * @brief Usage counters plus a walk of the free lists
+   *
+   * The walk is proportional to the number of free blocks, so call this from
+   * the main loop rather than the audio callback.
+   */
+  Stats getStats() const {
+    Stats stats;
+    stats.capacity = this->memorySize;
+    stats.bytesInUse = this->bytesInUse;
+    stats.peakBytesInUse = this->peakBytesInUse;
+    stats.usedBlocks = this->usedBlocks;
+    stats.allocations = this->numAllocations;
+    stats.frees = this->numFrees;
+    stats.failures = this->numFailures;
+    for (unsigned fl = 0; fl < FL_INDEX_COUNT; fl++) {
+      if (!(this->flBitmap & (1u << fl))) { continue; }
+      for (unsigned sl = 0; sl < SL_INDEX_COUNT; sl++) {
+        for (const Block* b = this->freeLists[fl][sl]; b; b = b->nextFree) {
+          const size_t size = blockSize(b);
+          stats.freeBytes += size;
+          stats.freeBlocks++;
+          if (size > stats.largestFree) { stats.largestFree = size; }
+        }
+      }
+    }
+    return stats;
+  }
+
+  // Requests per size bin, see `HISTOGRAM_BINS`
+  const uint32_t* getHistogram() const { return this->histogram; }
+
+  // Clears the call counters and histogram, and restarts the peak from current usage
+  void resetCounters() {
+    this->peakBytesInUse = this->bytesInUse;
+    this->numAllocations = this->numFrees = this->numFailures = 0;
+    ::memset(this->histogram, 0, sizeof(this->histogram));
+  }
+
+  // Prints `getStats()` and the non-empty histogram bins
+  template <typename Printer>
+  void report(Printer print) const {
+    const Stats stats = this->getStats();
+    print("in use: %lu bytes in %lu blocks (peak %lu of %lu)", (unsigned long)stats.bytesInUse,
+          (unsigned long)stats.usedBlocks, (unsigned long)stats.peakBytesInUse, (unsigned long)stats.capacity);
+    print("free: %lu bytes in %lu blocks, largest %lu, fragmentation %d%%", (unsigned long)stats.freeBytes,
+          (unsigned long)stats.freeBlocks, (unsigned long)stats.largestFree, int(stats.fragmentation() * 100.f + 0.5f));
+    print("calls: %lu allocations, %lu frees, %lu failed", (unsigned long)stats.allocations,
+          (unsigned long)stats.frees, (unsigned long)stats.failures);
+    for (unsigned i = 0; i < HISTOGRAM_BINS; i++) {
+      if (!this->histogram[i]) { continue; }
+      if (i + 1 < HISTOGRAM_BINS) { print("  <= %lu bytes: %lu", (unsigned long)(ALIGN << i), (unsigned long)this->histogram[i]); }
+      else { print("  > %lu bytes: %lu", (unsigned long)(ALIGN << (i - 1)), (unsigned long)this->histogram[i]); }
+    }
+  }
+
+#ifdef JAFFX_ALLOC_TRACKING
+  // Prints every live allocation and its call site, e.g. to find leaks after a teardown
+  template <typename Printer>
+  void reportLive(Printer print) const {
+    for (const LiveAllocation& entry : this->live) {
+      if (entry.ptr) {
+        print("%p: %lu bytes from %s", entry.ptr, (unsigned long)entry.size, entry.site ? entry.site : "(unknown)");
+      }
+    }
+    if (this->untracked) { print("%lu allocations not tracked", (unsigned long)this->untracked); }
+  }
+#endif
+
+public: //TODO: This needs to be private in production, public now for testing code while running
+  // Prints every free block, list by list
+  void PrintFreeList() {
+    for (unsigned fl = 0; fl < FL_INDEX_COUNT; fl++) {
+      for (unsigned sl = 0; sl < SL_INDEX_COUNT; sl++) {
+        for (Block* b = this->freeLists[fl][sl]; b; b = b->nextFree) {
+          printf("block: %p\n \t size: %lu\n \t list: [%u][%u]\n \t next: %p\n \t prev: %p\n ",
+                 (void*)b, (unsigned long)blockSize(b), fl, sl, (void*)b->nextFree, (void*)b->prevFree);
+        }
+      }
+    }
+  }
+
+  // Prints every block in physical order
+  void PrintAllBlocks() {
+    printf("--------------------------------------------------------\n");
+    for (Block* b = this->firstBlock(); b && !isSentinel(b); b = nextPhys(b)) {
+      printf(isFree(b) ? "\033[1;36m\n" : "\033[1;35m\n"); // cyan for free, magenta for allocated
+      printf("block: %p\n \t size: %lu\n \t prevPhys: %p\n \t buffer: %p\n \t allocatedOrNot: %s\n",
+             (void*)b, (unsigned long)blockSize(b), (void*)b->prevPhys, payload(b), isFree(b) ? "false" : "true");
+    }
+    printf("\033[1;0m\n"); //Reset the color to black
+    printf("--------------------------------------------------------\n");
+  }
+
+protected:
+  /*******************************Block helpers****************************/
+  static size_t blockSize(const Block* b) { return b->sizeAndFlags & ~FREE_BIT; }
+  static void setSize(Block* b, size_t size) { b->sizeAndFlags = size | (b->sizeAndFlags & FREE_BIT); }
+  static bool isFree(const Block* b) { return b->sizeAndFlags & FREE_BIT; }
+  static void setFree(Block* b, bool free) {
+    b->sizeAndFlags = free ? (b->sizeAndFlags | FREE_BIT) : (b->sizeAndFlags & ~FREE_BIT);
+  }
+  static bool isSentinel(const Block* b) { return blockSize(b) == 0; }
+  static void* payload(Block* b) { return (unsigned char*)b + HEADER_SIZE; }
+  static Block* fromPayload(const void* p) { return (Block*)((const unsigned char*)p - HEADER_SIZE); }
+  static Block* nextPhys(Block* b) { return (Block*)((unsigned char*)payload(b) + blockSize(b)); }
+  Block* firstBlock() const { return (Block*)this->pMemory; }
+
+  // requested bytes -> block payload size, 0 if impossible
+  static size_t adjustSize(size_t size) {
+    if (size == 0 || size >= MAX_BLOCK_SIZE) { return 0; }
+    const size_t aligned = alignUp(size);
+    return aligned < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : aligned;
+  }
+
+  /*******************************Counters*********************************/
+  static unsigned histogramBin(size_t size) {
+    if (size <= ALIGN) { return 0; }
+    const unsigned bin = fls(size - 1) + 1 - ALIGN_LOG2;
+    return bin < HISTOGRAM_BINS ? bin : HISTOGRAM_BINS - 1;
+  }
+
+  void countAllocation(Block* block, size_t requestedSize) {
+    this->bytesInUse += blockSize(block);
+    if (this->bytesInUse > this->peakBytesInUse) { this->peakBytesInUse = this->bytesInUse; }
+    this->usedBlocks++;
+    this->numAllocations++;
+    this->histogram[histogramBin(requestedSize)]++;
+#ifdef JAFFX_ALLOC_TRACKING
+    if (LiveAllocation* entry = this->findLive(nullptr)) {
+      entry->ptr = payload(block);
+      entry->size = requestedSize;
+      entry->site = this->site;
+    } else { this->untracked++; }
+#endif
+  }
+
+#ifdef JAFFX_ALLOC_TRACKING
+  LiveAllocation* findLive(const void* ptr) {
+    for (LiveAllocation& entry : this->live) {
+      if (entry.ptr == ptr) { return &entry; }
+    }
+    return nullptr;
+  }
+#endif
+
+  /*******************************Index mapping****************************/
+  static unsigned fls(size_t x) { // index of the most significant set bit
+    return unsigned(sizeof(unsigned long) * 8 - 1 - __builtin_clzl((unsigned long)x));
+  }
+  static unsigned ffs(uint32_t x) { return unsigned(__builtin_ctz(x)); } // x != 0
+
+  static void mappingInsert(size_t size, unsigned& fl, unsigned& sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+      fl = 0;
+      sl = unsigned(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+    } else {
+      const unsigned bit = fls(size);
+      sl = unsigned(size >> (bit - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+      fl = bit - (FL_INDEX_SHIFT - 1);
+    }
+  }
+
+  // rounds up to the next list so any block found there is big enough
+  static void mappingSearch(size_t size, unsigned& fl, unsigned& sl) {
+    if (size >= SMALL_BLOCK_SIZE) {
+      size += (size_t(1) << (fls(size) - SL_INDEX_COUNT_LOG2)) - 1;
+    }
+    mappingInsert(size, fl, sl);
+  }
+
+  /*******************************Free lists*******************************/
+  void insertFreeBlock(Block* block) {
+    unsigned fl, sl;
+    mappingInsert(blockSize(block), fl, sl);
+    Block* head = this->freeLists[fl][sl];
+    block->nextFree = head;
+    block->prevFree = nullptr;
+    if (head) { head->prevFree = block; }
+    this->freeLists[fl][sl] = block;
+    this->flBitmap |= (1u << fl);
+    this->slBitmap[fl] |= (1u << sl);
+  }
+
+  void removeFreeBlock(Block* block) {
+    unsigned fl, sl;
+    mappingInsert(blockSize(block), fl, sl);
+    if (block->prevFree) { block->prevFree->nextFree = block->nextFree; }
+    if (block->nextFree) { block->nextFree->prevFree = block->prevFree; }
+    if (this->freeLists[fl][sl] == block) {
+      this->freeLists[fl][sl] = block->nextFree;
+      if (!block->nextFree) {
+        this->slBitmap[fl] &= ~(1u << sl);
+        if (!this->slBitmap[fl]) { this->flBitmap &= ~(1u << fl); }
+      }
+    }
+  }
+
+  // finds and unlinks a free block of at least `size`, or returns nullptr
+  Block* locateFreeBlock(size_t size) {
+    unsigned fl, sl;
+    mappingSearch(size, fl, sl);
+    if (fl >= FL_INDEX_COUNT) { return nullptr; }
+    uint32_t slMap = this->slBitmap[fl] & (~0u << sl);
+    if (!slMap) {
+      const uint32_t flMap = (fl + 1 < 32) ? (this->flBitmap & (~0u << (fl + 1))) : 0;
+      if (!flMap) { return nullptr; }
+      fl = ffs(flMap);
+      slMap = this->slBitmap[fl];
+    }
+    sl = ffs(slMap);
+    Block* block = this->freeLists[fl][sl];
+    this->removeFreeBlock(block);
+    return block;
+  }
+
+  /*******************************Split & merge****************************/
+  // marks `block` used, returning any tail beyond `size` to the free lists
+  void trimUsed(Block* block, size_t size) {
+    setFree(block, false);
+    const size_t current = blockSize(block);
+    if (current < size + HEADER_SIZE + MIN_BLOCK_SIZE) { return; } // remainder too small to split
+    setSize(block, size);
+    Block* remainder = nextPhys(block);
+    remainder->prevPhys = block;
+    remainder->sizeAndFlags = (current - size - HEADER_SIZE) | FREE_BIT;
+    nextPhys(remainder)->prevPhys = remainder;
+    this->insertFreeBlock(this->mergeWithNext(remainder));
+  }
+
+  // `block` must be free and unlinked
+  Block* mergeWithPrev(Block* block) {
+    Block* prev = block->prevPhys;
+    if (!prev || !isFree(prev)) { return block; }
+    this->removeFreeBlock(prev);
+    setSize(prev, blockSize(prev) + HEADER_SIZE + blockSize(block));
+    nextPhys(prev)->prevPhys = prev;
+    return prev;
+  }
+
+  // `block` must be free and unlinked
+  Block* mergeWithNext(Block* block) {
+    Block* next = nextPhys(block);
+    if (!isFree(next)) { return block; }
+    this->removeFreeBlock(next);
+    setSize(block, blockSize(block) + HEADER_SIZE + blockSize(next));
+    nextPhys(block)->prevPhys = block;
+    return block;
+  }
+};
+
+} // namespace Jaffx
@@ -0,0 +1,346 @@
+#pragma once
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "Activations.hpp"
+
+// Compiled with strict floating point even under -Ofast: fast-math lets the
+// compiler round the per-sample and block paths differently, and buys
+// nothing in these small fixed-size reductions. Trapping math stays off,
+// it doesn't change results but stops GCC vectorizing selects (clamps)
+#if defined(__clang__)
+#pragma float_control(precise, on, push)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("no-fast-math", "no-trapping-math")
+#endif
+
+namespace Jaffx {
+namespace wavenet {
+
+// Dilations of a layer array, as in a `.nam` file's config
+template <int... Ds>
+struct Dilations {
+  static constexpr int count = int(sizeof...(Ds));
+  static constexpr int values[sizeof...(Ds)] = { Ds... };
+};
+template <int... Ds> constexpr int Dilations<Ds...>::values[sizeof...(Ds)];
+
+// Rational tanh approximation used by NeuralAmpModelerCore (and rt-nam)
+struct NAMMathsProvider {
+  static inline float tanh(float x) {
+    const float ax = abs(x);
+    const float x2 = x * x;
+    return (x * (2.45550750702956f + 2.45550750702956f * ax + (0.893229853513558f + 0.821226666969744f * ax) * x2)) /
+           (2.44506634652299f + (2.44506634652299f + x2) * abs(x + 0.814642734961073f * x * ax));
+  }
+
+  // (not `std::fabs`, which can't be inlined across the optimize pragma above)
+  static inline float abs(float x) { return x < 0.f ? -x : x; }
+};
+
+// Exact tanh, for reference
+struct StdMathsProvider {
+  static inline float tanh(float x) { return std::tanh(x); }
+};
+
+// (`FastMathsProvider`, branch-free with a choice of accuracy, is in Activations.hpp)
+
+/**
+ * @brief Compile-time configuration of one NAM WaveNet layer array,
+ * mirroring the `layers` entries of a `.nam` file's config
+ * (non-gated, tanh activation)
+ */
+template <typename T, int InputSize, int ConditionSize, int HeadSize, int Channels, int KernelSize,
+          typename DilationsT, bool HeadBias, typename MathsProvider = NAMMathsProvider>
+struct LayerArray {
+  static_assert(ConditionSize == 1, "Only mono conditioning is supported");
+  typedef T value_type;
+  typedef MathsProvider Maths;
+  static constexpr int inputSize = InputSize;
+  static constexpr int headSize = HeadSize;
+  static constexpr int channels = Channels;
+  static constexpr int kernelSize = KernelSize;
+  static constexpr int numLayers = DilationsT::count;
+  static constexpr bool headBias = HeadBias;
+
+  static constexpr int dilation(int layer) { return DilationsT::values[layer]; }
+
+  // samples of history a layer's dilated convolution looks back
+  static constexpr int reach(int layer) { return dilation(layer) * (KernelSize - 1); }
+
+  static constexpr int receptiveField() {
+    int field = 0;
+    for (int i = 0; i < numLayers; i++) { field += reach(i); }
+    return field;
+  }
+
+  // Weights per layer: dilated conv (+ bias), input mixin, 1x1 (+ bias)
+  static constexpr int layerWeights() {
+    return Channels * Channels * KernelSize + Channels + ConditionSize * Channels + Channels * Channels + Channels;
+  }
+
+  // Weights of the whole array: rechannel, layers, head rechannel (+ bias)
+  static constexpr int numWeights() {
+    return InputSize * Channels + numLayers * layerWeights() + Channels * HeadSize + (HeadBias ? HeadSize : 0);
+  }
+};
+
+/**
+ * @brief Runs one `LayerArray` over blocks of up to `MaxBlock` frames
+ *
+ * Each layer keeps its input history in a linear buffer of `reach + SPAN`
+ * frames (channels interleaved), so every tap of the dilated convolution is
+ * a contiguous read. Blocks are written after the history, and once `SPAN`
+ * frames have been written the last `reach` frames are moved back to the
+ * front. Layers run one after another over the whole block, so each layer's
+ * weights are loaded once per block rather than once per sample.
+ */
+template <typename Config, int MaxBlock>
+class LayerArrayProcessor {
+public:
+  typedef typename Config::value_type T;
+  static constexpr int C = Config::channels;
+  static constexpr int K = Config::kernelSize;
+  static constexpr int L = Config::numLayers;
+  static constexpr int IN = Config::inputSize;
+  static constexpr int H = Config::headSize;
+  static constexpr int SPAN = 2 * MaxBlock; // frames written between rewinds
+
+private:
+  struct Layer {
+    T conv[K][C][C]; // [tap][out][in]
+    T convBias[C];
+    T mixin[C];
+    T conv1x1[C][C]; // [out][in]
+    T bias1x1[C];
+  };
+
+  static constexpr int bufferOffset(int layer) { // in frames
+    int offset = 0;
+    for (int i = 0; i < layer; i++) { offset += Config::reach(i) + SPAN; }
+    return offset;
+  }
+
+  Layer layers[L];
+  T rechannel[C][IN];
+  T head[H][C];
+  T headBias[H] = {};
+  T history[bufferOffset(L) * C] = {};
+  int written = 0; // frames written since the last rewind
+
+  T* current(int layer) { return this->history + (bufferOffset(layer) + Config::reach(layer) + this->written) * C; }
+
+  void rewind() {
+    for (int l = 0; l < L; l++) {
+      T* buffer = this->history + bufferOffset(l) * C;
+      ::memmove(buffer, buffer + this->written * C, Config::reach(l) * C * sizeof(T));
+    }
+    this->written = 0;
+  }
+
+  // one layer over `n` frames: reads its input from `current(l)`, writes to `next`
+  void processLayer(int l, const T* cond, T* headAcc, T* next, int n) {
+    const Layer w = this->layers[l]; // local copy, so the weights can stay in registers
+    const int d = Config::dilation(l);
+    const T* x = this->current(l);
+    for (int t = 0; t < n; t++) {
+      T z[C];
+      for (int c = 0; c < C; c++) {
+        T acc = 0;
+        for (int k = 0; k < K; k++) {
+          const T* tap = x + (t - d * (K - 1 - k)) * C;
+          for (int j = 0; j < C; j++) { acc += w.conv[k][c][j] * tap[j]; }
+        }
+        acc += w.convBias[c];
+        acc += w.mixin[c] * cond[t];
+        z[c] = Config::Maths::tanh(acc);
+        headAcc[t * C + c] += z[c];
+      }
+      for (int c = 0; c < C; c++) {
+        T acc = 0;
+        for (int j = 0; j < C; j++) { acc += w.conv1x1[c][j] * z[j]; }
+        next[t * C + c] = x[t * C + c] + (acc + w.bias1x1[c]);
+      }
+    }
+  }
+
+public:
+  // Reads `Config::numWeights()` weights in `.nam` order, returns the position after them
+  const float* loadWeights(const float* weights) {
+    for (int i = 0; i < C; i++) {
+      for (int j = 0; j < IN; j++) { this->rechannel[i][j] = T(*weights++); }
+    }
+    for (Layer& layer : this->layers) {
+      for (int i = 0; i < C; i++) {
+        for (int j = 0; j < C; j++) {
+          for (int k = 0; k < K; k++) { layer.conv[k][i][j] = T(*weights++); }
+        }
+      }
+      for (int i = 0; i < C; i++) { layer.convBias[i] = T(*weights++); }
+      for (int i = 0; i < C; i++) { layer.mixin[i] = T(*weights++); }
+      for (int i = 0; i < C; i++) {
+        for (int j = 0; j < C; j++) { layer.conv1x1[i][j] = T(*weights++); }
+      }
+      for (int i = 0; i < C; i++) { layer.bias1x1[i] = T(*weights++); }
+    }
+    for (int i = 0; i < H; i++) {
+      for (int j = 0; j < C; j++) { this->head[i][j] = T(*weights++); }
+    }
+    if (Config::headBias) {
+      for (int i = 0; i < H; i++) { this->headBias[i] = T(*weights++); }
+    }
+    return weights;
+  }
+
+  void reset() {
+    ::memset(this->history, 0, sizeof(this->history));
+    this->written = 0;
+  }
+
+  /**
+   * @brief Processes `n` <= `MaxBlock` frames
+   *
+   * @param input `n` x `IN` interleaved
+   * @param cond `n` conditioning samples (the model input)
+   * @param headAcc `n` x `C` head accumulator, added to by every layer
+   * @param output `n` x `C` output of the last layer
+   * @param headOut `n` x `H` head rechannel of `headAcc`
+   */
+  void process(const T* input, const T* cond, T* headAcc, T* output, T* headOut, int n) {
+    if (this->written + n > SPAN) { this->rewind(); }
+
+    T* x = this->current(0);
+    for (int t = 0; t < n; t++) {
+      for (int c = 0; c < C; c++) {
+        T acc = 0;
+        for (int j = 0; j < IN; j++) { acc += this->rechannel[c][j] * input[t * IN + j]; }
+        x[t * C + c] = acc;
+      }
+    }
+
+    for (int l = 0; l < L; l++) {
+      T* next = (l + 1 < L) ? this->current(l + 1) : output;
+      this->processLayer(l, cond, headAcc, next, n);
+    }
+
+    for (int t = 0; t < n; t++) {
+      for (int h = 0; h < H; h++) {
+        T acc = 0;
+        for (int c = 0; c < C; c++) { acc += this->head[h][c] * headAcc[t * C + c]; }
+        headOut[t * H + h] = acc + this->headBias[h];
+      }
+    }
+    this->written += n;
+  }
+};
+
+/**
+ * @brief Two-layer-array NAM WaveNet (the standard NAM architecture)
+ * with per-sample and block processing
+ *
+ * `forward()` is `process()` with a block of one, so both produce exactly
+ * the same output for the same input. `process()` is the fast path: it
+ * runs each layer over up to `MaxBlock` samples at a time.
+ *
+ * All state is held in the object, so its placement decides where the
+ * model runs from (e.g. `Jaffx::makePlaced()`).
+ *
+ * @code
+ * Jaffx::wavenet::Wavenet<Array1, Array2> model;
+ * model.loadModel(weights); // from a header generated from a `.nam` file
+ * model.process(in, out, 128);
+ * @endcode
+ */
+template <typename Array1, typename Array2, int MaxBlock = 128>
+class Wavenet {
+  static_assert(Array1::inputSize == 1, "Mono input expected");
+  static_assert(Array2::inputSize == Array1::channels, "Array 2 input must match array 1 channels");
+  static_assert(Array2::channels == Array1::headSize, "Array 2 channels must match array 1 head size");
+  static_assert(Array2::headSize == 1, "Mono output expected");
+  typedef typename Array1::value_type T;
+
+  LayerArrayProcessor<Array1, MaxBlock> array1;
+  LayerArrayProcessor<Array2, MaxBlock> array2;
+  T headScale = 0;
+
+  // scratch between the arrays
+  T head1[MaxBlock * Array1::channels];
+  T output1[MaxBlock * Array1::channels];
+  T head2[MaxBlock * Array1::headSize];
+  T output2[MaxBlock * Array2::channels];
+  T headOut2[MaxBlock];
+
+public:
+  typedef Array1 LayerArray1;
+  typedef Array2 LayerArray2;
+
+  static constexpr int numWeights() { return Array1::numWeights() + Array2::numWeights() + 1; } // + head scale
+  static constexpr int receptiveField() { return Array1::receptiveField() + Array2::receptiveField() + 1; }
+  static constexpr int maxBlock() { return MaxBlock; }
+
+  /**
+   * @brief Loads weights in `.nam` order, clears the state and prewarms
+   *
+   * @return false (leaving the model silent) if `count` doesn't match the architecture
+   */
+  bool loadModel(const float* weights, size_t count) {
+    if (count != size_t(numWeights())) { this->headScale = 0; return false; }
+    weights = this->array1.loadWeights(weights);
+    weights = this->array2.loadWeights(weights);
+    this->headScale = T(*weights);
+    this->reset();
+    this->prewarm();
+    return true;
+  }
+
+  bool loadModel(const std::vector<float>& weights) { return this->loadModel(weights.data(), weights.size()); }
+
+  // Calibration is only used by `QuantizedWavenet`, this keeps both interchangeable (e.g. in `ModelBank`)
+  bool loadModel(const float* weights, size_t count, const int8_t* /*residualBits*/) { return this->loadModel(weights, count); }
+
+  // Clears all layer histories
+  void reset() {
+    this->array1.reset();
+    this->array2.reset();
+  }
+
+  // Runs silence through the receptive field so the layers settle
+  void prewarm() {
+    T silence[MaxBlock] = {};
+    T discard[MaxBlock];
+    for (int i = 0; i < receptiveField(); i += MaxBlock) { this->process(silence, discard, MaxBlock); }
+  }
+
+  // Processes `size` samples (any length, in chunks of `MaxBlock`). `in` and `out` may alias
+  void process(const T* in, T* out, size_t size) {
+    while (size > 0) {
+      const int n = size < size_t(MaxBlock) ? int(size) : MaxBlock;
+      ::memset(this->head1, 0, n * Array1::channels * sizeof(T));
+      this->array1.process(in, in, this->head1, this->output1, this->head2, n);
+      this->array2.process(this->output1, in, this->head2, this->output2, this->headOut2, n);
+      for (int t = 0; t < n; t++) { out[t] = this->headScale * this->headOut2[t]; }
+      in += n;
+      out += n;
+      size -= size_t(n);
+    }
+  }
+
+  // Processes one sample
+  T forward(T input) {
+    T output;
+    this->process(&input, &output, 1);
+    return output;
+  }
+};
+
+} // namespace wavenet
+} // namespace Jaffx
+
+#if defined(__clang__)
+#pragma float_control(pop)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif